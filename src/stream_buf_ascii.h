@@ -0,0 +1,230 @@
+#pragma once
+
+#include "stream_buf_endian.h"
+#include "stream_buf_varint.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/*!
+ASCII decimal and hexadecimal integer formatting and parsing helpers used by StreamBufWriter and StreamBufReader,
+for text protocols such as CLI dumps, NMEA sentences and CSV, without formatting into a temporary with snprintf.
+
+The number of digits is calculated up front, so the writer performs a single bounds check, and decimal digits are
+then written two at a time, from the end, using a table of digit pairs. Hexadecimal digits are formed eight at a time
+in a 64-bit word, by spreading the nibbles of the value into bytes and converting them to ASCII with shifts and masks.
+
+Parsing classifies and converts eight characters at a time in a 64-bit word (SWAR), so most numbers are parsed
+without a loop over their digits.
+*/
+namespace stream_buf {
+
+//! maximum number of characters of a decimal uint64_t or int64_t, including the sign
+static constexpr size_t DECIMAL_U64_SIZE_MAX = 20;
+static constexpr size_t DECIMAL_S64_SIZE_MAX = 20;
+
+inline constexpr std::array<uint64_t, 20> POWERS_OF_10 = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+    10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL, 1000000000000000ULL,
+    10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+};
+
+//! the ASCII digits of 00 to 99, two bytes per pair
+inline constexpr std::array<uint8_t, 200> DECIMAL_DIGIT_PAIRS = []() {
+    std::array<uint8_t, 200> pairs {};
+    for (size_t ii = 0; ii < 100; ++ii) {
+        pairs[2 * ii] = static_cast<uint8_t>('0' + ii / 10);
+        pairs[2 * ii + 1] = static_cast<uint8_t>('0' + ii % 10);
+    }
+    return pairs;
+}();
+
+//! number of decimal digits of value, zero has one digit
+constexpr size_t decimal_size(uint64_t value) {
+    // bits * 1233 / 4096, approximately bits * log10(2), is d, the number of digits of 2^bits less one, and value has
+    // d digits if it is below 10^d, otherwise d + 1. Setting the lowest bit gives zero one digit, and does not change
+    // the number of digits of any other value, since powers of 10 are even
+    value |= 1U;
+    const size_t bits = 64 - count_leading_zeros(value);
+    const size_t digits = (bits * 1233) >> 12;
+    return digits + 1 - (value < POWERS_OF_10[digits] ? 1 : 0);
+}
+
+/*!
+Write the lowest size decimal digits of value at ptr, with leading zeros if size is greater than decimal_size(value).
+Digits are written two at a time from the end, 64-bit divisions are used only while the value exceeds 32 bits.
+*/
+constexpr void encode_decimal(uint8_t* ptr, uint64_t value, size_t size) {
+    // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    for (; size >= 2 && value > UINT32_MAX; size -= 2) {
+        const auto pair = static_cast<size_t>(value % 100) * 2;
+        value /= 100;
+        ptr[size - 2] = DECIMAL_DIGIT_PAIRS[pair];
+        ptr[size - 1] = DECIMAL_DIGIT_PAIRS[pair + 1];
+    }
+    auto value32 = static_cast<uint32_t>(value);
+    for (; size >= 2; size -= 2) {
+        const size_t pair = static_cast<size_t>(value32 % 100) * 2;
+        value32 /= 100;
+        ptr[size - 2] = DECIMAL_DIGIT_PAIRS[pair];
+        ptr[size - 1] = DECIMAL_DIGIT_PAIRS[pair + 1];
+    }
+    if (size == 1) {
+        ptr[0] = static_cast<uint8_t>('0' + value32 % 10);
+    }
+    // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}
+
+//! spread the 8 nibbles of value into the low nibbles of 8 bytes, the least significant nibble into the lowest byte
+constexpr uint64_t hex_spread(uint32_t value) {
+    uint64_t word = value;
+    word = (word | (word << 16)) & 0x0000FFFF0000FFFFULL;
+    word = (word | (word << 8)) & 0x00FF00FF00FF00FFULL;
+    word = (word | (word << 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return word;
+}
+
+//! convert each byte of nibbles, which must each be less than 16, to an upper case hexadecimal ASCII digit
+constexpr uint64_t hex_ascii(uint64_t nibbles) {
+    constexpr uint64_t ONES = 0x0101010101010101ULL;
+    // adding 6 carries into the high nibble of the byte only for nibbles of 10 or more, which need 'A' - '9' - 1 added
+    const uint64_t letters = ((nibbles + 6 * ONES) >> 4U) & ONES;
+    return nibbles + '0' * ONES + letters * ('A' - '9' - 1);
+}
+
+/*!
+Write the lowest size hexadecimal digits of value, in upper case, at ptr. size must be at most 16.
+space is the number of bytes available at ptr, if it is at least 8 then each group of up to 8 digits is written as a single word.
+*/
+constexpr void encode_hex(uint8_t* ptr, uint64_t value, size_t size, size_t space) {
+    // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    while (size > 0) {
+        const size_t count = (size > 8) ? size - 8 : size;
+        size -= count;
+        // the most significant nibble is wanted first, so the lowest count nibbles are moved to the lowest count bytes, reversed
+        const uint64_t text = byte_swap(hex_ascii(hex_spread(static_cast<uint32_t>(value >> (4 * size))))) >> (8 * (8 - count));
+        if (space >= sizeof(uint64_t)) {
+            store_little_endian(ptr, text);
+        } else {
+            for (size_t ii = 0; ii < count; ++ii) { ptr[ii] = static_cast<uint8_t>(text >> (8 * ii)); }
+        }
+        ptr += count;
+        space -= std::min(space, count);
+    }
+    // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}
+
+/*!
+Load up to 8 bytes at ptr into a word, the first byte lowest, with any bytes beyond the available bytes zero,
+so that they are not digits.
+*/
+constexpr uint64_t load_digits(const uint8_t* ptr, size_t available) {
+    if (available >= sizeof(uint64_t)) {
+        return load_little_endian<uint64_t>(ptr);
+    }
+    uint64_t word = 0;
+    for (size_t ii = 0; ii < available; ++ii) { word |= static_cast<uint64_t>(ptr[ii]) << (8 * ii); } // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    return word;
+}
+
+//! set the top bit of each byte of word whose low 7 bits are at least n, there are no carries between bytes
+constexpr uint64_t bytes_at_least(uint64_t word7, uint8_t n) {
+    constexpr uint64_t ONES = 0x0101010101010101ULL;
+    return (word7 + (0x80U - n) * ONES) & 0x8080808080808080ULL;
+}
+
+//! number of leading bytes of word, up to 8, which are ASCII decimal digits
+constexpr size_t decimal_digit_count(uint64_t word) {
+    constexpr uint64_t HIGHS = 0x8080808080808080ULL;
+    const uint64_t word7 = word & ~HIGHS;
+    const uint64_t digits = bytes_at_least(word7, '0') & ~bytes_at_least(word7, '9' + 1) & ~word;
+    const uint64_t others = ~digits & HIGHS;
+    return (others == 0) ? 8 : count_trailing_zeros(others) / 8;
+}
+
+//! number of leading bytes of word, up to 8, which are ASCII hexadecimal digits, of either case
+constexpr size_t hex_digit_count(uint64_t word) {
+    constexpr uint64_t HIGHS = 0x8080808080808080ULL;
+    const uint64_t word7 = word & ~HIGHS;
+    const uint64_t lower = word7 | 0x2020202020202020ULL;
+    const uint64_t digits = bytes_at_least(word7, '0') & ~bytes_at_least(word7, '9' + 1);
+    const uint64_t letters = bytes_at_least(lower, 'a') & ~bytes_at_least(lower, 'f' + 1);
+    const uint64_t others = ~((digits | letters) & ~word) & HIGHS;
+    return (others == 0) ? 8 : count_trailing_zeros(others) / 8;
+}
+
+//! value of the leading count decimal digits of word, count must be between 1 and 8
+constexpr uint32_t decimal_parse_word(uint64_t word, size_t count) {
+    // shift out the bytes after the digits, the shifted in zero bytes act as leading zeros
+    word = (word << (8 * (8 - count))) & 0x0F0F0F0F0F0F0F0FULL;
+    // combine adjacent digits, then adjacent pairs, then adjacent quads, each multiply forming the high * base + low sums
+    word = (word * (1 + (10 << 8))) >> 8;
+    word = ((word & 0x00FF00FF00FF00FFULL) * (1 + (100 << 16))) >> 16;
+    return static_cast<uint32_t>(((word & 0x0000FFFF0000FFFFULL) * (1 + (10000ULL << 32))) >> 32);
+}
+
+//! value of the leading count hexadecimal digits of word, count must be between 1 and 8
+constexpr uint32_t hex_parse_word(uint64_t word, size_t count) {
+    // digits have bit 6 clear and letters have it set, and the low nibble of a letter is 9 less than its value
+    uint64_t nibbles = (word & 0x0F0F0F0F0F0F0F0FULL) + ((word >> 6U) & 0x0101010101010101ULL) * 9;
+    // move the digits to the top bytes, then reverse them, so that the last digit is in the lowest byte
+    nibbles = byte_swap(nibbles << (8 * (8 - count)));
+    nibbles = (nibbles | (nibbles >> 4)) & 0x00FF00FF00FF00FFULL;
+    nibbles = (nibbles | (nibbles >> 8)) & 0x0000FFFF0000FFFFULL;
+    return static_cast<uint32_t>(nibbles | (nibbles >> 16));
+}
+
+/*!
+Parse the decimal digits at ptr, up to the first non-digit or the end of the available bytes.
+Returns the number of digits, or zero if there are none or the value exceeds UINT64_MAX.
+*/
+constexpr size_t decode_decimal(const uint8_t* ptr, size_t available, uint64_t& value) {
+    value = 0;
+    size_t size = 0;
+    while (true) {
+        const uint64_t word = load_digits(ptr + size, available - size); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        const size_t count = decimal_digit_count(word);
+        if (count == 0) {
+            break;
+        }
+        const uint32_t chunk = decimal_parse_word(word, count);
+        // only a number of more than 19 digits, which may be leading zeros, can overflow
+        if (size + count > 19 && value > (UINT64_MAX - chunk) / POWERS_OF_10[count]) {
+            return 0;
+        }
+        value = value * POWERS_OF_10[count] + chunk;
+        size += count;
+        if (count < 8) {
+            break;
+        }
+    }
+    return size;
+}
+
+/*!
+Parse the hexadecimal digits, of either case, at ptr, up to the first non-digit or the end of the available bytes.
+Returns the number of digits, or zero if there are none or the value exceeds UINT64_MAX.
+*/
+constexpr size_t decode_hex(const uint8_t* ptr, size_t available, uint64_t& value) {
+    value = 0;
+    size_t size = 0;
+    while (true) {
+        const uint64_t word = load_digits(ptr + size, available - size); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        const size_t count = hex_digit_count(word);
+        if (count == 0) {
+            break;
+        }
+        if ((value >> (64 - 4 * count)) != 0) {
+            return 0;
+        }
+        value = (value << (4 * count)) | hex_parse_word(word, count);
+        size += count;
+        if (count < 8) {
+            break;
+        }
+    }
+    return size;
+}
+
+} // namespace stream_buf
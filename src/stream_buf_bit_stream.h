@@ -0,0 +1,142 @@
+#pragma once
+
+#include "stream_buf_reader.h"
+#include <array>
+
+/*!
+Bit granular writer and reader, layered on a StreamBufWriterT or StreamBufReaderT, for protocols that pack fields
+at sub-byte granularity, eg the 11-bit channels of SBUS.
+
+Bits are packed either MSB first, where the first bit written is the most significant bit of the first byte,
+or LSB first, where the first bit written is the least significant bit of the first byte.
+Values of up to 64 bits may be written and read.
+
+The byte aligned functions of the underlying writer or reader may be used after calling align().
+*/
+namespace stream_buf {
+
+enum class BitOrder { MSB_FIRST, LSB_FIRST };
+
+//! the low n bits of value, n may be 0 to 64
+inline uint64_t low_bits(uint64_t value, size_t n) { return n >= 64 ? value : value & ((1ULL << n) - 1); }
+
+} // namespace stream_buf
+
+/*!
+Bits are gathered in a 64-bit accumulator, which is written to the underlying writer as a single word each time it fills.
+align() pads with zero bits to a byte boundary and writes out any bits remaining in the accumulator,
+so it must be called at the end of the bit stream.
+*/
+template <typename Writer, stream_buf::BitOrder O = stream_buf::BitOrder::MSB_FIRST>
+class BitStreamWriter {
+public:
+    explicit BitStreamWriter(Writer& writer) : _writer(writer) {}
+    static constexpr bool IS_MSB_FIRST = O == stream_buf::BitOrder::MSB_FIRST;
+public:
+    //! Write the low n bits of value, n may be 0 to 64
+    void write_bits(uint64_t value, size_t n) {
+        value = stream_buf::low_bits(value, n);
+        const size_t free = 64 - _count;
+        if (n < free) {
+            if constexpr (IS_MSB_FIRST) { _acc = (_acc << n) | value; } else { _acc |= value << _count; }
+            _count += n;
+            return;
+        }
+        // fill the accumulator and write it as a word, keeping the remaining bits of value
+        const size_t rest = n - free;
+        if constexpr (IS_MSB_FIRST) {
+            _acc = (free == 64 ? 0 : _acc << free) | (value >> rest);
+            _writer.template write<uint64_t, stream_buf::Endian::BIG>(_acc);
+            _acc = stream_buf::low_bits(value, rest);
+        } else {
+            _acc |= value << _count;
+            _writer.template write<uint64_t, stream_buf::Endian::LITTLE>(_acc);
+            _acc = (free == 64) ? 0 : value >> free;
+        }
+        _count = rest;
+    }
+    void write_bit(bool value) { write_bits(value ? 1 : 0, 1); }
+    //! Pad with zero bits to a byte boundary and write out the accumulator
+    void align() {
+        const size_t bytes = (_count + 7) / 8;
+        if constexpr (IS_MSB_FIRST) {
+            const uint64_t acc = stream_buf::low_bits(_acc, _count) << (bytes * 8 - _count);
+            for (size_t ii = bytes; ii > 0; --ii) {
+                _writer.write_u8(static_cast<uint8_t>(acc >> ((ii - 1) * 8)));
+            }
+        } else {
+            for (size_t ii = 0; ii < bytes; ++ii) {
+                _writer.write_u8(static_cast<uint8_t>(_acc >> (ii * 8)));
+            }
+        }
+        _acc = 0;
+        _count = 0;
+    }
+    //! number of bits in the accumulator, not yet written to the underlying writer
+    size_t bits_pending() const { return _count; }
+private:
+    uint64_t _acc {0};
+    Writer& _writer;
+    size_t _count {0}; //!< number of bits in _acc, always less than 64
+};
+
+/*!
+Bits are extracted from a 64-bit word loaded at the read position of the underlying reader, which is only advanced
+past whole bytes that have been consumed. So the reader position is always exact, and align() just skips the rest of a partly read byte.
+Bit reads are always bounds checked, reading past the end returns zero and, for the Sticky policy, records an overflow.
+*/
+template <typename Reader, stream_buf::BitOrder O = stream_buf::BitOrder::MSB_FIRST>
+class BitStreamReader {
+public:
+    explicit BitStreamReader(Reader& reader) : _reader(reader) {}
+    static constexpr bool IS_MSB_FIRST = O == stream_buf::BitOrder::MSB_FIRST;
+    static constexpr stream_buf::Endian WORD_ENDIAN = IS_MSB_FIRST ? stream_buf::Endian::BIG : stream_buf::Endian::LITTLE;
+public:
+    //! Read n bits, n may be 0 to 64
+    uint64_t read_bits(size_t n) {
+        if (n > 56) {
+            // a 64-bit word holds at least 57 bits after the current bit offset, so split longer reads
+            if constexpr (IS_MSB_FIRST) {
+                const uint64_t high = read_bits(n - 32);
+                return (high << 32) | read_bits(32);
+            } else {
+                const uint64_t low = read_bits(32);
+                return low | (read_bits(n - 32) << 32);
+            }
+        }
+        if (n == 0 || !_reader.require((_bit_offset + n + 7) / 8)) {
+            return 0;
+        }
+        uint64_t word = 0;
+        if (_reader.bytes_remaining() >= sizeof(uint64_t)) {
+            word = _reader.template peek<uint64_t, WORD_ENDIAN>();
+        } else {
+            // near the end of the buffer, so zero pad
+            std::array<uint8_t, sizeof(uint64_t)> bytes {};
+            const size_t available = _reader.bytes_remaining();
+            memcpy(&bytes[0], _reader.peek_span(available).data(), available);
+            word = stream_buf::load<uint64_t, WORD_ENDIAN>(&bytes[0]);
+        }
+        uint64_t value = 0;
+        if constexpr (IS_MSB_FIRST) {
+            value = (word << _bit_offset) >> (64 - n);
+        } else {
+            value = stream_buf::low_bits(word >> _bit_offset, n);
+        }
+        _bit_offset += n;
+        _reader.advance(_bit_offset / 8);
+        _bit_offset %= 8;
+        return value;
+    }
+    bool read_bit() { return read_bits(1) != 0; }
+    //! Skip to the next byte boundary
+    void align() {
+        if (_bit_offset != 0) {
+            _reader.advance(1);
+            _bit_offset = 0;
+        }
+    }
+private:
+    Reader& _reader;
+    size_t _bit_offset {0}; //!< number of bits of the byte at the read position that have been consumed
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/*!
+Bounds checking policies for StreamBufWriterT and StreamBufReaderT.
+
+The policy determines the behavior of the plain read and write functions, eg write_u16() and read_u16().
+The _checked functions, and the bulk functions such as write_data() and read_data(), are always bounds checked.
+*/
+namespace stream_buf {
+
+//! No bounds checking, zero cost. The caller is responsible for ensuring there is sufficient space.
+struct Unchecked {};
+
+//! Writes that do not fit are dropped and reads that do not fit return zero.
+struct Checked {};
+
+/*!
+As Checked, but additionally the first overflow is recorded and the buffer is then treated as full,
+so all subsequent reads and writes fail. This allows the overflow to be checked once, at the end of a frame,
+using overflowed(). The overflow is cleared by reset().
+*/
+struct Sticky {
+    size_t end_offset; //!< zero if no overflow, otherwise the offset of the buffer end prior to the overflow
+};
+
+/*!
+As Unchecked, but counts the bounds checks performed by the _checked, bulk, reserve() and require() functions.
+For instrumentation, eg to measure how many checks reserve() or require() saves over the _checked functions.
+The count is not cleared by reset().
+*/
+struct Counting {
+    size_t checks; //!< number of bounds checks performed
+};
+
+/*!
+Writer only. When a write does not fit, the data written so far is handed to the sink and the buffer is reused,
+so a small fixed buffer may stream an unbounded amount of data. Bulk writes larger than the buffer are split across flushes.
+Writes are dropped only if the sink fails. See stream_buf_sink.h for the sink interface.
+The sink is not owned by the writer and must outlive it.
+*/
+template <typename Sink>
+struct Flushing {
+    Sink* sink;
+    size_t flushed {0}; //!< number of bytes handed to the sink
+};
+
+/*!
+Reader only. When a read does not fit, the unread bytes are moved to the start of the window and the rest of the window
+is refilled from the source, so an unbounded stream may be decoded in constant memory.
+Fields that straddle a refill decode correctly, and bulk reads larger than the window are split across refills.
+Views returned by read_span() etc are invalidated by a refill. See stream_buf_source.h for the source interface.
+The source is not owned by the reader and must outlive it.
+*/
+template <typename Source>
+struct Refilling {
+    Source* source;
+    uint8_t* window;
+    size_t capacity;
+    size_t discarded; //!< number of bytes read and then discarded by refills
+};
+
+template <typename T>
+static constexpr bool is_flushing = false;
+template <typename Sink>
+static constexpr bool is_flushing<Flushing<Sink>> = true;
+template <typename T>
+static constexpr bool is_refilling = false;
+template <typename Source>
+static constexpr bool is_refilling<Refilling<Source>> = true;
+
+} // namespace stream_buf
@@ -0,0 +1,414 @@
+#pragma once
+
+#include "stream_buf_reader.h"
+#include "stream_buf_scan.h"
+#include "stream_buf_writer.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+/*!
+COBS (Consistent Overhead Byte Stuffing) and SLIP (RFC 1055) framing, layered on StreamBufWriter and StreamBufReader.
+
+COBS replaces each zero byte so that a zero byte may be used as the frame delimiter, with an overhead of at most one byte in 254.
+SLIP delimits frames with END (0xC0), and escapes END and ESC (0xDB) bytes within the frame, with an overhead of up to 100%.
+
+The encoders and decoders find zero, END and ESC bytes using the scanning kernels in stream_buf_scan.h,
+and copy the bytes between them in bulk, rather than handling the data a byte at a time.
+*/
+namespace stream_buf {
+
+//! returned by the decode functions if the frame is malformed
+static constexpr size_t DECODE_ERROR = SIZE_MAX;
+
+static constexpr size_t COBS_RUN_MAX = 254; //!< maximum number of non-zero bytes per COBS code byte
+
+static constexpr uint8_t SLIP_END = 0xC0;
+static constexpr uint8_t SLIP_ESC = 0xDB;
+static constexpr uint8_t SLIP_ESC_END = 0xDC;
+static constexpr uint8_t SLIP_ESC_ESC = 0xDD;
+
+//! maximum size of len bytes COBS encoded, excluding the delimiter
+constexpr size_t cobs_max_encoded_size(size_t len) { return len + len / COBS_RUN_MAX + 1; }
+
+/*!
+Write len bytes at data COBS encoded, followed by the zero delimiter, with a single bounds check for the whole frame.
+Returns false, writing nothing, if there is insufficient space for cobs_max_encoded_size(len) + 1 bytes.
+*/
+template <typename Writer>
+bool write_cobs(Writer& writer, const uint8_t* data, size_t len) {
+    const size_t max_size = cobs_max_encoded_size(len) + 1;
+    StreamBufWriter frame = writer.reserve(max_size);
+    if (frame.bytes_remaining() < max_size) {
+        return false;
+    }
+    // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    for (;;) {
+        const size_t chunk = std::min(len, COBS_RUN_MAX);
+        const size_t run = find_byte(data, chunk, 0);
+        frame.write_u8(static_cast<uint8_t>(run + 1));
+        frame.write_data(data, run);
+        if (run < chunk) {
+            // the zero byte is implied by the code byte
+            data += run + 1;
+            len -= run + 1;
+            continue;
+        }
+        data += run;
+        len -= run;
+        if (len == 0) {
+            break;
+        }
+    }
+    // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    frame.write_u8(0);
+    writer.commit(frame);
+    return true;
+}
+
+/*!
+Decode the COBS frame of len bytes at src, excluding the delimiter, to dst. Returns the decoded size, or DECODE_ERROR if the frame is malformed.
+The decoded frame is always smaller than the encoded frame, and dst may be the same as src, to decode in place.
+src should not contain any zero bytes, as is the case for a frame found using find_byte().
+*/
+inline size_t cobs_decode(uint8_t* dst, const uint8_t* src, size_t len) {
+    // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    size_t out = 0;
+    size_t pos = 0;
+    while (pos < len) {
+        const size_t code = src[pos];
+        if (code == 0 || code > len - pos) {
+            return DECODE_ERROR;
+        }
+        memmove(dst + out, src + pos + 1, code - 1);
+        out += code - 1;
+        pos += code;
+        if (code != COBS_RUN_MAX + 1 && pos < len) {
+            dst[out++] = 0;
+        }
+    }
+    return out;
+    // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}
+
+//! Decode the COBS frame of len bytes at frame in place, returns the decoded size, or DECODE_ERROR if the frame is malformed
+inline size_t cobs_decode_in_place(uint8_t* frame, size_t len) { return cobs_decode(frame, frame, len); }
+
+/*!
+Write len bytes at data SLIP encoded, followed by END.
+Returns false, writing nothing, if there is insufficient space.
+RFC 1055 suggests also writing END before the frame, to flush any line noise, which the caller may do using write_u8(SLIP_END).
+*/
+template <typename Writer>
+bool write_slip(Writer& writer, const uint8_t* data, size_t len) {
+    // the encoded size is not known in advance, so reserve all the remaining space and commit what is used
+    StreamBufWriter frame = writer.reserve(writer.bytes_remaining());
+    // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    for (;;) {
+        const size_t run = find_either(data, len, SLIP_END, SLIP_ESC);
+        if (frame.bytes_remaining() < run + ((run < len) ? 2 : 1)) {
+            return false;
+        }
+        frame.write_data(data, run);
+        if (run == len) {
+            break;
+        }
+        frame.write_u8(SLIP_ESC);
+        frame.write_u8((data[run] == SLIP_END) ? SLIP_ESC_END : SLIP_ESC_ESC);
+        data += run + 1;
+        len -= run + 1;
+    }
+    // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    frame.write_u8(SLIP_END);
+    writer.commit(frame);
+    return true;
+}
+
+/*!
+Decode the SLIP frame of len bytes at src, excluding the END delimiter, to dst. Returns the decoded size, or DECODE_ERROR if the frame is malformed.
+As cobs_decode(), dst may be the same as src, to decode in place.
+*/
+inline size_t slip_decode(uint8_t* dst, const uint8_t* src, size_t len) {
+    // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    size_t out = 0;
+    size_t pos = 0;
+    while (pos < len) {
+        const size_t run = find_byte(src + pos, len - pos, SLIP_ESC);
+        memmove(dst + out, src + pos, run);
+        out += run;
+        pos += run;
+        if (pos == len) {
+            break;
+        }
+        if (pos + 1 == len || (src[pos + 1] != SLIP_ESC_END && src[pos + 1] != SLIP_ESC_ESC)) {
+            return DECODE_ERROR;
+        }
+        dst[out++] = (src[pos + 1] == SLIP_ESC_END) ? SLIP_END : SLIP_ESC;
+        pos += 2;
+    }
+    return out;
+    // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}
+
+//! Decode the SLIP frame of len bytes at frame in place, returns the decoded size, or DECODE_ERROR if the frame is malformed
+inline size_t slip_decode_in_place(uint8_t* frame, size_t len) { return slip_decode(frame, frame, len); }
+
+} // namespace stream_buf
+
+/*!
+Streaming COBS encoder, for frames that are written piecewise, eg a header followed by a payload.
+
+The code byte for each run is reserved as a placeholder and patched when the run ends, so the frame is encoded in a single pass without a staging buffer.
+Because placeholders cannot be patched after a flush, the writer must not flush during the frame, finish() reports a frame that was flushed.
+*/
+template <typename Writer>
+class CobsEncoder {
+public:
+    //! Start a frame
+    explicit CobsEncoder(Writer& writer) : _writer(writer), _code(writer.reserve_u8()), _start(_code.offset) {}
+public:
+    void write(const uint8_t* data, size_t len) {
+        // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        while (len > 0) {
+            if (_run == stream_buf::COBS_RUN_MAX) {
+                end_run();
+            }
+            const size_t chunk = std::min(len, stream_buf::COBS_RUN_MAX - _run);
+            const size_t run = stream_buf::find_byte(data, chunk, 0);
+            _writer.write_data(data, run);
+            _run += run;
+            data += run;
+            len -= run;
+            if (run < chunk) {
+                end_run(); // the zero byte is implied by the code byte
+                ++data;
+                --len;
+            }
+        }
+        // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+    void write_u8(uint8_t value) { write(&value, 1); }
+    /*!
+    Complete the frame, writing the delimiter.
+    Returns false if the writer flushed during the frame, so that code bytes were sent before they were patched and the frame is corrupt.
+    */
+    bool finish() {
+        _writer.patch(_code, static_cast<uint8_t>(_run + 1));
+        _writer.write_u8(0);
+        return _start >= _writer.bytes_flushed();
+    }
+private:
+    void end_run() {
+        _writer.patch(_code, static_cast<uint8_t>(_run + 1));
+        _code = _writer.reserve_u8();
+        _run = 0;
+    }
+private:
+    Writer& _writer;
+    stream_buf::Placeholder<uint8_t> _code;
+    size_t _start; //!< position of the first code byte in the stream
+    size_t _run {0}; //!< number of non-zero bytes written since the code byte
+};
+
+/*!
+Incremental COBS decoder, for bytes that arrive a few at a time, eg from a UART.
+
+decode() consumes a chunk of bytes and calls on_frame(std::span<const uint8_t>) with each complete decoded frame, which is
+only valid for the duration of the callback. Frames are decoded as the bytes arrive, into the frame buffer, which limits the frame size.
+Malformed frames, where a delimiter occurs within a run, and frames too large for the buffer are discarded, and decoding resumes after the next delimiter.
+Empty frames, ie consecutive delimiters, are skipped.
+*/
+class CobsDecoder {
+public:
+    CobsDecoder(uint8_t* buf, size_t capacity) : _buf(buf), _capacity(capacity) {}
+public:
+    //! Decode len bytes at data, calling on_frame for each complete frame. Returns the number of frames decoded.
+    template <typename F>
+    size_t decode(const uint8_t* data, size_t len, F&& on_frame) {
+        // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        size_t frames = 0;
+        const uint8_t* const end = data + len;
+        while (data < end) {
+            const auto available = static_cast<size_t>(end - data);
+            if (_remaining == DISCARD) {
+                const size_t delimiter = stream_buf::find_byte(data, available, 0);
+                if (delimiter == available) {
+                    break;
+                }
+                data += delimiter + 1;
+                reset();
+                continue;
+            }
+            if (_remaining == 0) {
+                // at a code byte or the delimiter
+                const size_t code = *data++;
+                if (code == 0) {
+                    if (_code != 0) {
+                        on_frame(std::span<const uint8_t>(_buf, _len));
+                        ++frames;
+                    }
+                    reset();
+                    continue;
+                }
+                if (_code != 0 && _code != stream_buf::COBS_RUN_MAX + 1) {
+                    // the zero implied by the previous code byte is only emitted once it is known not to be the end of the frame
+                    if (_len == _capacity) {
+                        ++_dropped;
+                        _remaining = DISCARD;
+                        continue;
+                    }
+                    _buf[_len++] = 0;
+                }
+                _code = code;
+                _remaining = code - 1;
+                continue;
+            }
+            const size_t chunk = std::min(_remaining, available);
+            const size_t run = stream_buf::find_byte(data, chunk, 0);
+            if (run < chunk) {
+                // delimiter within a run, so the frame was truncated
+                ++_errors;
+                data += run + 1;
+                reset();
+                continue;
+            }
+            if (run > _capacity - _len) {
+                ++_dropped;
+                _remaining = DISCARD;
+                continue;
+            }
+            memcpy(_buf + _len, data, run);
+            _len += run;
+            _remaining -= run;
+            data += run;
+        }
+        return frames;
+        // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+    //! Decode all the bytes remaining in reader
+    template <typename Reader, typename F>
+    size_t decode(Reader& reader, F&& on_frame) {
+        const std::span<const uint8_t> span = reader.read_span(reader.bytes_remaining());
+        return decode(span.data(), span.size(), std::forward<F>(on_frame));
+    }
+    //! Discard any partly decoded frame
+    void reset() { _len = 0; _remaining = 0; _code = 0; }
+    //! true if a frame has been started but not completed
+    bool in_frame() const { return _code != 0 || _remaining == DISCARD; }
+    //! number of frames discarded because they were truncated
+    size_t errors() const { return _errors; }
+    //! number of frames discarded because they would not fit in the frame buffer
+    size_t dropped() const { return _dropped; }
+private:
+    static constexpr size_t DISCARD = SIZE_MAX; //!< value of _remaining while discarding bytes up to the next delimiter
+private:
+    uint8_t* _buf;
+    size_t _capacity;
+    size_t _len {0};
+    size_t _remaining {0}; //!< number of bytes remaining in the current run
+    size_t _code {0}; //!< code byte of the current run, zero at the start of a frame
+    size_t _errors {0};
+    size_t _dropped {0};
+};
+
+/*!
+Incremental SLIP decoder, as CobsDecoder.
+Malformed frames, with an invalid escape sequence, and frames too large for the buffer are discarded, and decoding resumes after the next END.
+Empty frames are skipped.
+*/
+class SlipDecoder {
+public:
+    SlipDecoder(uint8_t* buf, size_t capacity) : _buf(buf), _capacity(capacity) {}
+public:
+    //! Decode len bytes at data, calling on_frame for each complete frame. Returns the number of frames decoded.
+    template <typename F>
+    size_t decode(const uint8_t* data, size_t len, F&& on_frame) {
+        // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        size_t frames = 0;
+        const uint8_t* const end = data + len;
+        while (data < end) {
+            const auto available = static_cast<size_t>(end - data);
+            switch (_state) {
+            case State::DISCARD: {
+                const size_t delimiter = stream_buf::find_byte(data, available, stream_buf::SLIP_END);
+                if (delimiter == available) {
+                    return frames;
+                }
+                data += delimiter + 1;
+                reset();
+                break;
+            }
+            case State::ESCAPE: {
+                const uint8_t byte = *data++;
+                if (byte != stream_buf::SLIP_ESC_END && byte != stream_buf::SLIP_ESC_ESC) {
+                    ++_errors;
+                    if (byte == stream_buf::SLIP_END) {
+                        reset();
+                    } else {
+                        _state = State::DISCARD;
+                    }
+                    break;
+                }
+                if (_len == _capacity) {
+                    ++_dropped;
+                    _state = State::DISCARD;
+                    break;
+                }
+                _buf[_len++] = (byte == stream_buf::SLIP_ESC_END) ? stream_buf::SLIP_END : stream_buf::SLIP_ESC;
+                _state = State::DATA;
+                break;
+            }
+            case State::DATA: {
+                const size_t run = stream_buf::find_either(data, available, stream_buf::SLIP_END, stream_buf::SLIP_ESC);
+                if (run > _capacity - _len) {
+                    ++_dropped;
+                    _state = State::DISCARD;
+                    break;
+                }
+                memcpy(_buf + _len, data, run);
+                _len += run;
+                data += run;
+                if (run == available) {
+                    break;
+                }
+                if (*data++ == stream_buf::SLIP_ESC) {
+                    _state = State::ESCAPE;
+                    break;
+                }
+                if (_len != 0) {
+                    on_frame(std::span<const uint8_t>(_buf, _len));
+                    ++frames;
+                }
+                reset();
+                break;
+            }
+            }
+        }
+        return frames;
+        // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+    //! Decode all the bytes remaining in reader
+    template <typename Reader, typename F>
+    size_t decode(Reader& reader, F&& on_frame) {
+        const std::span<const uint8_t> span = reader.read_span(reader.bytes_remaining());
+        return decode(span.data(), span.size(), std::forward<F>(on_frame));
+    }
+    //! Discard any partly decoded frame
+    void reset() { _len = 0; _state = State::DATA; }
+    //! true if a frame has been started but not completed
+    bool in_frame() const { return _len != 0 || _state != State::DATA; }
+    //! number of frames discarded because of an invalid escape sequence
+    size_t errors() const { return _errors; }
+    //! number of frames discarded because they would not fit in the frame buffer
+    size_t dropped() const { return _dropped; }
+private:
+    enum class State : size_t { DATA, ESCAPE, DISCARD };
+private:
+    uint8_t* _buf;
+    size_t _capacity;
+    size_t _len {0};
+    size_t _errors {0};
+    size_t _dropped {0};
+    State _state {State::DATA};
+};
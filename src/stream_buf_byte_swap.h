@@ -0,0 +1,120 @@
+#pragma once
+
+#include "stream_buf_endian.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/*!
+Bulk byte swap kernels used by StreamBufWriter::write_array() and StreamBufReader::read_array().
+
+On x86 the swap uses AVX2 (byte shuffle, 32 bytes per iteration) if available, otherwise SSE2 (word shuffles and shifts, 16 bytes per iteration).
+On other targets, and for the tail of the array, a scalar loop is used which the compiler is free to auto-vectorize.
+*/
+namespace stream_buf {
+
+#if defined(__AVX2__)
+template <size_t N>
+inline __m256i byte_swap_mask_256() {
+    std::array<uint8_t, 32> mask {};
+    for (size_t ii = 0; ii < mask.size(); ++ii) {
+        // shuffle indices are relative to the 128-bit lane
+        mask[ii] = static_cast<uint8_t>(((ii % 16) & ~(N - 1)) + (N - 1) - (ii % N));
+    }
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&mask[0])); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+}
+#endif
+
+#if defined(__SSE2__)
+template <size_t N>
+inline __m128i byte_swap_128(__m128i value) {
+    if constexpr (N == 4) {
+        // swap the 16-bit words within each 32-bit word
+        value = _mm_shufflehi_epi16(_mm_shufflelo_epi16(value, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+    } else if constexpr (N == 8) {
+        // reverse the 16-bit words within each 64-bit word
+        value = _mm_shufflehi_epi16(_mm_shufflelo_epi16(value, _MM_SHUFFLE(0, 1, 2, 3)), _MM_SHUFFLE(0, 1, 2, 3));
+    }
+    // swap the bytes within each 16-bit word
+    return _mm_or_si128(_mm_slli_epi16(value, 8), _mm_srli_epi16(value, 8));
+}
+#endif
+
+/*!
+Copy count elements, each of N bytes, from src to dst, reversing the byte order of each element.
+src and dst need not be aligned, but must not overlap.
+*/
+template <size_t N>
+inline void copy_byte_swapped(void* dst, const void* src, size_t count) {
+    static_assert(N == 2 || N == 4 || N == 8, "element size must be 2, 4, or 8 bytes");
+    using U = typename unsigned_of_size<N>::type;
+    // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic,cppcoreguidelines-pro-type-reinterpret-cast)
+    auto* out = static_cast<uint8_t*>(dst);
+    const auto* in = static_cast<const uint8_t*>(src);
+    size_t len = count * N;
+#if defined(__AVX2__)
+    const __m256i mask = byte_swap_mask_256<N>();
+    for (; len >= 32; len -= 32, in += 32, out += 32) {
+        const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_shuffle_epi8(value, mask));
+    }
+#endif
+#if defined(__SSE2__)
+    for (; len >= 16; len -= 16, in += 16, out += 16) {
+        const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), byte_swap_128<N>(value));
+    }
+#endif
+    for (; len >= N; len -= N, in += N, out += N) {
+        U value; // NOLINT(cppcoreguidelines-init-variables)
+        memcpy(&value, in, N);
+        value = byte_swap(value);
+        memcpy(out, &value, N);
+    }
+    // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic,cppcoreguidelines-pro-type-reinterpret-cast)
+}
+
+/*!
+Copy count elements of type T from src to dst, converting between the target byte order and byte order E.
+This is a straight memcpy if the byte orders match.
+*/
+template <typename T, Endian E>
+inline void copy_array(void* dst, const void* src, size_t count) {
+    static_assert(is_wire_type<T>, "T must be an integral, floating point or enum type");
+    if constexpr (sizeof(T) == 1 || (E == Endian::BIG) == TARGET_IS_BIG_ENDIAN) {
+        memcpy(dst, src, count * sizeof(T));
+    } else {
+        copy_byte_swapped<sizeof(T)>(dst, src, count);
+    }
+}
+
+/*!
+Store count values of type T at dst in byte order E, as copy_array().
+In constant expressions, where the values cannot be copied as bytes, each value is stored in turn.
+*/
+template <typename T, Endian E>
+constexpr void store_array(uint8_t* dst, const T* src, size_t count) {
+    if (std::is_constant_evaluated()) {
+        for (size_t ii = 0; ii < count; ++ii) { store<T, E>(dst + ii * sizeof(T), src[ii]); } // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        return;
+    }
+    copy_array<T, E>(dst, src, count);
+}
+
+//! Load count values of type T in byte order E from src, as copy_array()
+template <typename T, Endian E>
+constexpr void load_array(T* dst, const uint8_t* src, size_t count) {
+    if (std::is_constant_evaluated()) {
+        for (size_t ii = 0; ii < count; ++ii) { dst[ii] = load<T, E>(src + ii * sizeof(T)); } // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        return;
+    }
+    copy_array<T, E>(dst, src, count);
+}
+
+} // namespace stream_buf
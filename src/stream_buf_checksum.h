@@ -0,0 +1,239 @@
+#pragma once
+
+#include "stream_buf_endian.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__PCLMUL__) && defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+/*!
+Checksum accumulators that may be attached to a StreamBufWriterT or StreamBufReaderT,
+so that bytes are folded into the checksum as they are written or read, rather than in a separate pass over the frame.
+
+Each accumulator has the same interface:
+    void update(const uint8_t* data, size_t len);
+    value_type value() const;
+    void reset();
+and so may also be used standalone, including in constant expressions.
+*/
+namespace stream_buf {
+
+//! no checksum, the default for StreamBufWriterT and StreamBufReaderT
+struct NoChecksum {};
+
+//! table for a byte at a time, non-reflected, CRC8
+constexpr std::array<uint8_t, 256> make_crc8_table(uint8_t polynomial) {
+    std::array<uint8_t, 256> table {};
+    for (size_t ii = 0; ii < table.size(); ++ii) {
+        auto crc = static_cast<uint8_t>(ii);
+        for (size_t bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x80U) ? static_cast<uint8_t>((crc << 1) ^ polynomial) : static_cast<uint8_t>(crc << 1);
+        }
+        table[ii] = crc;
+    }
+    return table;
+}
+
+//! table for a byte at a time, non-reflected, CRC16
+constexpr std::array<uint16_t, 256> make_crc16_table(uint16_t polynomial) {
+    std::array<uint16_t, 256> table {};
+    for (size_t ii = 0; ii < table.size(); ++ii) {
+        auto crc = static_cast<uint16_t>(ii << 8);
+        for (size_t bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x8000U) ? static_cast<uint16_t>((crc << 1) ^ polynomial) : static_cast<uint16_t>(crc << 1);
+        }
+        table[ii] = crc;
+    }
+    return table;
+}
+
+//! slicing-by-8 tables for a reflected CRC32, tables[0] is the byte at a time table
+constexpr std::array<std::array<uint32_t, 256>, 8> make_crc32_slicing_tables(uint32_t polynomial) {
+    std::array<std::array<uint32_t, 256>, 8> tables {};
+    for (size_t ii = 0; ii < 256; ++ii) {
+        auto crc = static_cast<uint32_t>(ii);
+        for (size_t bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1U) ? (crc >> 1) ^ polynomial : crc >> 1;
+        }
+        tables[0][ii] = crc;
+    }
+    for (size_t ii = 0; ii < 256; ++ii) {
+        for (size_t slice = 1; slice < 8; ++slice) {
+            const uint32_t previous = tables[slice - 1][ii];
+            tables[slice][ii] = (previous >> 8) ^ tables[0][previous & 0xFFU];
+        }
+    }
+    return tables;
+}
+
+//! XOR of all bytes, as used by MSP v1
+class Xor8 {
+public:
+    using value_type = uint8_t;
+    constexpr void reset() { _value = 0; }
+    constexpr uint8_t value() const { return _value; }
+    constexpr void update(const uint8_t* data, size_t len) {
+        // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        uint64_t word = 0;
+        for (; len >= sizeof(uint64_t); len -= sizeof(uint64_t), data += sizeof(uint64_t)) {
+            word ^= load_little_endian<uint64_t>(data);
+        }
+        word ^= word >> 32;
+        word ^= word >> 16;
+        word ^= word >> 8;
+        uint8_t value = _value ^ static_cast<uint8_t>(word);
+        for (; len > 0; --len) {
+            value ^= *data++;
+        }
+        _value = value;
+        // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+private:
+    uint8_t _value {0};
+};
+
+//! CRC8 with polynomial 0xD5, as used by DVB-S2, MSP v2, and CRSF
+class Crc8DvbS2 {
+public:
+    using value_type = uint8_t;
+    static constexpr uint8_t POLYNOMIAL = 0xD5;
+    static constexpr std::array<uint8_t, 256> TABLE = make_crc8_table(POLYNOMIAL);
+public:
+    constexpr void reset() { _value = 0; }
+    constexpr uint8_t value() const { return _value; }
+    constexpr void update(const uint8_t* data, size_t len) {
+        uint8_t crc = _value;
+        for (size_t ii = 0; ii < len; ++ii) {
+            crc = TABLE[crc ^ data[ii]]; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        }
+        _value = crc;
+    }
+private:
+    uint8_t _value {0};
+};
+
+//! CRC16 with polynomial 0x1021, not reflected. The initial value is 0xFFFF (CRC-16/CCITT-FALSE) by default.
+class Crc16Ccitt {
+public:
+    using value_type = uint16_t;
+    static constexpr uint16_t POLYNOMIAL = 0x1021;
+    static constexpr std::array<uint16_t, 256> TABLE = make_crc16_table(POLYNOMIAL);
+public:
+    constexpr explicit Crc16Ccitt(uint16_t initial_value = 0xFFFF) : _value(initial_value), _initial_value(initial_value) {}
+    constexpr void reset() { _value = _initial_value; }
+    constexpr uint16_t value() const { return _value; }
+    constexpr void update(const uint8_t* data, size_t len) {
+        uint16_t crc = _value;
+        for (size_t ii = 0; ii < len; ++ii) {
+            crc = static_cast<uint16_t>((crc << 8) ^ TABLE[static_cast<uint8_t>(crc >> 8) ^ data[ii]]); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        }
+        _value = crc;
+    }
+private:
+    uint16_t _value;
+    uint16_t _initial_value;
+};
+
+/*!
+CRC32 with reflected polynomial 0xEDB88320, as used by Ethernet, zlib, and PNG.
+
+Uses carry-less multiplication (PCLMULQDQ) for blocks of 64 bytes or more when available,
+otherwise slicing-by-8 tables, which process 8 bytes per iteration.
+*/
+class Crc32 {
+public:
+    using value_type = uint32_t;
+    static constexpr uint32_t POLYNOMIAL = 0xEDB88320;
+    static constexpr std::array<std::array<uint32_t, 256>, 8> TABLES = make_crc32_slicing_tables(POLYNOMIAL);
+public:
+    constexpr void reset() { _crc = 0xFFFFFFFF; }
+    constexpr uint32_t value() const { return ~_crc; }
+    constexpr void update(const uint8_t* data, size_t len) {
+        // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        uint32_t crc = _crc;
+#if defined(__PCLMUL__) && defined(__SSE4_1__)
+        if (!std::is_constant_evaluated() && len >= 64) {
+            const size_t chunk = len & ~size_t{15};
+            crc = update_pclmul(crc, data, chunk);
+            data += chunk;
+            len -= chunk;
+        }
+#endif
+        for (; len >= 8; len -= 8, data += 8) {
+            const uint32_t one = load_little_endian<uint32_t>(data) ^ crc;
+            const uint32_t two = load_little_endian<uint32_t>(data + 4);
+            crc = TABLES[7][one & 0xFFU] ^ TABLES[6][(one >> 8) & 0xFFU] ^ TABLES[5][(one >> 16) & 0xFFU] ^ TABLES[4][one >> 24]
+                ^ TABLES[3][two & 0xFFU] ^ TABLES[2][(two >> 8) & 0xFFU] ^ TABLES[1][(two >> 16) & 0xFFU] ^ TABLES[0][two >> 24];
+        }
+        for (; len > 0; --len) {
+            crc = (crc >> 8) ^ TABLES[0][(crc ^ *data++) & 0xFFU];
+        }
+        _crc = crc;
+        // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+private:
+#if defined(__PCLMUL__) && defined(__SSE4_1__)
+    /*!
+    Fold 64 bytes per iteration using carry-less multiplication, then Barrett reduce to 32 bits.
+    See "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction", Intel, 2009.
+    len must be a multiple of 16 and at least 64.
+    */
+    static uint32_t update_pclmul(uint32_t crc, const uint8_t* data, size_t len) {
+        // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic,cppcoreguidelines-pro-type-reinterpret-cast)
+        const __m128i k1k2 = _mm_set_epi64x(0x01C6E41596, 0x0154442BD4);
+        const __m128i k3k4 = _mm_set_epi64x(0x00CCAA009E, 0x01751997D0);
+        const __m128i k5k0 = _mm_set_epi64x(0x0000000000, 0x0163CD6124);
+        const __m128i poly = _mm_set_epi64x(0x01F7011641, 0x01DB710641);
+        const __m128i mask32 = _mm_setr_epi32(-1, 0, -1, 0);
+
+        __m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        __m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16));
+        __m128i x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 32));
+        __m128i x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 48));
+        x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(crc)));
+        data += 64;
+        len -= 64;
+
+        for (; len >= 64; len -= 64, data += 64) {
+            x1 = fold(x1, k1k2, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data)));
+            x2 = fold(x2, k1k2, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16)));
+            x3 = fold(x3, k1k2, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 32)));
+            x4 = fold(x4, k1k2, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 48)));
+        }
+        // fold into 128 bits
+        x1 = fold(x1, k3k4, x2);
+        x1 = fold(x1, k3k4, x3);
+        x1 = fold(x1, k3k4, x4);
+        for (; len >= 16; len -= 16, data += 16) {
+            x1 = fold(x1, k3k4, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data)));
+        }
+        // fold 128 bits to 64 bits
+        x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+        x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+        x2 = _mm_srli_si128(x1, 4);
+        x1 = _mm_and_si128(x1, mask32);
+        x1 = _mm_xor_si128(_mm_clmulepi64_si128(x1, k5k0, 0x00), x2);
+        // Barrett reduction to 32 bits
+        x2 = _mm_and_si128(x1, mask32);
+        x2 = _mm_clmulepi64_si128(x2, poly, 0x10);
+        x2 = _mm_and_si128(x2, mask32);
+        x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+        x1 = _mm_xor_si128(x1, x2);
+        return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+        // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic,cppcoreguidelines-pro-type-reinterpret-cast)
+    }
+    static __m128i fold(__m128i value, __m128i constants, __m128i data) {
+        const __m128i low = _mm_clmulepi64_si128(value, constants, 0x00);
+        const __m128i high = _mm_clmulepi64_si128(value, constants, 0x11);
+        return _mm_xor_si128(_mm_xor_si128(high, low), data);
+    }
+#endif
+private:
+    uint32_t _crc {0xFFFFFFFF};
+};
+
+} // namespace stream_buf
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/*!
+Byte order helpers used by StreamBufWriter and StreamBufReader.
+
+Multi-byte values are loaded and stored with a single (possibly unaligned) memcpy,
+which the compiler reduces to a single load or store instruction.
+The value is byte swapped only when the target byte order differs from the wire byte order.
+All the helpers may be used in constant expressions, where the bytes are assembled one at a time instead.
+*/
+namespace stream_buf {
+
+//! byte order of a value on the wire
+enum class Endian { LITTLE, BIG };
+
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+static constexpr bool TARGET_IS_BIG_ENDIAN = true;
+#else
+static constexpr bool TARGET_IS_BIG_ENDIAN = false;
+#endif
+
+constexpr uint8_t byte_swap(uint8_t value) { return value; }
+#if defined(__GNUC__) || defined(__clang__)
+constexpr uint16_t byte_swap(uint16_t value) { return __builtin_bswap16(value); }
+constexpr uint32_t byte_swap(uint32_t value) { return __builtin_bswap32(value); }
+constexpr uint64_t byte_swap(uint64_t value) { return __builtin_bswap64(value); }
+#else
+constexpr uint16_t byte_swap(uint16_t value) { return static_cast<uint16_t>((value << 8) | (value >> 8)); }
+constexpr uint32_t byte_swap(uint32_t value) {
+    return ((value & 0x000000FFU) << 24) | ((value & 0x0000FF00U) << 8) | ((value & 0x00FF0000U) >> 8) | ((value & 0xFF000000U) >> 24);
+}
+constexpr uint64_t byte_swap(uint64_t value) {
+    return (static_cast<uint64_t>(byte_swap(static_cast<uint32_t>(value))) << 32) | byte_swap(static_cast<uint32_t>(value >> 32));
+}
+#endif
+
+// NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+template <typename T>
+constexpr T load_little_endian(const uint8_t* ptr) {
+    if (std::is_constant_evaluated()) {
+        T value = 0;
+        for (size_t ii = sizeof(T); ii > 0; --ii) { value = static_cast<T>((value << 8U) | ptr[ii - 1]); }
+        return value;
+    }
+    T value; // NOLINT(cppcoreguidelines-init-variables)
+    memcpy(&value, ptr, sizeof(T));
+    if constexpr (TARGET_IS_BIG_ENDIAN) { value = byte_swap(value); }
+    return value;
+}
+
+template <typename T>
+constexpr T load_big_endian(const uint8_t* ptr) {
+    if (std::is_constant_evaluated()) {
+        T value = 0;
+        for (size_t ii = 0; ii < sizeof(T); ++ii) { value = static_cast<T>((value << 8U) | ptr[ii]); }
+        return value;
+    }
+    T value; // NOLINT(cppcoreguidelines-init-variables)
+    memcpy(&value, ptr, sizeof(T));
+    if constexpr (!TARGET_IS_BIG_ENDIAN) { value = byte_swap(value); }
+    return value;
+}
+
+template <typename T>
+constexpr void store_little_endian(uint8_t* ptr, T value) {
+    if (std::is_constant_evaluated()) {
+        for (size_t ii = 0; ii < sizeof(T); ++ii) { ptr[ii] = static_cast<uint8_t>(value >> (8 * ii)); }
+        return;
+    }
+    if constexpr (TARGET_IS_BIG_ENDIAN) { value = byte_swap(value); }
+    memcpy(ptr, &value, sizeof(T));
+}
+
+template <typename T>
+constexpr void store_big_endian(uint8_t* ptr, T value) {
+    if (std::is_constant_evaluated()) {
+        for (size_t ii = 0; ii < sizeof(T); ++ii) { ptr[ii] = static_cast<uint8_t>(value >> (8 * (sizeof(T) - 1 - ii))); }
+        return;
+    }
+    if constexpr (!TARGET_IS_BIG_ENDIAN) { value = byte_swap(value); }
+    memcpy(ptr, &value, sizeof(T));
+}
+// NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+//! unsigned integer type with the same size as T, used to byte swap any wire type
+template <size_t N> struct unsigned_of_size;
+template <> struct unsigned_of_size<1> { using type = uint8_t; };
+template <> struct unsigned_of_size<2> { using type = uint16_t; };
+template <> struct unsigned_of_size<4> { using type = uint32_t; };
+template <> struct unsigned_of_size<8> { using type = uint64_t; };
+
+template <typename T>
+static constexpr bool is_wire_type = std::is_integral_v<T> || std::is_floating_point_v<T> || std::is_enum_v<T>;
+
+/*!
+Load a value of type T in byte order E.
+T may be any integral, floating point or enum type; the load compiles to a single load plus, if required, a byte swap.
+*/
+template <typename T, Endian E = Endian::LITTLE>
+constexpr T load(const uint8_t* ptr) {
+    static_assert(is_wire_type<T>, "T must be an integral, floating point or enum type");
+    using U = typename unsigned_of_size<sizeof(T)>::type;
+    U bits; // NOLINT(cppcoreguidelines-init-variables)
+    if constexpr (E == Endian::BIG) { bits = load_big_endian<U>(ptr); } else { bits = load_little_endian<U>(ptr); }
+    return std::bit_cast<T>(bits);
+}
+
+//! Store a value of type T in byte order E.
+template <typename T, Endian E = Endian::LITTLE>
+constexpr void store(uint8_t* ptr, T value) {
+    static_assert(is_wire_type<T>, "T must be an integral, floating point or enum type");
+    using U = typename unsigned_of_size<sizeof(T)>::type;
+    const auto bits = std::bit_cast<U>(value);
+    if constexpr (E == Endian::BIG) { store_big_endian(ptr, bits); } else { store_little_endian(ptr, bits); }
+}
+
+} // namespace stream_buf
@@ -0,0 +1,363 @@
+#pragma once
+
+#include "stream_buf_ascii.h"
+#include "stream_buf_endian.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/*!
+Hexadecimal and Base64 (RFC 4648, with padding) encoding and decoding of binary data, used by StreamBufWriter::write_hex_encoded(),
+StreamBufWriter::write_base64(), StreamBufReader::read_hex_decoded() and StreamBufReader::read_base64().
+
+On x86 the kernels use SSSE3 (16 bytes per iteration), and AVX2 (32 bytes per iteration) if available.
+The digits are looked up with pshufb, using the nibble or sextet as the index into a table of digits, or of the offsets
+from the index to its digit. Decoding classifies the characters with byte compares, so invalid characters are detected
+for a whole vector at once, and pshufb and multiply-add instructions pack the decoded bits.
+Since SSE2 is always available on x86-64, hex also has SSE2 kernels, which form the digits with compares instead of pshufb.
+The scalar fallback encodes and decodes hex eight digits at a time in a 64-bit word, as for write_hex_u32(), and Base64
+using lookup tables.
+
+Hex is encoded in upper case, and decoded in either case.
+*/
+namespace stream_buf {
+
+//! number of characters of the Base64 encoding of len bytes, including padding
+constexpr size_t base64_encoded_size(size_t len) { return (len + 2) / 3 * 4; }
+
+inline constexpr std::array<uint8_t, 64> BASE64_ALPHABET = {
+    'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z',
+    'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z',
+    '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '+', '/'
+};
+
+//! value of each Base64 character, 0xFF for characters outside the alphabet
+inline constexpr std::array<uint8_t, 256> BASE64_VALUES = []() {
+    std::array<uint8_t, 256> values {};
+    values.fill(0xFF);
+    for (size_t ii = 0; ii < BASE64_ALPHABET.size(); ++ii) { values[BASE64_ALPHABET[ii]] = static_cast<uint8_t>(ii); }
+    return values;
+}();
+
+#if defined(__SSE2__)
+//! convert each byte of nibbles, which must each be less than 16, to an upper case hexadecimal ASCII digit
+inline __m128i hex_digits(__m128i nibbles) {
+#if defined(__SSSE3__)
+    return _mm_shuffle_epi8(_mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'), nibbles);
+#else
+    const __m128i letters = _mm_and_si128(_mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9)), _mm_set1_epi8('A' - '9' - 1));
+    return _mm_add_epi8(_mm_add_epi8(nibbles, _mm_set1_epi8('0')), letters);
+#endif
+}
+#endif
+
+/*!
+Write the len bytes at src as 2 * len hexadecimal digits at dst.
+*/
+inline void hex_encode(uint8_t* dst, const uint8_t* src, size_t len) {
+    // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic,cppcoreguidelines-pro-type-reinterpret-cast)
+    size_t pos = 0;
+#if defined(__AVX2__)
+    const __m256i digits_256 = _mm256_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F',
+                                                 '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F');
+    const __m256i nibble_256 = _mm256_set1_epi8(0x0F);
+    for (; pos + 32 <= len; pos += 32) {
+        const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + pos));
+        const __m256i high = _mm256_shuffle_epi8(digits_256, _mm256_and_si256(_mm256_srli_epi16(bytes, 4), nibble_256));
+        const __m256i low = _mm256_shuffle_epi8(digits_256, _mm256_and_si256(bytes, nibble_256));
+        // the unpacks interleave within each 128-bit lane, so the lanes are then reordered
+        const __m256i first = _mm256_unpacklo_epi8(high, low);
+        const __m256i second = _mm256_unpackhi_epi8(high, low);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 2 * pos), _mm256_permute2x128_si256(first, second, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 2 * pos + 32), _mm256_permute2x128_si256(first, second, 0x31));
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    for (; pos + 16 <= len; pos += 16) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + pos));
+        const __m128i high = hex_digits(_mm_and_si128(_mm_srli_epi16(bytes, 4), nibble));
+        const __m128i low = hex_digits(_mm_and_si128(bytes, nibble));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * pos), _mm_unpacklo_epi8(high, low));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * pos + 16), _mm_unpackhi_epi8(high, low));
+    }
+#endif
+    uint8_t* out = dst + 2 * pos;
+    for (; pos + 4 <= len; pos += 4, out += 8) {
+        encode_hex(out, load_big_endian<uint32_t>(src + pos), 8, 8);
+    }
+    for (; pos < len; ++pos, out += 2) {
+        encode_hex(out, src[pos], 2, 2);
+    }
+    // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic,cppcoreguidelines-pro-type-reinterpret-cast)
+}
+
+#if defined(__SSE2__)
+//! value of each hex digit in chars, setting the bytes of invalid for characters that are not hex digits
+inline __m128i hex_values(__m128i chars, __m128i& invalid) {
+    const __m128i digit = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+    const __m128i letter = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    // unsigned compares, values below the range wrap around to large values
+    const __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+    const __m128i is_letter = _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+    invalid = _mm_or_si128(invalid, _mm_andnot_si128(_mm_or_si128(is_digit, is_letter), _mm_set1_epi8(-1)));
+    return _mm_or_si128(_mm_and_si128(is_digit, digit), _mm_and_si128(is_letter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+}
+#endif
+#if defined(__AVX2__)
+inline __m256i hex_values(__m256i chars, __m256i& invalid) {
+    const __m256i digit = _mm256_sub_epi8(chars, _mm256_set1_epi8('0'));
+    const __m256i letter = _mm256_sub_epi8(_mm256_or_si256(chars, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    const __m256i is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+    const __m256i is_letter = _mm256_cmpeq_epi8(_mm256_min_epu8(letter, _mm256_set1_epi8(5)), letter);
+    invalid = _mm256_or_si256(invalid, _mm256_andnot_si256(_mm256_or_si256(is_digit, is_letter), _mm256_set1_epi8(-1)));
+    return _mm256_or_si256(_mm256_and_si256(is_digit, digit), _mm256_and_si256(is_letter, _mm256_add_epi8(letter, _mm256_set1_epi8(10))));
+}
+#endif
+
+/*!
+Decode the 2 * len hexadecimal digits at src to len bytes at dst.
+Returns false if any character is not a hex digit, in which case the contents of dst are unspecified.
+*/
+inline bool hex_decode(uint8_t* dst, const uint8_t* src, size_t len) {
+    // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic,cppcoreguidelines-pro-type-reinterpret-cast)
+    size_t pos = 0;
+#if defined(__AVX2__)
+    __m256i invalid_256 = _mm256_setzero_si256();
+    for (; pos + 32 <= len; pos += 32) {
+        const __m256i first = hex_values(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 2 * pos)), invalid_256);
+        const __m256i second = hex_values(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 2 * pos + 32)), invalid_256);
+        // each pair of digits forms high * 16 + low, then the pack interleaves the lanes, which the permute undoes
+        const __m256i weights = _mm256_set1_epi16(0x0110);
+        const __m256i bytes = _mm256_packus_epi16(_mm256_maddubs_epi16(first, weights), _mm256_maddubs_epi16(second, weights));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + pos), _mm256_permute4x64_epi64(bytes, 0xD8));
+    }
+    if (_mm256_movemask_epi8(invalid_256) != 0) {
+        return false;
+    }
+#endif
+#if defined(__SSE2__)
+    __m128i invalid = _mm_setzero_si128();
+    // each 16-bit lane holds a pair of digit values, the high digit in its low byte
+    const auto pair_values = [](__m128i pairs) { return _mm_or_si128(_mm_and_si128(_mm_slli_epi16(pairs, 4), _mm_set1_epi16(0x00F0)), _mm_srli_epi16(pairs, 8)); };
+    for (; pos + 16 <= len; pos += 16) {
+        const __m128i first = hex_values(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * pos)), invalid);
+        const __m128i second = hex_values(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * pos + 16)), invalid);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + pos), _mm_packus_epi16(pair_values(first), pair_values(second)));
+    }
+    if (_mm_movemask_epi8(invalid) != 0) {
+        return false;
+    }
+#endif
+    for (; pos < len; pos += 4) {
+        const size_t count = std::min(len - pos, size_t{4});
+        const uint64_t word = load_digits(src + 2 * pos, 2 * count);
+        if (hex_digit_count(word) < 2 * count) {
+            return false;
+        }
+        const uint32_t value = hex_parse_word(word, 2 * count);
+        for (size_t ii = 0; ii < count; ++ii) { dst[pos + ii] = static_cast<uint8_t>(value >> (8 * (count - 1 - ii))); }
+    }
+    return true;
+    // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic,cppcoreguidelines-pro-type-reinterpret-cast)
+}
+
+#if defined(__SSSE3__)
+/*!
+Split each 3 bytes of the low 12 bytes of the 16 bytes of input, shuffled as by base64_encode(), into 4 sextets,
+and convert them to Base64 characters.
+This is the method of Wojciech Muła, see http://0x80.pl/notesen/2016-01-12-sse-base64-encoding.html
+*/
+inline __m128i base64_encode_block(__m128i input) {
+    // the multiplies shift the sextets of each 32-bit group into the low 6 bits of each byte
+    const __m128i bytes = _mm_shuffle_epi8(input, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+    const __m128i ac = _mm_mulhi_epu16(_mm_and_si128(bytes, _mm_set1_epi32(0x0FC0FC00)), _mm_set1_epi32(0x04000040));
+    const __m128i bd = _mm_mullo_epi16(_mm_and_si128(bytes, _mm_set1_epi32(0x003F03F0)), _mm_set1_epi32(0x01000010));
+    const __m128i sextets = _mm_or_si128(ac, bd);
+    // reduce the sextets to an index of their range, 0 for 'a'-'z', 1-10 for '0'-'9', 11 for '+', 12 for '/', 13 for 'A'-'Z'
+    __m128i range = _mm_subs_epu8(sextets, _mm_set1_epi8(51));
+    range = _mm_or_si128(range, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), sextets), _mm_set1_epi8(13)));
+    const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                          '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    return _mm_add_epi8(sextets, _mm_shuffle_epi8(offsets, range));
+}
+#endif
+#if defined(__AVX2__)
+inline __m256i base64_encode_block(__m256i input) {
+    const __m256i bytes = _mm256_shuffle_epi8(input, _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                                                                      1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+    const __m256i ac = _mm256_mulhi_epu16(_mm256_and_si256(bytes, _mm256_set1_epi32(0x0FC0FC00)), _mm256_set1_epi32(0x04000040));
+    const __m256i bd = _mm256_mullo_epi16(_mm256_and_si256(bytes, _mm256_set1_epi32(0x003F03F0)), _mm256_set1_epi32(0x01000010));
+    const __m256i sextets = _mm256_or_si256(ac, bd);
+    __m256i range = _mm256_subs_epu8(sextets, _mm256_set1_epi8(51));
+    range = _mm256_or_si256(range, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), sextets), _mm256_set1_epi8(13)));
+    const __m256i offsets = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                             '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+                                             'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                             '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    return _mm256_add_epi8(sextets, _mm256_shuffle_epi8(offsets, range));
+}
+#endif
+
+/*!
+Write the Base64 encoding of the len bytes at src, base64_encoded_size(len) characters, at dst.
+*/
+inline void base64_encode(uint8_t* dst, const uint8_t* src, size_t len) {
+    // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic,cppcoreguidelines-pro-type-reinterpret-cast)
+    size_t pos = 0;
+    uint8_t* out = dst;
+#if defined(__AVX2__)
+    // each 128-bit lane encodes 12 bytes, and the loads read 4 bytes beyond them
+    for (; pos + 28 <= len; pos += 24, out += 32) {
+        const __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + pos));
+        const __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + pos + 12));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), base64_encode_block(_mm256_inserti128_si256(_mm256_castsi128_si256(first), second, 1)));
+    }
+#endif
+#if defined(__SSSE3__)
+    for (; pos + 16 <= len; pos += 12, out += 16) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), base64_encode_block(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + pos))));
+    }
+#endif
+    for (; pos + 3 <= len; pos += 3, out += 4) {
+        const uint32_t group = (static_cast<uint32_t>(src[pos]) << 16) | (static_cast<uint32_t>(src[pos + 1]) << 8) | src[pos + 2];
+        out[0] = BASE64_ALPHABET[group >> 18];
+        out[1] = BASE64_ALPHABET[(group >> 12) & 0x3F];
+        out[2] = BASE64_ALPHABET[(group >> 6) & 0x3F];
+        out[3] = BASE64_ALPHABET[group & 0x3F];
+    }
+    if (pos < len) {
+        const bool two = (pos + 2 == len);
+        const uint32_t group = (static_cast<uint32_t>(src[pos]) << 16) | (two ? static_cast<uint32_t>(src[pos + 1]) << 8 : 0);
+        out[0] = BASE64_ALPHABET[group >> 18];
+        out[1] = BASE64_ALPHABET[(group >> 12) & 0x3F];
+        out[2] = two ? BASE64_ALPHABET[(group >> 6) & 0x3F] : '=';
+        out[3] = '=';
+    }
+    // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic,cppcoreguidelines-pro-type-reinterpret-cast)
+}
+
+#if defined(__SSSE3__)
+//! set the bytes of chars in the range [low, high], the characters are all ASCII, so signed compares suffice
+inline __m128i bytes_in_range(__m128i chars, char low, char high) {
+    return _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8(static_cast<char>(low - 1))), _mm_cmpgt_epi8(_mm_set1_epi8(static_cast<char>(high + 1)), chars));
+}
+/*!
+Decode 16 Base64 characters to 12 bytes, in the low 12 bytes of the result,
+setting the bytes of invalid for characters outside the alphabet.
+*/
+inline __m128i base64_decode_block(__m128i chars, __m128i& invalid) {
+    const __m128i upper = bytes_in_range(chars, 'A', 'Z');
+    const __m128i lower = bytes_in_range(chars, 'a', 'z');
+    const __m128i digit = bytes_in_range(chars, '0', '9');
+    const __m128i plus = _mm_cmpeq_epi8(chars, _mm_set1_epi8('+'));
+    const __m128i slash = _mm_cmpeq_epi8(chars, _mm_set1_epi8('/'));
+    invalid = _mm_or_si128(invalid, _mm_andnot_si128(_mm_or_si128(_mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, plus)), slash), _mm_set1_epi8(-1)));
+    // add the offset from each character to its value
+    __m128i offset = _mm_and_si128(upper, _mm_set1_epi8(-'A'));
+    offset = _mm_or_si128(offset, _mm_and_si128(lower, _mm_set1_epi8(26 - 'a')));
+    offset = _mm_or_si128(offset, _mm_and_si128(digit, _mm_set1_epi8(52 - '0')));
+    offset = _mm_or_si128(offset, _mm_and_si128(plus, _mm_set1_epi8(62 - '+')));
+    offset = _mm_or_si128(offset, _mm_and_si128(slash, _mm_set1_epi8(63 - '/')));
+    const __m128i sextets = _mm_add_epi8(chars, offset);
+    // merge pairs of sextets into 12 bits, then pairs of those into 24 bits, and shuffle the 3 bytes of each into big endian order
+    const __m128i pairs = _mm_maddubs_epi16(sextets, _mm_set1_epi32(0x01400140));
+    const __m128i groups = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+    return _mm_shuffle_epi8(groups, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+}
+#endif
+#if defined(__AVX2__)
+inline __m256i bytes_in_range(__m256i chars, char low, char high) {
+    return _mm256_and_si256(_mm256_cmpgt_epi8(chars, _mm256_set1_epi8(static_cast<char>(low - 1))), _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(high + 1)), chars));
+}
+inline __m256i base64_decode_block(__m256i chars, __m256i& invalid) {
+    const __m256i upper = bytes_in_range(chars, 'A', 'Z');
+    const __m256i lower = bytes_in_range(chars, 'a', 'z');
+    const __m256i digit = bytes_in_range(chars, '0', '9');
+    const __m256i plus = _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('+'));
+    const __m256i slash = _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('/'));
+    invalid = _mm256_or_si256(invalid, _mm256_andnot_si256(_mm256_or_si256(_mm256_or_si256(_mm256_or_si256(upper, lower), _mm256_or_si256(digit, plus)), slash), _mm256_set1_epi8(-1)));
+    __m256i offset = _mm256_and_si256(upper, _mm256_set1_epi8(-'A'));
+    offset = _mm256_or_si256(offset, _mm256_and_si256(lower, _mm256_set1_epi8(26 - 'a')));
+    offset = _mm256_or_si256(offset, _mm256_and_si256(digit, _mm256_set1_epi8(52 - '0')));
+    offset = _mm256_or_si256(offset, _mm256_and_si256(plus, _mm256_set1_epi8(62 - '+')));
+    offset = _mm256_or_si256(offset, _mm256_and_si256(slash, _mm256_set1_epi8(63 - '/')));
+    const __m256i sextets = _mm256_add_epi8(chars, offset);
+    const __m256i pairs = _mm256_maddubs_epi16(sextets, _mm256_set1_epi32(0x01400140));
+    const __m256i groups = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+    const __m256i bytes = _mm256_shuffle_epi8(groups, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                                                       2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+    // move the 12 bytes of the upper lane down to follow those of the lower lane
+    return _mm256_permutevar8x32_epi32(bytes, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+}
+#endif
+
+/*!
+Decode len bytes from their Base64 encoding, of base64_encoded_size(len) characters, at src to dst.
+Returns false if any character is outside the alphabet, or the padding is incorrect, in which case the contents of dst are unspecified.
+*/
+inline bool base64_decode(uint8_t* dst, const uint8_t* src, size_t len) {
+    // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic,cppcoreguidelines-pro-type-reinterpret-cast)
+    const size_t groups_size = len / 3 * 3; // bytes in whole groups, the final partial group is padded
+    size_t pos = 0;
+    const uint8_t* in = src;
+#if defined(__AVX2__)
+    // 32 characters decode to 24 bytes, stored as 16 and 8, so nothing is written beyond dst + len
+    __m256i invalid_256 = _mm256_setzero_si256();
+    for (; pos + 24 <= groups_size; pos += 24, in += 32) {
+        const __m256i bytes = base64_decode_block(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in)), invalid_256);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + pos), _mm256_castsi256_si128(bytes));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + pos + 16), _mm256_extracti128_si256(bytes, 1));
+    }
+    if (_mm256_movemask_epi8(invalid_256) != 0) {
+        return false;
+    }
+#endif
+#if defined(__SSSE3__)
+    // 16 characters decode to 12 bytes, stored as 8 and 4
+    __m128i invalid = _mm_setzero_si128();
+    for (; pos + 12 <= groups_size; pos += 12, in += 16) {
+        const __m128i bytes = base64_decode_block(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)), invalid);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + pos), bytes);
+        store_little_endian(dst + pos + 8, static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(bytes, 8))));
+    }
+    if (_mm_movemask_epi8(invalid) != 0) {
+        return false;
+    }
+#endif
+    for (; pos < groups_size; pos += 3, in += 4) {
+        const uint32_t a = BASE64_VALUES[in[0]];
+        const uint32_t b = BASE64_VALUES[in[1]];
+        const uint32_t c = BASE64_VALUES[in[2]];
+        const uint32_t d = BASE64_VALUES[in[3]];
+        if ((a | b | c | d) > 0x3F) {
+            return false;
+        }
+        const uint32_t group = (a << 18) | (b << 12) | (c << 6) | d;
+        dst[pos] = static_cast<uint8_t>(group >> 16);
+        dst[pos + 1] = static_cast<uint8_t>(group >> 8);
+        dst[pos + 2] = static_cast<uint8_t>(group);
+    }
+    if (pos < len) {
+        const bool two = (pos + 2 == len);
+        const uint32_t a = BASE64_VALUES[in[0]];
+        const uint32_t b = BASE64_VALUES[in[1]];
+        const uint32_t c = two ? BASE64_VALUES[in[2]] : 0;
+        if ((a | b | c) > 0x3F || (!two && in[2] != '=') || in[3] != '=') {
+            return false;
+        }
+        const uint32_t group = (a << 18) | (b << 12) | (c << 6);
+        dst[pos] = static_cast<uint8_t>(group >> 16);
+        if (two) {
+            dst[pos + 1] = static_cast<uint8_t>(group >> 8);
+        }
+    }
+    return true;
+    // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic,cppcoreguidelines-pro-type-reinterpret-cast)
+}
+
+} // namespace stream_buf
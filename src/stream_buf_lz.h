@@ -0,0 +1,334 @@
+#pragma once
+
+#include "stream_buf_reader.h"
+#include "stream_buf_writer.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+/*!
+Streaming LZ77 compression, in the style of LZ4 blocks, using a caller provided window and no heap.
+
+The compressor collects its input in the window, and when the window is full, or on flush(), compresses the new bytes
+as a block written to a StreamBufWriter. Matches may refer back to any earlier byte still in the window, so a larger window
+gives a better ratio, at the cost of RAM. After each block the most recent half of the window is kept as history.
+The decompressor mirrors the compressor, decoding each block into its own window of the same size, and presents the
+decompressed bytes of each block as a StreamBufReader.
+
+Each block is
+    raw_size:u16 stored_size:u16 data[stored_size]
+where the data is stored uncompressed if stored_size == raw_size, otherwise it is a sequence of LZ4 style sequences:
+    token:u8 [literal_length...] literals [offset:u16 [match_length...]]
+The high nibble of the token is the number of literals and the low nibble is the match length minus 4, a nibble of 15
+being followed by further length bytes, each added to the length, until a byte that is not 255.
+The final sequence of the block has only literals.
+
+The window size is at most 65535 bytes, so that block sizes and offsets fit in 16 bits.
+*/
+namespace stream_buf {
+
+static constexpr size_t LZ_WINDOW_SIZE_MAX = UINT16_MAX;
+static constexpr size_t LZ_BLOCK_HEADER_SIZE = 4;
+static constexpr size_t LZ_MATCH_MIN = 4;
+
+//! maximum size of a block of len bytes, including its header
+constexpr size_t lz_block_size_max(size_t len) { return LZ_BLOCK_HEADER_SIZE + len + len / 255 + 16; }
+
+} // namespace stream_buf
+
+/*!
+LZ compressor, see stream_buf_lz.h.
+The hash table of recent positions, of 2^HASH_BITS entries of 4 bytes, is held in the compressor.
+*/
+template <size_t HASH_BITS = 12>
+class LzCompressor {
+public:
+    LzCompressor(uint8_t* window, size_t window_size) : _window(window), _window_size(std::min(window_size, stream_buf::LZ_WINDOW_SIZE_MAX)) {}
+public:
+    //! Discard the history and any pending input, the decompressor must also be reset
+    void reset() {
+        _size = 0;
+        _pending = 0;
+        _base = 0;
+        _hash_table.fill(0);
+    }
+    //! number of bytes written but not yet compressed
+    size_t bytes_pending() const { return _size - _pending; }
+    /*!
+    Copy len bytes at data into the window, compressing a block to out whenever the window fills.
+    Returns the number of bytes consumed, which is less than len only if out has insufficient space for a block.
+    */
+    template <typename Writer>
+    size_t write(Writer& out, const uint8_t* data, size_t len) {
+        size_t consumed = 0;
+        while (consumed < len) {
+            if (_size == _window_size && !compress_block(out)) {
+                break;
+            }
+            const size_t chunk = std::min(len - consumed, _window_size - _size);
+            memcpy(_window + _size, data + consumed, chunk); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            _size += chunk;
+            consumed += chunk;
+        }
+        return consumed;
+    }
+    /*!
+    Reserve len bytes of the window, so that a message may be serialized directly into the window, without copying.
+    If there is insufficient space a block is compressed to out first. len must be at most half the window size.
+    Returns a writer with no space if the block could not be written.
+    */
+    template <typename Writer>
+    StreamBufWriter reserve(Writer& out, size_t len) {
+        if (_size + len > _window_size && bytes_pending() != 0 && !compress_block(out)) {
+            return StreamBufWriter(_window + _size, size_t{0}); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        }
+        return StreamBufWriter(_window + _size, std::min(len, _window_size - _size)); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+    //! Add the bytes written to a writer returned by reserve() to the input
+    void commit(const StreamBufWriter& reservation) { _size += reservation.bytes_written(); }
+    /*!
+    Compress any pending input as a block to out.
+    Returns false, leaving the input pending, if out has insufficient space for the block.
+    */
+    template <typename Writer>
+    bool flush(Writer& out) { return bytes_pending() == 0 || compress_block(out); }
+private:
+    static uint32_t hash(uint32_t sequence) { return (sequence * 2654435761U) >> (32 - HASH_BITS); }
+    static void write_length(StreamBufWriter& block, size_t len) {
+        for (; len >= 255; len -= 255) {
+            block.write_u8(255);
+        }
+        block.write_u8(static_cast<uint8_t>(len));
+    }
+    static void write_sequence(StreamBufWriter& block, const uint8_t* literals, size_t literal_len, size_t offset, size_t match_len) {
+        const size_t match_code = match_len - stream_buf::LZ_MATCH_MIN;
+        block.write_u8(static_cast<uint8_t>((std::min(literal_len, size_t{15}) << 4) | std::min(match_code, size_t{15})));
+        if (literal_len >= 15) {
+            write_length(block, literal_len - 15);
+        }
+        block.write_data(literals, literal_len);
+        block.write_u16(static_cast<uint16_t>(offset));
+        if (match_code >= 15) {
+            write_length(block, match_code - 15);
+        }
+    }
+    static void write_last_literals(StreamBufWriter& block, const uint8_t* literals, size_t literal_len) {
+        block.write_u8(static_cast<uint8_t>(std::min(literal_len, size_t{15}) << 4));
+        if (literal_len >= 15) {
+            write_length(block, literal_len - 15);
+        }
+        block.write_data(literals, literal_len);
+    }
+    //! length of the match between the bytes at a and b, a being before b, up to end
+    static size_t match_length(const uint8_t* a, const uint8_t* b, const uint8_t* end) {
+        // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        const uint8_t* const start = b;
+        while (b + sizeof(uint64_t) <= end) {
+            const uint64_t diff = stream_buf::load<uint64_t>(a) ^ stream_buf::load<uint64_t>(b);
+            if (diff != 0) {
+                // the loads are little endian, so the first differing byte is the lowest non-zero byte of diff
+                return static_cast<size_t>(b - start) + stream_buf::count_trailing_zeros(diff) / 8;
+            }
+            a += sizeof(uint64_t);
+            b += sizeof(uint64_t);
+        }
+        while (b < end && *a == *b) {
+            ++a;
+            ++b;
+        }
+        return static_cast<size_t>(b - start);
+        // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+    /*!
+    Compress the pending input as a block, using a greedy parse: at each position the most recent earlier position with
+    the same 4-byte hash is checked for a match, and if there is none the scan skips ahead faster the longer it has gone
+    without finding one, so incompressible data is passed over quickly.
+    */
+    template <typename Writer>
+    bool compress_block(Writer& out) {
+        const size_t raw_size = _size - _pending;
+        const size_t size_max = stream_buf::lz_block_size_max(raw_size);
+        StreamBufWriter block = out.reserve(size_max);
+        if (block.bytes_remaining() < size_max) {
+            return false;
+        }
+        block.write_u16(static_cast<uint16_t>(raw_size));
+        const stream_buf::Placeholder<uint16_t> stored_size = block.reserve_u16();
+
+        // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        const auto base = static_cast<uint32_t>(_base);
+        const uint8_t* const end = _window + _size;
+        const uint8_t* anchor = _window + _pending;
+        const uint8_t* ptr = anchor;
+        while (ptr + stream_buf::LZ_MATCH_MIN <= end) {
+            const uint32_t sequence = stream_buf::load<uint32_t>(ptr);
+            const auto index = static_cast<uint32_t>(ptr - _window);
+            uint32_t& entry = _hash_table[hash(sequence)];
+            const uint32_t offset = base + index - entry;
+            entry = base + index;
+            if (offset == 0 || offset > index || stream_buf::load<uint32_t>(ptr - offset) != sequence) {
+                ptr += 1 + (static_cast<size_t>(ptr - anchor) >> 6U);
+                continue;
+            }
+            const size_t len = stream_buf::LZ_MATCH_MIN + match_length(ptr - offset + stream_buf::LZ_MATCH_MIN, ptr + stream_buf::LZ_MATCH_MIN, end);
+            write_sequence(block, anchor, static_cast<size_t>(ptr - anchor), offset, len);
+            ptr += len;
+            anchor = ptr;
+            if (ptr + stream_buf::LZ_MATCH_MIN <= end) {
+                // index the position just before the next, which improves the ratio for data with short repeats
+                _hash_table[hash(stream_buf::load<uint32_t>(ptr - 2))] = base + static_cast<uint32_t>(ptr - 2 - _window);
+            }
+        }
+        write_last_literals(block, anchor, static_cast<size_t>(end - anchor));
+
+        if (block.bytes_written() - stream_buf::LZ_BLOCK_HEADER_SIZE >= raw_size) {
+            // incompressible, so store the block
+            block.reset();
+            block.write_u16(static_cast<uint16_t>(raw_size));
+            block.write_u16(static_cast<uint16_t>(raw_size));
+            block.write_data(_window + _pending, raw_size);
+        } else {
+            block.patch(stored_size, static_cast<uint16_t>(block.bytes_written() - stream_buf::LZ_BLOCK_HEADER_SIZE));
+        }
+        out.commit(block);
+
+        // keep the most recent half of the window as history
+        const size_t history = _window_size / 2;
+        if (_size > history) {
+            memmove(_window, _window + _size - history, history);
+            _base += _size - history;
+            _size = history;
+        }
+        _pending = _size;
+        return true;
+        // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+private:
+    uint8_t* _window;
+    size_t _window_size;
+    size_t _size {0}; //!< number of bytes in the window, history followed by pending input
+    size_t _pending {0}; //!< start of the pending input
+    size_t _base {0}; //!< stream position of the start of the window, the hash table holds stream positions modulo 2^32
+    std::array<uint32_t, size_t{1} << HASH_BITS> _hash_table {};
+};
+
+/*!
+LZ decompressor, see stream_buf_lz.h. The window must be the same size as the compressor's window.
+Decoding is bounds checked, so corrupt data cannot cause reads or writes outside the input or the window.
+*/
+class LzDecompressor {
+public:
+    LzDecompressor(uint8_t* window, size_t window_size) : _window(window), _window_size(std::min(window_size, stream_buf::LZ_WINDOW_SIZE_MAX)) {}
+public:
+    //! Discard the history, as when the compressor is reset
+    void reset() { _size = 0; }
+    //! number of corrupt blocks encountered, after each of which the decompressor is reset
+    size_t errors() const { return _errors; }
+    /*!
+    Decompress the next block from in, returning a reader over its decompressed bytes, which remain valid until the next block is read.
+    If in does not hold a complete block, returns an empty reader and leaves in unchanged.
+    */
+    template <typename Reader>
+    StreamBufReader read_block(Reader& in) {
+        // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        const std::span<const uint8_t> header = in.peek_span(stream_buf::LZ_BLOCK_HEADER_SIZE);
+        if (header.size() < stream_buf::LZ_BLOCK_HEADER_SIZE) {
+            return StreamBufReader(_window, size_t{0});
+        }
+        const size_t raw_size = stream_buf::load<uint16_t>(&header[0]);
+        const size_t stored_size = stream_buf::load<uint16_t>(&header[2]);
+        const std::span<const uint8_t> block = in.peek_span(stream_buf::LZ_BLOCK_HEADER_SIZE + stored_size);
+        if (block.size() < stream_buf::LZ_BLOCK_HEADER_SIZE + stored_size) {
+            return StreamBufReader(_window, size_t{0});
+        }
+        in.advance(block.size());
+
+        const size_t history = _window_size / 2;
+        if (_size > history) {
+            memmove(_window, _window + _size - history, history);
+            _size = history;
+        }
+        uint8_t* const start = _window + _size;
+        const uint8_t* const data = &block[stream_buf::LZ_BLOCK_HEADER_SIZE];
+        bool ok = raw_size <= _window_size - _size;
+        if (ok && stored_size == raw_size) {
+            memcpy(start, data, raw_size);
+        } else if (ok) {
+            ok = decode(data, stored_size, start, raw_size);
+        }
+        if (!ok) {
+            ++_errors;
+            reset();
+            return StreamBufReader(_window, size_t{0});
+        }
+        _size += raw_size;
+        return StreamBufReader(start, raw_size);
+        // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+private:
+    static bool read_length(const uint8_t*& src, const uint8_t* src_end, size_t& len) {
+        uint8_t byte = 0;
+        do {
+            if (src == src_end) {
+                return false;
+            }
+            byte = *src++; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            len += byte;
+        } while (byte == 255);
+        return true;
+    }
+    //! Decode the sequences at src to dst, returns false if the data is corrupt
+    bool decode(const uint8_t* src, size_t src_len, uint8_t* dst, size_t dst_len) const {
+        // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        const uint8_t* const src_end = src + src_len;
+        uint8_t* const dst_end = dst + dst_len;
+        while (src < src_end) {
+            const uint8_t token = *src++;
+            size_t literal_len = token >> 4U;
+            if (literal_len == 15 && !read_length(src, src_end, literal_len)) {
+                return false;
+            }
+            if (literal_len > static_cast<size_t>(src_end - src) || literal_len > static_cast<size_t>(dst_end - dst)) {
+                return false;
+            }
+            memcpy(dst, src, literal_len);
+            src += literal_len;
+            dst += literal_len;
+            if (src == src_end) {
+                break; // the final sequence has only literals
+            }
+            if (src_end - src < 2) {
+                return false;
+            }
+            const size_t offset = stream_buf::load<uint16_t>(src);
+            src += 2;
+            size_t match_len = token & 0x0FU;
+            if (match_len == 15 && !read_length(src, src_end, match_len)) {
+                return false;
+            }
+            match_len += stream_buf::LZ_MATCH_MIN;
+            if (offset == 0 || offset > static_cast<size_t>(dst - _window) || match_len > static_cast<size_t>(dst_end - dst)) {
+                return false;
+            }
+            const uint8_t* match = dst - offset;
+            if (offset >= match_len) {
+                memcpy(dst, match, match_len);
+                dst += match_len;
+            } else {
+                // overlapping match, which repeats the last offset bytes
+                for (const uint8_t* const end = dst + match_len; dst < end;) {
+                    *dst++ = *match++;
+                }
+            }
+        }
+        return dst == dst_end;
+        // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+private:
+    uint8_t* _window;
+    size_t _window_size;
+    size_t _size {0}; //!< number of bytes of history in the window
+    size_t _errors {0};
+};
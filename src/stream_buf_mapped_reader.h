@@ -0,0 +1,112 @@
+#pragma once
+
+#include "stream_buf_reader.h"
+
+#if __has_include(<sys/mman.h>)
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+template <typename BoundsPolicy>
+class MappedStreamBufReaderT;
+
+//! Mapped reader without bounds checking on the plain read functions, use the Checked or Sticky variants for untrusted files
+using MappedStreamBufReader = MappedStreamBufReaderT<stream_buf::Unchecked>;
+using MappedStreamBufReaderChecked = MappedStreamBufReaderT<stream_buf::Checked>;
+using MappedStreamBufReaderSticky = MappedStreamBufReaderT<stream_buf::Sticky>;
+
+/*!
+Reader over a file that is memory mapped read only, for decoding large log files on POSIX hosts.
+The file is not read into memory up front, pages are faulted in as they are read, so startup is immediate
+and the whole file is never copied.
+
+The mapping is advised as sequential, and prefetch() issues a sliding read ahead of the read pointer
+and releases pages well behind it, so that the resident set stays bounded for multi-gigabyte files.
+Pages that are released are faulted back in from the file if they are read again.
+
+If the file cannot be opened or mapped, the reader is empty and is_mapped() returns false.
+*/
+template <typename BoundsPolicy>
+class MappedStreamBufReaderT : public StreamBufReaderT<BoundsPolicy> {
+public:
+    static constexpr size_t PREFETCH_DISTANCE = 4 * 1024 * 1024;
+    static constexpr size_t RELEASE_DISTANCE = 16 * 1024 * 1024;
+private:
+    struct Mapping {
+        const uint8_t* data;
+        size_t len;
+    };
+public:
+    explicit MappedStreamBufReaderT(const char* path) : MappedStreamBufReaderT(map_path(path)) {}
+    //! Map the file open on fd, the descriptor is not owned by the reader and may be closed once the reader is constructed
+    explicit MappedStreamBufReaderT(int fd) : MappedStreamBufReaderT(map_fd(fd)) {}
+    ~MappedStreamBufReaderT() {
+        if (_mapped_len != 0) {
+            munmap(const_cast<uint8_t*>(this->_begin), _mapped_len); // NOLINT(cppcoreguidelines-pro-type-const-cast)
+        }
+    }
+    MappedStreamBufReaderT(const MappedStreamBufReaderT&) = delete;
+    MappedStreamBufReaderT& operator=(const MappedStreamBufReaderT&) = delete;
+    MappedStreamBufReaderT(MappedStreamBufReaderT&&) = delete;
+    MappedStreamBufReaderT& operator=(MappedStreamBufReaderT&&) = delete;
+public:
+    bool is_mapped() const { return _mapped_len != 0; }
+    size_t size() const { return _mapped_len; }
+
+    /*!
+    Advise the kernel to read ahead PREFETCH_DISTANCE bytes beyond the read pointer, and to release pages more than
+    RELEASE_DISTANCE bytes behind it. This is cheap when there is nothing to do, so may be called once per record.
+    */
+    void prefetch() {
+        const size_t offset = static_cast<size_t>(this->_ptr - this->_begin);
+        if (offset + PREFETCH_DISTANCE / 2 >= _prefetched && _prefetched < _mapped_len) {
+            const size_t end = std::min(offset + PREFETCH_DISTANCE, _mapped_len);
+            const size_t start = std::max(_prefetched, offset) & ~(page_size() - 1);
+            madvise(mapped_address(start), end - start, MADV_WILLNEED);
+            _prefetched = end;
+        }
+        if (offset >= _released + 2 * RELEASE_DISTANCE) {
+            const size_t end = (offset - RELEASE_DISTANCE) & ~(page_size() - 1);
+            madvise(mapped_address(_released), end - _released, MADV_DONTNEED);
+            _released = end;
+        }
+    }
+private:
+    explicit MappedStreamBufReaderT(Mapping mapping) : StreamBufReaderT<BoundsPolicy>(mapping.data, mapping.len), _mapped_len(mapping.len) {
+        if (_mapped_len != 0) {
+            madvise(mapped_address(0), _mapped_len, MADV_SEQUENTIAL);
+            prefetch();
+        }
+    }
+    void* mapped_address(size_t offset) const { return const_cast<uint8_t*>(this->_begin + offset); } // NOLINT(cppcoreguidelines-pro-type-const-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    static size_t page_size() { return static_cast<size_t>(sysconf(_SC_PAGESIZE)); }
+    static Mapping map_fd(int fd) {
+        static const uint8_t empty {};
+        struct stat status {};
+        if (fd < 0 || fstat(fd, &status) != 0 || status.st_size <= 0) {
+            return { &empty, 0 };
+        }
+        const auto len = static_cast<size_t>(status.st_size);
+        void* data = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) { // NOLINT(cppcoreguidelines-pro-type-cstyle-cast,performance-no-int-to-ptr)
+            return { &empty, 0 };
+        }
+        return { static_cast<const uint8_t*>(data), len };
+    }
+    static Mapping map_path(const char* path) {
+        const int fd = open(path, O_RDONLY); // NOLINT(cppcoreguidelines-pro-type-vararg)
+        const Mapping mapping = map_fd(fd);
+        if (fd >= 0) {
+            close(fd);
+        }
+        return mapping;
+    }
+private:
+    size_t _mapped_len;
+    size_t _prefetched {0}; //!< offset up to which read ahead has been requested
+    size_t _released {0}; //!< offset below which pages have been released
+};
+
+#endif
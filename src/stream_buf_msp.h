@@ -0,0 +1,298 @@
+#pragma once
+
+#include "stream_buf_reader.h"
+#include "stream_buf_writer.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <span>
+
+/*!
+MSP (MultiWii Serial Protocol) v1 and v2 framing, layered on StreamBufWriter and StreamBufReader.
+
+A v1 frame is
+    '$' 'M' direction size:u8 command:u8 payload[size] checksum:u8
+where the checksum is the XOR of size, command, and the payload.
+A v2 frame is
+    '$' 'X' direction flags:u8 command:u16 size:u16 payload[size] crc:u8
+where the u16 fields are little endian and the crc is CRC8 DVB-S2 of flags through to the end of the payload.
+The direction is '<' for a request, '>' for a response, and '!' for an error response.
+v1 jumbo frames, which have a size of 255, are not supported.
+*/
+namespace stream_buf {
+
+enum class MspVersion : uint8_t { V1 = 1, V2 = 2 };
+//! the third byte of the frame
+enum class MspDirection : uint8_t { REQUEST = '<', RESPONSE = '>', ERROR = '!' };
+
+//! A decoded frame, the payload is a view that is only valid for the duration of the frame callback
+struct MspFrame {
+    std::span<const uint8_t> payload;
+    uint32_t command;
+    MspVersion version;
+    MspDirection direction;
+    uint8_t flags; //!< always zero for v1
+    uint8_t checksum;
+};
+
+static constexpr size_t MSP_V1_OVERHEAD = 6; //!< preamble(3) size command ... checksum
+static constexpr size_t MSP_V2_OVERHEAD = 9; //!< preamble(3) flags command(2) size(2) ... crc
+static constexpr size_t MSP_V1_PAYLOAD_SIZE_MAX = 254;
+
+/*!
+Write a v1 frame, with a single bounds check for the whole frame. The checksum is folded in as the frame is written.
+Returns false, writing nothing, if there is insufficient space or the payload is too large for v1.
+*/
+template <typename Writer>
+bool write_msp_v1(Writer& writer, MspDirection direction, uint8_t command, const uint8_t* payload, size_t len) {
+    if (len > MSP_V1_PAYLOAD_SIZE_MAX) {
+        return false;
+    }
+    Xor8 checksum;
+    auto frame = writer.reserve(MSP_V1_OVERHEAD + len, checksum);
+    if (frame.bytes_remaining() < MSP_V1_OVERHEAD + len) {
+        return false;
+    }
+    frame.write_u8('$');
+    frame.write_u8('M');
+    frame.write_u8(static_cast<uint8_t>(direction));
+    checksum.reset(); // the checksum does not cover the preamble
+    frame.write_u8(static_cast<uint8_t>(len));
+    frame.write_u8(command);
+    frame.write_data(payload, len);
+    frame.write_u8(checksum.value());
+    writer.commit(frame);
+    return true;
+}
+
+//! Write a v2 frame, as write_msp_v1(). Returns false, writing nothing, if there is insufficient space.
+template <typename Writer>
+bool write_msp_v2(Writer& writer, MspDirection direction, uint16_t command, const uint8_t* payload, size_t len, uint8_t flags = 0) {
+    if (len > UINT16_MAX) {
+        return false;
+    }
+    Crc8DvbS2 crc;
+    auto frame = writer.reserve(MSP_V2_OVERHEAD + len, crc);
+    if (frame.bytes_remaining() < MSP_V2_OVERHEAD + len) {
+        return false;
+    }
+    frame.write_u8('$');
+    frame.write_u8('X');
+    frame.write_u8(static_cast<uint8_t>(direction));
+    crc.reset(); // the crc does not cover the preamble
+    frame.write_u8(flags);
+    frame.write_u16(command);
+    frame.write_u16(static_cast<uint16_t>(len));
+    frame.write_data(payload, len);
+    frame.write_u8(crc.value());
+    writer.commit(frame);
+    return true;
+}
+
+//! Write frame, eg to forward a decoded frame. The checksum is recalculated.
+template <typename Writer>
+bool write_msp(Writer& writer, const MspFrame& frame) {
+    if (frame.version == MspVersion::V1) {
+        return frame.command <= UINT8_MAX
+            && write_msp_v1(writer, frame.direction, static_cast<uint8_t>(frame.command), frame.payload.data(), frame.payload.size());
+    }
+    return frame.command <= UINT16_MAX
+        && write_msp_v2(writer, frame.direction, static_cast<uint16_t>(frame.command), frame.payload.data(), frame.payload.size(), frame.flags);
+}
+
+} // namespace stream_buf
+
+/*!
+Incremental MSP v1 and v2 decoder, for bytes that arrive a few at a time, eg from a UART.
+
+decode() consumes a chunk of bytes and calls on_frame(const MspFrame&) for each complete frame with a valid checksum.
+Frames that lie entirely within the chunk are passed as views into the chunk, without copying.
+Frames that straddle chunks are assembled in the payload buffer, which limits the payload size.
+The payload size limit applies in both cases, so whether a frame is accepted does not depend on how the stream is chunked.
+
+The state machine is a switch, rather than a function per state, and consumes the payload in bulk rather than a byte at a time.
+The start of a frame is found using memchr, and checksums are calculated over the whole frame once its checksum byte arrives.
+Bytes that are not part of a valid frame are skipped.
+
+The payload buffer is not owned by the decoder and must outlive it.
+*/
+class MspDecoder {
+public:
+    MspDecoder(uint8_t* buf, size_t capacity) : _buf(buf), _capacity(capacity) {}
+public:
+    //! Decode len bytes at data, calling on_frame for each complete frame. Returns the number of frames decoded.
+    template <typename F>
+    size_t decode(const uint8_t* data, size_t len, F&& on_frame) {
+        // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        size_t frames = 0;
+        const uint8_t* const end = data + len;
+        while (data < end) {
+            switch (_state) {
+            case State::IDLE: {
+                const auto* start = static_cast<const uint8_t*>(memchr(data, '$', static_cast<size_t>(end - data)));
+                if (start == nullptr) {
+                    return frames;
+                }
+                // fast path, the whole frame is in the chunk so may be passed as a view into it
+                const size_t frame_size = decode_contiguous(start, static_cast<size_t>(end - start), on_frame, frames);
+                if (frame_size != 0) {
+                    data = start + frame_size;
+                    break;
+                }
+                data = start + 1;
+                _state = State::PROTOCOL;
+                break;
+            }
+            case State::PROTOCOL: {
+                const uint8_t byte = *data++;
+                if (byte == 'M' || byte == 'X') {
+                    _version = (byte == 'M') ? stream_buf::MspVersion::V1 : stream_buf::MspVersion::V2;
+                    _state = State::DIRECTION;
+                } else {
+                    _state = (byte == '$') ? State::PROTOCOL : State::IDLE;
+                }
+                break;
+            }
+            case State::DIRECTION: {
+                const uint8_t byte = *data++;
+                if (is_direction(byte)) {
+                    _direction = static_cast<stream_buf::MspDirection>(byte);
+                    _header_len = 0;
+                    _state = State::HEADER;
+                } else {
+                    _state = (byte == '$') ? State::PROTOCOL : State::IDLE;
+                }
+                break;
+            }
+            case State::HEADER: {
+                const size_t chunk = std::min(header_size(_version) - _header_len, static_cast<size_t>(end - data));
+                memcpy(&_header[_header_len], data, chunk);
+                data += chunk;
+                _header_len += chunk;
+                if (_header_len == header_size(_version)) {
+                    _payload_size = payload_size(_version, &_header[0]);
+                    _payload_len = 0;
+                    if (_payload_size > _capacity || (_version == stream_buf::MspVersion::V1 && _payload_size > stream_buf::MSP_V1_PAYLOAD_SIZE_MAX)) {
+                        ++_dropped;
+                        _state = State::IDLE;
+                    } else {
+                        _state = (_payload_size == 0) ? State::CHECKSUM : State::PAYLOAD;
+                    }
+                }
+                break;
+            }
+            case State::PAYLOAD: {
+                const size_t chunk = std::min(_payload_size - _payload_len, static_cast<size_t>(end - data));
+                memcpy(_buf + _payload_len, data, chunk);
+                data += chunk;
+                _payload_len += chunk;
+                if (_payload_len == _payload_size) {
+                    _state = State::CHECKSUM;
+                }
+                break;
+            }
+            case State::CHECKSUM: {
+                const uint8_t received = *data++;
+                _state = State::IDLE;
+                const std::span<const uint8_t> payload(_buf, _payload_size);
+                if (received != checksum(_version, &_header[0], payload)) {
+                    ++_checksum_errors;
+                    break;
+                }
+                on_frame(make_frame(_version, _direction, &_header[0], payload, received));
+                ++frames;
+                break;
+            }
+            }
+        }
+        return frames;
+        // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+    //! Decode all the bytes remaining in reader
+    template <typename Reader, typename F>
+    size_t decode(Reader& reader, F&& on_frame) {
+        const std::span<const uint8_t> span = reader.read_span(reader.bytes_remaining());
+        return decode(span.data(), span.size(), std::forward<F>(on_frame));
+    }
+    //! Discard any partly decoded frame
+    void reset() { _state = State::IDLE; }
+    //! true if a frame has been started but not completed
+    bool in_frame() const { return _state != State::IDLE; }
+    //! number of frames discarded because of a checksum mismatch
+    size_t checksum_errors() const { return _checksum_errors; }
+    //! number of frames discarded because their payload would not fit in the payload buffer
+    size_t dropped() const { return _dropped; }
+private:
+    enum class State : uint8_t { IDLE, PROTOCOL, DIRECTION, HEADER, PAYLOAD, CHECKSUM };
+    static constexpr size_t PREAMBLE_SIZE = 3;
+    static constexpr size_t V1_HEADER_SIZE = 2; //!< size command
+    static constexpr size_t V2_HEADER_SIZE = 5; //!< flags command(2) size(2)
+
+    static bool is_direction(uint8_t byte) { return byte == '<' || byte == '>' || byte == '!'; }
+    static size_t header_size(stream_buf::MspVersion version) { return (version == stream_buf::MspVersion::V1) ? V1_HEADER_SIZE : V2_HEADER_SIZE; }
+    static size_t payload_size(stream_buf::MspVersion version, const uint8_t* header) {
+        return (version == stream_buf::MspVersion::V1) ? header[0] : stream_buf::load<uint16_t>(header + 3); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+    static uint8_t checksum(stream_buf::MspVersion version, const uint8_t* header, std::span<const uint8_t> payload) {
+        if (version == stream_buf::MspVersion::V1) {
+            stream_buf::Xor8 xor8;
+            xor8.update(header, V1_HEADER_SIZE);
+            xor8.update(payload.data(), payload.size());
+            return xor8.value();
+        }
+        stream_buf::Crc8DvbS2 crc;
+        crc.update(header, V2_HEADER_SIZE);
+        crc.update(payload.data(), payload.size());
+        return crc.value();
+    }
+    static stream_buf::MspFrame make_frame(stream_buf::MspVersion version, stream_buf::MspDirection direction, const uint8_t* header, std::span<const uint8_t> payload, uint8_t checksum) {
+        if (version == stream_buf::MspVersion::V1) {
+            return { payload, header[1], version, direction, 0, checksum }; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        }
+        return { payload, stream_buf::load<uint16_t>(header + 1), version, direction, header[0], checksum }; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+    /*!
+    Decode the frame starting with the '$' at start, if it lies entirely within the available bytes.
+    Returns the size of the frame, which is passed to on_frame if its checksum is valid, or zero if the frame is incomplete or its header is invalid.
+    */
+    template <typename F>
+    size_t decode_contiguous(const uint8_t* start, size_t available, F& on_frame, size_t& frames) {
+        // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        if (available < PREAMBLE_SIZE + V1_HEADER_SIZE + 1 || (start[1] != 'M' && start[1] != 'X') || !is_direction(start[2])) {
+            return 0;
+        }
+        const stream_buf::MspVersion version = (start[1] == 'M') ? stream_buf::MspVersion::V1 : stream_buf::MspVersion::V2;
+        const uint8_t* header = start + PREAMBLE_SIZE;
+        if (available < PREAMBLE_SIZE + header_size(version) + 1) {
+            return 0;
+        }
+        const size_t size = payload_size(version, header);
+        const size_t frame_size = PREAMBLE_SIZE + header_size(version) + size + 1;
+        if (available < frame_size || size > _capacity || (version == stream_buf::MspVersion::V1 && size > stream_buf::MSP_V1_PAYLOAD_SIZE_MAX)) {
+            // incomplete, or oversized which the state machine counts and drops
+            return 0;
+        }
+        const std::span<const uint8_t> payload(header + header_size(version), size);
+        const uint8_t received = start[frame_size - 1];
+        if (received != checksum(version, header, payload)) {
+            ++_checksum_errors;
+            return frame_size;
+        }
+        on_frame(make_frame(version, static_cast<stream_buf::MspDirection>(start[2]), header, payload, received));
+        ++frames;
+        return frame_size;
+        // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+private:
+    uint8_t* _buf;
+    size_t _capacity;
+    size_t _payload_size {0};
+    size_t _payload_len {0}; //!< number of payload bytes received so far
+    size_t _header_len {0}; //!< number of header bytes received so far
+    size_t _checksum_errors {0};
+    size_t _dropped {0};
+    std::array<uint8_t, V2_HEADER_SIZE> _header {};
+    State _state {State::IDLE};
+    stream_buf::MspVersion _version {stream_buf::MspVersion::V1};
+    stream_buf::MspDirection _direction {stream_buf::MspDirection::REQUEST};
+};
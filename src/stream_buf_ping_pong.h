@@ -0,0 +1,88 @@
+#pragma once
+
+#include "stream_buf_writer.h"
+#include <array>
+#include <atomic>
+#include <span>
+
+namespace stream_buf {
+//! default alignment of DMA buffers, the cache line size of the Cortex-M7 and of most application processors
+static constexpr size_t DMA_ALIGNMENT = 32;
+} // namespace stream_buf
+
+/*!
+Double buffered (ping-pong) writer, for transmitting with DMA without the CPU waiting for a transfer to complete.
+
+Messages are written to the active buffer using reserve() and commit(). swap() returns the bytes written so far,
+for the caller to start a transfer, and makes the other buffer active, so writing continues while the transfer is in progress.
+When the transfer completes, transfer_complete() must be called, typically from the DMA complete interrupt, to release the buffer.
+Until then swap() returns an empty span and writing continues to accumulate in the active buffer.
+
+Both buffers are aligned to ALIGNMENT bytes and are a multiple of ALIGNMENT bytes long, so that when ALIGNMENT is the
+cache line size, cleaning the data cache over a buffer before a transfer does not affect the other buffer or the state.
+
+swap() and transfer_complete() may be called from different contexts, but each must only be called from one context.
+*/
+template <size_t BUFFER_SIZE, size_t ALIGNMENT = stream_buf::DMA_ALIGNMENT>
+class StreamBufPingPong {
+    static_assert(BUFFER_SIZE % ALIGNMENT == 0, "BUFFER_SIZE must be a multiple of ALIGNMENT");
+public:
+    StreamBufPingPong() = default;
+    StreamBufPingPong(const StreamBufPingPong&) = delete;
+    StreamBufPingPong& operator=(const StreamBufPingPong&) = delete;
+    StreamBufPingPong(StreamBufPingPong&&) = delete;
+    StreamBufPingPong& operator=(StreamBufPingPong&&) = delete;
+public:
+    static constexpr size_t capacity() { return BUFFER_SIZE; }
+    //! number of bytes written to the active buffer
+    size_t bytes_written() const { return _size; }
+    //! space remaining in the active buffer
+    size_t bytes_remaining() const { return BUFFER_SIZE - _size; }
+    //! returns true if a buffer returned by swap() has not yet been released by transfer_complete()
+    bool is_transmitting() const { return _transmit_size.load(std::memory_order_acquire) != 0; }
+    //! number of transfers completed since construction
+    size_t transfer_count() const { return _transfer_count.load(std::memory_order_relaxed); }
+    /*!
+    Reserve len bytes in the active buffer. Returns a writer over the region, the unchecked write functions may be used on it.
+    If there is insufficient space the returned writer has zero capacity, that is bytes_remaining() == 0.
+    */
+    StreamBufWriter reserve(size_t len) {
+        if (len > bytes_remaining()) {
+            return { active(), size_t{0} };
+        }
+        return { active() + _size, len }; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+    //! Add the bytes written to a writer obtained from reserve() to the active buffer
+    void commit(const StreamBufWriter& reservation) { _size += reservation.bytes_written(); }
+    /*!
+    If the previous transfer has completed, return the bytes written to the active buffer, for the caller to transmit,
+    and make the other buffer active. The returned bytes remain valid until transfer_complete() is called.
+    Returns an empty span, leaving the active buffer unchanged, if a transfer is in progress or nothing has been written.
+    */
+    std::span<const uint8_t> swap() {
+        if (_size == 0 || is_transmitting()) {
+            return {};
+        }
+        const std::span<const uint8_t> completed(active(), _size);
+        _transmit_size.store(_size, std::memory_order_release);
+        _active ^= 1U;
+        _size = 0;
+        return completed;
+    }
+    //! Release the buffer returned by swap(), to be called when its transfer is complete
+    void transfer_complete() {
+        if (_transmit_size.load(std::memory_order_relaxed) != 0) {
+            // only this function writes the count, so no read-modify-write is required
+            _transfer_count.store(_transfer_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            _transmit_size.store(0, std::memory_order_release);
+        }
+    }
+private:
+    uint8_t* active() { return &_buffers[_active][0]; }
+private:
+    alignas(ALIGNMENT) std::array<std::array<uint8_t, BUFFER_SIZE>, 2> _buffers {};
+    size_t _active {0}; //!< index of the buffer being written
+    size_t _size {0}; //!< number of bytes written to the active buffer
+    std::atomic<size_t> _transmit_size {0}; //!< size of the buffer being transmitted, zero if there is none
+    std::atomic<size_t> _transfer_count {0};
+};
@@ -1,31 +1,114 @@
 #pragma once
 
 #include "stream_buf_writer.h"
+#include <span>
+#include <string_view>
+
+template <typename BoundsPolicy, typename Checksum = stream_buf::NoChecksum>
+class StreamBufReaderT;
+
+//! Reader without bounds checking on the plain read functions, this is the default
+using StreamBufReader = StreamBufReaderT<stream_buf::Unchecked>;
+using StreamBufReaderChecked = StreamBufReaderT<stream_buf::Checked>;
+using StreamBufReaderSticky = StreamBufReaderT<stream_buf::Sticky>;
+//! Reader that counts its bounds checks, see stream_buf::Counting
+using StreamBufReaderCounting = StreamBufReaderT<stream_buf::Counting>;
+//! Reader that refills a fixed window from a source, see stream_buf_source.h
+template <typename Source>
+using StreamBufReaderRefilling = StreamBufReaderT<stream_buf::Refilling<Source>>;
 
 /*!
 Simple read only deserializer with optional bounds checking
+
+BoundsPolicy is one of stream_buf::Unchecked, stream_buf::Checked, stream_buf::Sticky, stream_buf::Counting, or stream_buf::Refilling
+and determines the bounds checking performed by the plain read functions.
+For the Refilling policy the peek functions do not refill, so only see the bytes already in the window.
+
+Checksum is stream_buf::NoChecksum, or a checksum accumulator such as stream_buf::Crc8DvbS2,
+into which bytes are folded as they are read.
+
+The reader may be used in constant expressions, except with the Refilling policy and for the string view functions,
+see stream_buf::read_frame().
 */
-class StreamBufReader {
+template <typename BoundsPolicy, typename Checksum>
+class StreamBufReaderT {
 public:
-    StreamBufReader(const uint8_t* ptr, size_t len) : _ptr(ptr), _begin(ptr), _end(ptr + len + 1) {}
-    StreamBufReader(const uint8_t* ptr, const uint8_t* end) : _ptr(ptr), _begin(ptr), _end(end) {}
-    explicit StreamBufReader(const StreamBufWriter& stream_buf) : _ptr(stream_buf.ptr()), _begin(stream_buf.begin()), _end(stream_buf.end()) {}
+    constexpr StreamBufReaderT(const uint8_t* ptr, size_t len) : _ptr(ptr), _begin(ptr), _end(ptr + len + 1) { static_assert(!HAS_CHECKSUM, "checksum required"); }
+    constexpr StreamBufReaderT(const uint8_t* ptr, const uint8_t* end) : _ptr(ptr), _begin(ptr), _end(end) { static_assert(!HAS_CHECKSUM, "checksum required"); }
+    template <typename WriterBoundsPolicy, typename WriterChecksum>
+    constexpr explicit StreamBufReaderT(const StreamBufWriterT<WriterBoundsPolicy, WriterChecksum>& stream_buf) : _ptr(stream_buf.ptr()), _begin(stream_buf.begin()), _end(stream_buf.end()) { static_assert(!HAS_CHECKSUM, "checksum required"); }
+    /*!
+    Construct a reader with a checksum accumulator attached, all bytes read are folded into the checksum.
+    The checksum is not owned by the reader and must outlive it.
+    */
+    constexpr StreamBufReaderT(const uint8_t* ptr, size_t len, Checksum& checksum) : _ptr(ptr), _begin(ptr), _end(ptr + len + 1), _checksum(&checksum) {}
+    constexpr StreamBufReaderT(const uint8_t* ptr, const uint8_t* end, Checksum& checksum) : _ptr(ptr), _begin(ptr), _end(end), _checksum(&checksum) {}
+    /*!
+    Construct a reader over a window of capacity bytes that is refilled from source, see stream_buf::Refilling.
+    The window is initially empty, it is first filled by the first read.
+    */
+    template <typename Source> requires std::is_same_v<BoundsPolicy, stream_buf::Refilling<Source>>
+    constexpr StreamBufReaderT(uint8_t* window, size_t capacity, Source& source)
+        : _ptr(window), _begin(window), _end(window + 1), _bounds{&source, window, capacity, 0} { static_assert(!HAS_CHECKSUM, "checksum required"); }
+    template <typename Source> requires std::is_same_v<BoundsPolicy, stream_buf::Refilling<Source>>
+    constexpr StreamBufReaderT(uint8_t* window, size_t capacity, Checksum& checksum, Source& source)
+        : _ptr(window), _begin(window), _end(window + 1), _checksum(&checksum), _bounds{&source, window, capacity, 0} {}
 public:
-    void reset() { _ptr = _begin; }
-    bool is_empty() const { return _ptr == _begin; }
-    bool is_full() const { return _ptr + 1 >= _end; }
-    const uint8_t* ptr() const { return _ptr; }
-    const uint8_t* begin() const { return _begin; }
-    const uint8_t* end() const { return _end; }
+    static constexpr bool IS_COUNTING = std::is_same_v<BoundsPolicy, stream_buf::Counting>;
+    //! true if the plain functions are not bounds checked
+    static constexpr bool IS_UNCHECKED = std::is_same_v<BoundsPolicy, stream_buf::Unchecked> || IS_COUNTING;
+    static constexpr bool IS_STICKY = std::is_same_v<BoundsPolicy, stream_buf::Sticky>;
+    static constexpr bool IS_REFILLING = stream_buf::is_refilling<BoundsPolicy>;
+    static constexpr bool HAS_CHECKSUM = !std::is_same_v<Checksum, stream_buf::NoChecksum>;
+
+    constexpr void reset() {
+        _ptr = _begin;
+        if constexpr (IS_STICKY) {
+            if (_bounds.end_offset != 0) {
+                _end = _begin + _bounds.end_offset;
+                _bounds.end_offset = 0;
+            }
+        }
+    }
+    //! returns true if there has been an overflow since construction or the last reset(), always false unless the policy is Sticky
+    constexpr bool overflowed() const {
+        if constexpr (IS_STICKY) { return _bounds.end_offset != 0; }
+        return false;
+    }
+    //! returns the number of bounds checks performed since construction, always zero unless the policy is Counting
+    constexpr size_t bounds_checks() const {
+        if constexpr (IS_COUNTING) { return _bounds.checks; }
+        return 0;
+    }
+    constexpr bool is_empty() const { return _ptr == _begin; }
+    constexpr bool is_full() const { return _ptr + 1 >= _end; }
+    constexpr const uint8_t* ptr() const { return _ptr; }
+    constexpr const uint8_t* begin() const { return _begin; }
+    constexpr const uint8_t* end() const { return _end; }
 
     //! return the number of bytes remaining in the buffer
-    size_t bytes_remaining() const { return static_cast<size_t>(_end - _ptr - 1); } // guaranteed to be >= 0
-    size_t bytes_read() const { return static_cast<size_t>(_ptr - _begin); } // guaranteed to be >= 0
+    constexpr size_t bytes_remaining() const { return static_cast<size_t>(_end - _ptr - 1); } // guaranteed to be >= 0
+    //! for the Refilling policy this is the number of bytes read from the start of the stream
+    constexpr size_t bytes_read() const {
+        if constexpr (IS_REFILLING) { return _bounds.discarded + static_cast<size_t>(_ptr - _begin); }
+        return static_cast<size_t>(_ptr - _begin); // guaranteed to be >= 0
+    }
 
     //! Advance _ptr, this skips data
-    void advance(size_t size) { if (_ptr + size < _end) { _ptr += size; } }
+    constexpr void advance(size_t size) {
+        if constexpr (IS_REFILLING) {
+            read_refilling(size, 1, [](const uint8_t*, size_t, size_t) {});
+        } else if (fits(size)) {
+            advance_unchecked(size);
+        }
+    }
+    /*!
+    Check that len bytes are available, so that a fixed layout message can be validated with a single bounds check
+    and then decoded using the unchecked read functions.
+    */
+    constexpr bool require(size_t len) { return fits(len); }
      //! modifies internal pointers so that data can be read
-    const uint8_t* switch_to_reader() {
+    constexpr const uint8_t* switch_to_reader() {
         const uint8_t* end_previous = _end;
         _end = _ptr + 1;
         _ptr = _begin;
@@ -34,65 +117,362 @@ public:
 //
 // Read functions
 //
-    uint8_t read_u8() { return *_ptr++; }
-    uint16_t read_u16() { return read_u8() | static_cast<uint16_t>(read_u8() << 8); }
-    uint32_t read_u32() {
-        uint32_t ret = read_u8();
-        ret |= static_cast<uint32_t>(read_u8() <<  8);
-        ret |= static_cast<uint32_t>(read_u8() << 16);
-        ret |= static_cast<uint32_t>(read_u8() << 24);
+    /*!
+    Read a value of type T in byte order E.
+    T may be any integral, floating point or enum type.
+    */
+    template <typename T, stream_buf::Endian E = stream_buf::Endian::LITTLE>
+    constexpr T read() {
+        if constexpr (IS_UNCHECKED) { return read_unchecked<T, E>(); }
+        return read_checked<T, E>();
+    }
+    //! Read a value of type T in byte order E, returns zero if there is not enough data remaining
+    template <typename T, stream_buf::Endian E = stream_buf::Endian::LITTLE>
+    constexpr T read_checked() { if (fits(sizeof(T))) { return read_unchecked<T, E>(); } return T{}; }
+    //! Read a value of type T in byte order E, regardless of BoundsPolicy
+    template <typename T, stream_buf::Endian E = stream_buf::Endian::LITTLE>
+    constexpr T read_unchecked() { const T ret = stream_buf::load<T, E>(_ptr); advance_unchecked(sizeof(T)); return ret; }
+    constexpr uint8_t read_u8() { return read<uint8_t>(); }
+    constexpr uint16_t read_u16() { return read<uint16_t>(); }
+    constexpr uint32_t read_u32() { return read<uint32_t>(); }
+    constexpr uint64_t read_u64() { return read<uint64_t>(); }
+    constexpr int8_t read_s8() { return read<int8_t>(); }
+    constexpr int16_t read_s16() { return read<int16_t>(); }
+    constexpr int32_t read_s32() { return read<int32_t>(); }
+    constexpr int64_t read_s64() { return read<int64_t>(); }
+    constexpr float read_f32() { return read<float>(); }
+    constexpr double read_f64() { return read<double>(); }
+    constexpr uint16_t read_u16_big_endian() { return read<uint16_t, stream_buf::Endian::BIG>(); }
+    constexpr uint32_t read_u32_big_endian() { return read<uint32_t, stream_buf::Endian::BIG>(); }
+    constexpr uint64_t read_u64_big_endian() { return read<uint64_t, stream_buf::Endian::BIG>(); }
+    constexpr int16_t read_s16_big_endian() { return read<int16_t, stream_buf::Endian::BIG>(); }
+    constexpr int32_t read_s32_big_endian() { return read<int32_t, stream_buf::Endian::BIG>(); }
+    constexpr int64_t read_s64_big_endian() { return read<int64_t, stream_buf::Endian::BIG>(); }
+    constexpr float read_f32_big_endian() { return read<float, stream_buf::Endian::BIG>(); }
+    constexpr double read_f64_big_endian() { return read<double, stream_buf::Endian::BIG>(); }
+
+    constexpr uint8_t read_u8_checked() { return read_checked<uint8_t>(); }
+    constexpr uint16_t read_u16_checked() { return read_checked<uint16_t>(); }
+    constexpr uint32_t read_u32_checked() { return read_checked<uint32_t>(); }
+    constexpr uint64_t read_u64_checked() { return read_checked<uint64_t>(); }
+    constexpr int8_t read_s8_checked() { return read_checked<int8_t>(); }
+    constexpr int16_t read_s16_checked() { return read_checked<int16_t>(); }
+    constexpr int32_t read_s32_checked() { return read_checked<int32_t>(); }
+    constexpr int64_t read_s64_checked() { return read_checked<int64_t>(); }
+    constexpr float read_f32_checked() { return read_checked<float>(); }
+    constexpr double read_f64_checked() { return read_checked<double>(); }
+    constexpr uint16_t read_u16_big_endian_checked() { return read_checked<uint16_t, stream_buf::Endian::BIG>(); }
+    constexpr uint32_t read_u32_big_endian_checked() { return read_checked<uint32_t, stream_buf::Endian::BIG>(); }
+    constexpr uint64_t read_u64_big_endian_checked() { return read_checked<uint64_t, stream_buf::Endian::BIG>(); }
+    constexpr int16_t read_s16_big_endian_checked() { return read_checked<int16_t, stream_buf::Endian::BIG>(); }
+    constexpr int32_t read_s32_big_endian_checked() { return read_checked<int32_t, stream_buf::Endian::BIG>(); }
+    constexpr int64_t read_s64_big_endian_checked() { return read_checked<int64_t, stream_buf::Endian::BIG>(); }
+    constexpr float read_f32_big_endian_checked() { return read_checked<float, stream_buf::Endian::BIG>(); }
+    constexpr double read_f64_big_endian_checked() { return read_checked<double, stream_buf::Endian::BIG>(); }
+
+    /*!
+    Read a varint (LEB128) encoded value. Varint reads are always bounds checked.
+    Returns zero, without advancing, if the encoding is truncated or malformed;
+    for the Sticky policy this is recorded as an overflow.
+    */
+    constexpr uint64_t read_varint_u64() {
+        uint64_t value = 0;
+        if constexpr (IS_REFILLING) { refill_if_below(stream_buf::VARINT_U64_SIZE_MAX); }
+        const size_t size = stream_buf::decode_varint(_ptr, bytes_remaining(), value);
+        if (size == 0) {
+            record_overflow();
+            return 0;
+        }
+        advance_unchecked(size);
+        return value;
+    }
+    constexpr uint32_t read_varint_u32() {
+        uint64_t value = 0;
+        if constexpr (IS_REFILLING) { refill_if_below(stream_buf::VARINT_U32_SIZE_MAX); }
+        const size_t size = stream_buf::decode_varint(_ptr, bytes_remaining(), value);
+        if (size == 0 || size > stream_buf::VARINT_U32_SIZE_MAX || value > UINT32_MAX) {
+            record_overflow();
+            return 0;
+        }
+        advance_unchecked(size);
+        return static_cast<uint32_t>(value);
+    }
+    //! Read a ZigZag varint encoded value
+    constexpr int32_t read_varint_s32() { return stream_buf::zigzag_decode(read_varint_u32()); }
+    constexpr int64_t read_varint_s64() { return stream_buf::zigzag_decode(read_varint_u64()); }
+
+    /*!
+    Read a number written as ASCII decimal digits, with a leading '-' if negative, up to the first non-digit, which is not consumed.
+    Returns zero, without advancing, if there are no digits or the value is out of range;
+    for the Sticky policy this is recorded as an overflow.
+    */
+    constexpr uint32_t read_decimal_u32() { return static_cast<uint32_t>(read_digits(false, UINT32_MAX, 0)); }
+    constexpr uint64_t read_decimal_u64() { return read_digits(false, UINT64_MAX, 0); }
+    constexpr int32_t read_decimal_s32() { return static_cast<int32_t>(read_digits(false, INT32_MAX, 1ULL << 31)); }
+    constexpr int64_t read_decimal_s64() { return static_cast<int64_t>(read_digits(false, INT64_MAX, 1ULL << 63)); }
+    //! Read a number written as ASCII hexadecimal digits, of either case, as for read_decimal_u32()
+    constexpr uint32_t read_hex_u32() { return static_cast<uint32_t>(read_digits(true, UINT32_MAX, 0)); }
+    constexpr uint64_t read_hex_u64() { return read_digits(true, UINT64_MAX, 0); }
+
+    void read_data(void *data, size_t len) { read_data(static_cast<uint8_t*>(data), len); }
+    constexpr void read_data(uint8_t* data, size_t len) {
+        if constexpr (IS_REFILLING) {
+            read_refilling(len, 1, [data](const uint8_t* src, size_t offset, size_t chunk) { memcpy(data + offset, src, chunk); }); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        } else if (fits(len)) {
+            if (std::is_constant_evaluated()) {
+                std::copy_n(_ptr, len, data);
+            } else if (len != 0) { // memcpy requires valid pointers even when len is 0, and empty payloads may be nullptr
+                memcpy(data, _ptr, len);
+            }
+            advance_unchecked(len);
+        }
+    }
+    /*!
+    Read an array of count values of type T in byte order E, with a single bounds check.
+    If the byte order matches the target this is a straight copy, otherwise a vectorized byte swap is used.
+    */
+    template <typename T, stream_buf::Endian E = stream_buf::Endian::LITTLE>
+    constexpr void read_array(T* data, size_t count) {
+        if constexpr (IS_REFILLING) {
+            // split at element boundaries
+            read_refilling(count * sizeof(T), sizeof(T), [data](const uint8_t* src, size_t offset, size_t chunk) {
+                stream_buf::copy_array<T, E>(data + offset / sizeof(T), src, chunk / sizeof(T)); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            });
+        } else if (fits(count * sizeof(T))) {
+            stream_buf::load_array<T, E>(data, _ptr, count);
+            advance_unchecked(count * sizeof(T));
+        }
+    }
+    /*!
+    Read 2 * len ASCII hexadecimal digits, of either case, decoding them to len bytes at data, with a single bounds check.
+    Returns false if there are insufficient digits or any is invalid, in which case nothing is consumed, and
+    for the Sticky policy an overflow is recorded. For the Refilling policy the digits are decoded a window at a time,
+    so they are consumed even if invalid.
+    */
+    bool read_hex_decoded(uint8_t* data, size_t len) {
+        return read_text(2 * len, 2, [data](const uint8_t* src, size_t offset, size_t chunk) {
+            return stream_buf::hex_decode(data + offset / 2, src, chunk / 2); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        });
+    }
+    //! Read len bytes encoded as Base64 with padding, that is stream_buf::base64_encoded_size(len) characters, as for read_hex_decoded()
+    bool read_base64(uint8_t* data, size_t len) {
+        return read_text(stream_buf::base64_encoded_size(len), 4, [data, len](const uint8_t* src, size_t offset, size_t chunk) {
+            const size_t start = offset / 4 * 3;
+            return stream_buf::base64_decode(data + start, src, std::min(chunk / 4 * 3, len - start)); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        });
+    }
+//
+// Zero-copy view functions, these return views into the underlying buffer, which must outlive the view
+//
+    //! Return a view of the next len bytes and advance past them, returns an empty view if there are fewer than len bytes remaining
+    constexpr std::span<const uint8_t> read_span(size_t len) {
+        if (!fits(len)) {
+            return {};
+        }
+        const std::span<const uint8_t> ret(_ptr, len);
+        advance_unchecked(len);
         return ret;
     }
-    uint16_t read_u16_big_endian() { return static_cast<uint16_t>(read_u8() << 8) | read_u8(); }
-    uint32_t read_u32_big_endian() {
-        uint32_t ret = static_cast<uint32_t>(read_u8() << 24);
-        ret |= static_cast<uint32_t>(read_u8() << 16);
-        ret |= static_cast<uint32_t>(read_u8() <<  8);
-        ret |= read_u8();
+    std::string_view read_string_view(size_t len) {
+        const std::span<const uint8_t> span = read_span(len);
+        return { reinterpret_cast<const char*>(span.data()), span.size() }; // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    }
+    /*!
+    Return a view of the zero terminated string at the read position, not including the terminator, and advance past the terminator.
+    Returns an empty view, without advancing, if there is no terminator before the end of the buffer.
+    */
+    std::string_view read_cstring_view() {
+        std::string_view ret = peek_cstring_view();
+        if constexpr (IS_REFILLING) {
+            if (ret.data() == nullptr) {
+                refill_if_below(_bounds.capacity);
+                ret = peek_cstring_view();
+            }
+        }
+        if (ret.data() == nullptr) {
+            record_overflow();
+            return ret;
+        }
+        advance_unchecked(ret.size() + 1);
         return ret;
     }
-    /*float read_f32() {
-        const uint32_t value = read_u32();
-        // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
-        return *reinterpret_cast<const float*>(&value); // cppcheck-suppress invalidPointerCast
-        // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
-    }*/
 
-    uint8_t read_u8_checked() { if (_ptr < _end) { return *_ptr++; } return 0; }
-    uint16_t read_u16_checked() {
-        if (_ptr < _end - sizeof(uint16_t)) {
-            return read_u16();
+    //! As read_span(), but does not advance
+    constexpr std::span<const uint8_t> peek_span(size_t len) const {
+        if (_ptr + len < _end) {
+            return { _ptr, len };
         }
-        return 0;
+        return {};
+    }
+    std::string_view peek_string_view(size_t len) const {
+        const std::span<const uint8_t> span = peek_span(len);
+        return { reinterpret_cast<const char*>(span.data()), span.size() }; // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
     }
-    uint32_t read_u32_checked() {
-        if (_ptr < _end - sizeof(uint32_t)) {
-            return read_u32();
+    //! As read_cstring_view(), but does not advance. Returns a view with a null data pointer if there is no terminator.
+    std::string_view peek_cstring_view() const {
+        const void* terminator = memchr(_ptr, 0, bytes_remaining());
+        if (terminator == nullptr) {
+            return {};
         }
-        return 0;
+        return { reinterpret_cast<const char*>(_ptr), static_cast<size_t>(static_cast<const uint8_t*>(terminator) - _ptr) }; // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
     }
-    uint16_t read_u16_big_endian_checked() {
-        if (_ptr < _end - sizeof(uint16_t)) {
-            return read_u16_big_endian();
+    //! Return the value of type T in byte order E at the read position without advancing, returns zero if there is not enough data remaining
+    template <typename T, stream_buf::Endian E = stream_buf::Endian::LITTLE>
+    constexpr T peek() const {
+        if (_ptr + sizeof(T) < _end) {
+            return stream_buf::load<T, E>(_ptr);
         }
-        return 0;
+        return T{};
+    }
+protected:
+    //! advance _ptr without bounds checking, folding the bytes advanced over into the checksum
+    constexpr void advance_unchecked(size_t len) {
+        if constexpr (HAS_CHECKSUM) { _checksum->update(_ptr, len); }
+        _ptr += len;
     }
-    uint32_t read_u32_big_endian_checked() {
-        if (_ptr < _end - sizeof(uint32_t)) {
-            return read_u32_big_endian();
+    /*!
+    Parse ASCII decimal or hexadecimal digits. If negative_max is non-zero a leading '-' is accepted, and the magnitude
+    of a negative value must be at most negative_max, otherwise the magnitude must be at most max.
+    Returns the value as two's complement.
+    */
+    constexpr uint64_t read_digits(bool hex, uint64_t max, uint64_t negative_max) {
+        if constexpr (IS_REFILLING) { refill_if_below(stream_buf::DECIMAL_S64_SIZE_MAX); }
+        const bool negative = negative_max != 0 && bytes_remaining() > 0 && *_ptr == '-';
+        const size_t sign = negative ? 1 : 0;
+        uint64_t magnitude = 0;
+        const size_t digits = hex ? stream_buf::decode_hex(_ptr + sign, bytes_remaining() - sign, magnitude) // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            : stream_buf::decode_decimal(_ptr + sign, bytes_remaining() - sign, magnitude); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        if (digits == 0 || magnitude > (negative ? negative_max : max)) {
+            record_overflow();
+            return 0;
         }
-        return 0;
+        advance_unchecked(sign + digits);
+        return negative ? 0ULL - magnitude : magnitude;
     }
-    /*float read_f32_checked() {
-        if (_ptr < _end - sizeof(float)) {
-            return read_f32();
+    /*!
+    returns true if len bytes are available, if they are not then an overflow is recorded for the Sticky policy.
+    For the Refilling policy the window is refilled to make them available.
+    */
+    constexpr bool fits(size_t len) {
+        if constexpr (IS_COUNTING) {
+            ++_bounds.checks;
         }
-        return 0.0F;
-    }*/
-
-    void read_data(void *data, size_t len) { if (_ptr + len < _end) { memcpy(data, _ptr, len); _ptr += len; } }
+        if (_ptr + len < _end) {
+            return true;
+        }
+        if constexpr (IS_REFILLING) {
+            return refill(len);
+        }
+        record_overflow();
+        return false;
+    }
+    /*!
+    For the Refilling policy, move the unread bytes to the start of the window and read from the source
+    until at least len bytes are available or the source is exhausted. Returns true if len bytes are available.
+    */
+    bool refill(size_t len) {
+        if constexpr (IS_REFILLING) {
+            if (len > _bounds.capacity) {
+                return false;
+            }
+            size_t available = bytes_remaining();
+            _bounds.discarded += static_cast<size_t>(_ptr - _begin);
+            memmove(_bounds.window, _ptr, available);
+            while (available < len) {
+                const size_t count = _bounds.source->read(_bounds.window + available, _bounds.capacity - available); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+                if (count == 0) {
+                    break;
+                }
+                available += count;
+            }
+            _ptr = _begin;
+            _end = _begin + available + 1;
+            return available >= len;
+        }
+        (void)len;
+        return false;
+    }
+    //! refill if fewer than len bytes are available, for reads whose length is not known up front
+    void refill_if_below(size_t len) {
+        if (bytes_remaining() < len) {
+            refill(len);
+        }
+    }
+    /*!
+    For the Refilling policy, read len bytes in chunks of a multiple of granularity bytes, refilling whenever the window is exhausted.
+    read_chunk(src, offset, chunk) reads the chunk bytes at src, which are at offset in the data being read.
+    Stops early if the source is exhausted.
+    */
+    template <typename F>
+    constexpr void read_refilling(size_t len, size_t granularity, F read_chunk) {
+        for (size_t offset = 0; offset < len;) {
+            const size_t chunk = std::min(len - offset, bytes_remaining()) / granularity * granularity;
+            if (chunk == 0) {
+                if (!refill(granularity)) {
+                    return;
+                }
+                continue;
+            }
+            read_chunk(_ptr, offset, chunk);
+            advance_unchecked(chunk);
+            offset += chunk;
+        }
+    }
+    /*!
+    Decode size characters of text with decode(src, offset, chunk), which returns false if the text is invalid,
+    advancing past the text only if it is valid. For the Refilling policy the text is decoded and consumed in chunks
+    of a multiple of granularity characters, so it is consumed even if invalid.
+    */
+    template <typename F>
+    bool read_text(size_t size, size_t granularity, F decode) {
+        if constexpr (IS_REFILLING) {
+            size_t consumed = 0;
+            bool valid = true;
+            read_refilling(size, granularity, [&decode, &consumed, &valid](const uint8_t* src, size_t offset, size_t chunk) {
+                valid = valid && decode(src, offset, chunk);
+                consumed += chunk;
+            });
+            return valid && consumed == size;
+        } else {
+            if (!fits(size)) {
+                return false;
+            }
+            if (!decode(_ptr, 0, size)) {
+                record_overflow();
+                return false;
+            }
+            advance_unchecked(size);
+            return true;
+        }
+    }
+    //! for the Sticky policy, record the first overflow
+    constexpr void record_overflow() {
+        if constexpr (IS_STICKY) {
+            if (_bounds.end_offset == 0) {
+                _bounds.end_offset = static_cast<size_t>(_end - _begin);
+                _end = _ptr + 1; // treat the buffer as exhausted, so all subsequent reads fail
+            }
+        }
+    }
 protected:
     const uint8_t* _ptr; // data pointer must be first
     const uint8_t* const _begin;
     const uint8_t* _end;
+    [[no_unique_address]] std::conditional_t<HAS_CHECKSUM, Checksum*, stream_buf::NoChecksum> _checksum {};
+    [[no_unique_address]] BoundsPolicy _bounds {};
 };
+
+namespace stream_buf {
+/*!
+Decode a frame at compile time, eg to validate an encoder with a static_assert.
+Returns parse(reader), where reader is a StreamBufReader over the frame.
+As for make_frame(), the frame is copied into a buffer with a byte beyond the end.
+*/
+template <size_t N, typename F>
+constexpr auto read_frame(const std::array<uint8_t, N>& frame, F parse) {
+    std::array<uint8_t, N + 1> buf {};
+    std::copy_n(frame.begin(), N, buf.begin());
+    StreamBufReader sbr(&buf[0], N);
+    return parse(sbr);
+}
+} // namespace stream_buf
@@ -0,0 +1,181 @@
+#pragma once
+
+#include "stream_buf_reader.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+
+/*!
+Lock-free single producer, single consumer ring buffer, for handing data from an ISR to a task without a critical section.
+
+The producer and consumer may each run in a different thread or interrupt context, but there must be only one of each.
+The indices are std::atomic and each is written by only one side, so no locks or read-modify-write operations are required.
+
+Data may be written and read as a byte stream that wraps around the end of the buffer, using write_data()/read_data()
+and the typed write and read functions. Alternatively the producer may reserve() a contiguous region and write a whole message
+in place, and the consumer may read_contiguous() to decode in place without copying.
+A reservation that does not fit before the end of the buffer is placed at the start, and the bytes skipped at the end
+are marked so that the consumer does not see them (this is sometimes called a bip buffer).
+
+The buffer is not owned by the ring and must outlive it.
+*/
+class StreamBufRing {
+public:
+    StreamBufRing(uint8_t* buf, size_t len) : _buf(buf), _capacity(len), _last(len) {}
+    StreamBufRing(const StreamBufRing&) = delete;
+    StreamBufRing& operator=(const StreamBufRing&) = delete;
+    StreamBufRing(StreamBufRing&&) = delete;
+    StreamBufRing& operator=(StreamBufRing&&) = delete;
+public:
+    size_t capacity() const { return _capacity; }
+//
+// Producer functions
+//
+    /*!
+    Reserve len contiguous bytes for a message. Returns a writer over the region, the unchecked write functions may be used on it.
+    If there is insufficient contiguous space the returned writer has zero capacity, that is bytes_remaining() == 0.
+    The message is not visible to the consumer until commit() is called, only one reservation may be outstanding.
+    */
+    StreamBufWriter reserve(size_t len) {
+        const size_t write = _write.load(std::memory_order_relaxed);
+        const size_t read = _read.load(std::memory_order_acquire);
+        // the write index must never catch up with the read index, since that would make the ring appear empty
+        if (write < read) {
+            _reserved = (write + len < read) ? write : NOT_RESERVED;
+        } else if (write + len <= _capacity) {
+            _reserved = write;
+        } else {
+            _reserved = (len < read) ? 0 : NOT_RESERVED; // wrap to the start of the buffer
+        }
+        if (_reserved == NOT_RESERVED) {
+            return { _buf, size_t{0} };
+        }
+        return { _buf + _reserved, len }; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+    //! Publish the bytes written to a writer obtained from reserve()
+    void commit(const StreamBufWriter& reservation) {
+        if (_reserved == NOT_RESERVED) {
+            return;
+        }
+        const size_t write = _write.load(std::memory_order_relaxed);
+        const size_t new_write = _reserved + reservation.bytes_written();
+        if (_reserved < write && write != _capacity) {
+            // wrapped, so mark where the data ends, the consumer skips the bytes after it
+            _last.store(write, std::memory_order_release);
+        } else if (new_write > _last.load(std::memory_order_relaxed)) {
+            // passed the previous end mark, so the whole buffer is again available
+            _last.store(_capacity, std::memory_order_release);
+        }
+        _reserved = NOT_RESERVED;
+        _write.store(new_write, std::memory_order_release);
+    }
+    //! Write len bytes, wrapping around the end of the buffer if required. Returns false, writing nothing, if there is insufficient space.
+    bool write_data(const void* data, size_t len) {
+        const size_t write = _write.load(std::memory_order_relaxed);
+        const size_t read = _read.load(std::memory_order_acquire);
+        const size_t contiguous = (write < read) ? read - write - 1 : _capacity - write;
+        const size_t wrapped = (write < read || read == 0) ? 0 : read - 1;
+        if (len > contiguous + wrapped) {
+            return false;
+        }
+        const auto* src = static_cast<const uint8_t*>(data);
+        const size_t first = std::min(len, contiguous);
+        StreamBufWriter region = reserve(first);
+        region.write_data(src, first);
+        commit(region);
+        if (first < len) {
+            // the first part filled the buffer up to its end, so this reservation is at the start
+            StreamBufWriter wrapped_region = reserve(len - first);
+            wrapped_region.write_data(src + first, len - first); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            commit(wrapped_region);
+        }
+        return true;
+    }
+    //! Write a value of type T in byte order E, returns false if there is insufficient space
+    template <typename T, stream_buf::Endian E = stream_buf::Endian::LITTLE>
+    bool write(T value) {
+        std::array<uint8_t, sizeof(T)> bytes {};
+        stream_buf::store<T, E>(&bytes[0], value);
+        return write_data(&bytes[0], sizeof(T));
+    }
+    bool write_u8(uint8_t value) { return write<uint8_t>(value); }
+    bool write_u16(uint16_t value) { return write<uint16_t>(value); }
+    bool write_u32(uint32_t value) { return write<uint32_t>(value); }
+    bool write_u64(uint64_t value) { return write<uint64_t>(value); }
+    bool write_f32(float value) { return write<float>(value); }
+//
+// Consumer functions
+//
+    /*!
+    Returns a reader over the contiguous bytes that are available to read, which may be fewer than bytes_available()
+    if the data wraps around the end of the buffer. The bytes are decoded in place and are not released until release() is called.
+    */
+    StreamBufReader read_contiguous() {
+        const size_t read = resolve_read();
+        const size_t write = _write.load(std::memory_order_acquire);
+        const size_t end = (write < read) ? _last.load(std::memory_order_acquire) : write;
+        return { _buf + read, end - read }; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+    //! Release the bytes read from a reader obtained from read_contiguous(), so the space may be reused by the producer
+    void release(const StreamBufReader& region) {
+        _read.store(_read.load(std::memory_order_relaxed) + region.bytes_read(), std::memory_order_release);
+    }
+    //! Returns the number of bytes available to read, including any that wrap around the end of the buffer
+    size_t bytes_available() {
+        const size_t read = resolve_read();
+        const size_t write = _write.load(std::memory_order_acquire);
+        if (write < read) {
+            return _last.load(std::memory_order_acquire) - read + write;
+        }
+        return write - read;
+    }
+    //! Read len bytes, wrapping around the end of the buffer if required. Returns false, reading nothing, if fewer than len bytes are available.
+    bool read_data(void* data, size_t len) {
+        if (len > bytes_available()) {
+            return false;
+        }
+        auto* dst = static_cast<uint8_t*>(data);
+        StreamBufReader region = read_contiguous();
+        const size_t first = std::min(len, region.bytes_remaining());
+        region.read_data(dst, first);
+        release(region);
+        if (first < len) {
+            StreamBufReader wrapped_region = read_contiguous();
+            wrapped_region.read_data(dst + first, len - first); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            release(wrapped_region);
+        }
+        return true;
+    }
+    //! Read a value of type T in byte order E, returns zero if fewer than sizeof(T) bytes are available
+    template <typename T, stream_buf::Endian E = stream_buf::Endian::LITTLE>
+    T read() {
+        std::array<uint8_t, sizeof(T)> bytes {};
+        if (!read_data(&bytes[0], sizeof(T))) {
+            return T{};
+        }
+        return stream_buf::load<T, E>(&bytes[0]);
+    }
+    uint8_t read_u8() { return read<uint8_t>(); }
+    uint16_t read_u16() { return read<uint16_t>(); }
+    uint32_t read_u32() { return read<uint32_t>(); }
+    uint64_t read_u64() { return read<uint64_t>(); }
+    float read_f32() { return read<float>(); }
+private:
+    //! if the consumer has reached the end mark and the producer has wrapped, move the read index to the start of the buffer
+    size_t resolve_read() {
+        size_t read = _read.load(std::memory_order_relaxed);
+        if (read == _last.load(std::memory_order_acquire) && _write.load(std::memory_order_acquire) < read) {
+            read = 0;
+            _read.store(0, std::memory_order_release);
+        }
+        return read;
+    }
+private:
+    static constexpr size_t NOT_RESERVED = SIZE_MAX;
+    uint8_t* _buf;
+    size_t _capacity;
+    std::atomic<size_t> _write {0}; //!< written by the producer
+    std::atomic<size_t> _read {0}; //!< written by the consumer
+    std::atomic<size_t> _last; //!< end of the data before the producer wrapped, written by the producer
+    size_t _reserved {NOT_RESERVED}; //!< start of the outstanding reservation, producer only
+};
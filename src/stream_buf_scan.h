@@ -0,0 +1,111 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/*!
+Byte scanning kernels, used to find frame delimiters and escape bytes.
+
+On x86 the scan uses AVX2 (32 bytes per iteration) if available, otherwise SSE2 (16 bytes per iteration).
+On other targets find_byte() uses memchr, and find_either() tests 8 bytes at a time in a 64-bit word.
+*/
+namespace stream_buf {
+
+/*!
+Return the index of the first byte equal to value in the len bytes at data, or len if there is none.
+*/
+inline size_t find_byte(const uint8_t* data, size_t len, uint8_t value) {
+    // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic,cppcoreguidelines-pro-type-reinterpret-cast)
+#if defined(__SSE2__)
+    size_t pos = 0;
+#if defined(__AVX2__)
+    const __m256i match_256 = _mm256_set1_epi8(static_cast<char>(value));
+    for (; pos + 32 <= len; pos += 32) {
+        const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        const auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, match_256)));
+        if (mask != 0) {
+            return pos + static_cast<size_t>(std::countr_zero(mask));
+        }
+    }
+#endif
+    const __m128i match = _mm_set1_epi8(static_cast<char>(value));
+    for (; pos + 16 <= len; pos += 16) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        const auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, match)));
+        if (mask != 0) {
+            return pos + static_cast<size_t>(std::countr_zero(mask));
+        }
+    }
+    for (; pos < len; ++pos) {
+        if (data[pos] == value) {
+            return pos;
+        }
+    }
+    return len;
+#else
+    const auto* found = static_cast<const uint8_t*>(memchr(data, value, len));
+    return (found == nullptr) ? len : static_cast<size_t>(found - data);
+#endif
+    // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic,cppcoreguidelines-pro-type-reinterpret-cast)
+}
+
+/*!
+Return the index of the first byte equal to either a or b in the len bytes at data, or len if there is none.
+*/
+inline size_t find_either(const uint8_t* data, size_t len, uint8_t a, uint8_t b) {
+    // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic,cppcoreguidelines-pro-type-reinterpret-cast)
+    size_t pos = 0;
+#if defined(__AVX2__)
+    const __m256i match_a_256 = _mm256_set1_epi8(static_cast<char>(a));
+    const __m256i match_b_256 = _mm256_set1_epi8(static_cast<char>(b));
+    for (; pos + 32 <= len; pos += 32) {
+        const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        const __m256i matches = _mm256_or_si256(_mm256_cmpeq_epi8(bytes, match_a_256), _mm256_cmpeq_epi8(bytes, match_b_256));
+        const auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(matches));
+        if (mask != 0) {
+            return pos + static_cast<size_t>(std::countr_zero(mask));
+        }
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i match_a = _mm_set1_epi8(static_cast<char>(a));
+    const __m128i match_b = _mm_set1_epi8(static_cast<char>(b));
+    for (; pos + 16 <= len; pos += 16) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        const __m128i matches = _mm_or_si128(_mm_cmpeq_epi8(bytes, match_a), _mm_cmpeq_epi8(bytes, match_b));
+        const auto mask = static_cast<uint32_t>(_mm_movemask_epi8(matches));
+        if (mask != 0) {
+            return pos + static_cast<size_t>(std::countr_zero(mask));
+        }
+    }
+#else
+    // a byte of (word ^ pattern) is zero where the word matches, and has_zero() sets the top bit of the first such byte
+    constexpr uint64_t ONES = 0x0101010101010101ULL;
+    constexpr uint64_t HIGHS = 0x8080808080808080ULL;
+    const auto has_zero = [](uint64_t word) { return (word - ONES) & ~word & HIGHS; };
+    const uint64_t pattern_a = ONES * a;
+    const uint64_t pattern_b = ONES * b;
+    for (; pos + 8 <= len; pos += 8) {
+        uint64_t word; // NOLINT(cppcoreguidelines-init-variables)
+        memcpy(&word, data + pos, sizeof(word));
+        if (has_zero(word ^ pattern_a) | has_zero(word ^ pattern_b)) {
+            break; // the scalar loop finds the position of the match
+        }
+    }
+#endif
+    for (; pos < len; ++pos) {
+        if (data[pos] == a || data[pos] == b) {
+            return pos;
+        }
+    }
+    return len;
+    // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic,cppcoreguidelines-pro-type-reinterpret-cast)
+}
+
+} // namespace stream_buf
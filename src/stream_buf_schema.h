@@ -0,0 +1,120 @@
+#pragma once
+
+#include "stream_buf_reader.h"
+#include "stream_buf_writer.h"
+#include <tuple>
+#include <type_traits>
+
+/*!
+Declarative description of the wire layout of a struct, from which fused encode and decode functions are generated.
+
+A schema is a list of fields, each of which names a data member and optionally its wire type and byte order.
+For example:
+
+    struct Attitude { uint32_t time_ms; float roll; float pitch; int32_t heading; };
+    using AttitudeSchema = stream_buf::Schema<
+        stream_buf::Field<&Attitude::time_ms>,
+        stream_buf::Field<&Attitude::roll>,
+        stream_buf::Field<&Attitude::pitch>,
+        stream_buf::Field<&Attitude::heading, int16_t, stream_buf::Endian::BIG>>;
+
+    std::array<uint8_t, AttitudeSchema::WIRE_SIZE> buf;
+    StreamBufWriter sbw(&buf[0], buf.size());
+    AttitudeSchema::encode(sbw, attitude);
+
+Encoding and decoding perform a single bounds check for the whole struct, and then write or read each field using
+the unchecked functions, as a hand-written reserve() or require() sequence does.
+With optimization enabled the calls are inlined and the cost is comparable to the hand-written sequence; at -Og
+they may not be. test_benchmark_schema compares the two.
+*/
+namespace stream_buf {
+
+template <typename M>
+struct member_pointer_traits;
+
+template <typename S, typename T>
+struct member_pointer_traits<T S::*> {
+    using struct_type = S;
+    using member_type = T;
+};
+
+/*!
+Field of a schema: the data member Member, written as type Wire in byte order E.
+Wire defaults to the type of the member, otherwise the member is converted using static_cast.
+*/
+template <auto Member, typename Wire = typename member_pointer_traits<decltype(Member)>::member_type, Endian E = Endian::LITTLE>
+struct Field {
+    using struct_type = typename member_pointer_traits<decltype(Member)>::struct_type;
+    using member_type = typename member_pointer_traits<decltype(Member)>::member_type;
+    using wire_type = Wire;
+    static_assert(std::is_arithmetic_v<Wire> || std::is_enum_v<Wire>, "wire type must be an integral, floating point or enum type");
+    static constexpr size_t WIRE_SIZE = sizeof(Wire);
+
+    template <typename Writer>
+    static void encode_unchecked(Writer& writer, const struct_type& value) { writer.template write_unchecked<Wire, E>(static_cast<Wire>(value.*Member)); }
+    template <typename Reader>
+    static void decode_unchecked(Reader& reader, struct_type& value) { value.*Member = static_cast<member_type>(reader.template read_unchecked<Wire, E>()); }
+};
+
+//! Field written big endian, with the type of the member as its wire type
+template <auto Member>
+using FieldBigEndian = Field<Member, typename member_pointer_traits<decltype(Member)>::member_type, Endian::BIG>;
+
+/*!
+Wire layout of a struct, as the list of its fields in wire order.
+All the fields must be members of the same struct, but need not be all of its members nor in declaration order.
+*/
+template <typename... Fields>
+struct Schema {
+    static_assert(sizeof...(Fields) > 0, "schema must have at least one field");
+    using struct_type = typename std::tuple_element_t<0, std::tuple<Fields...>>::struct_type;
+    static_assert((std::is_same_v<typename Fields::struct_type, struct_type> && ...), "fields must be members of the same struct");
+
+    //! number of bytes of the encoded struct, so buffers may be sized at compile time
+    static constexpr size_t WIRE_SIZE = (Fields::WIRE_SIZE + ...);
+
+    /*!
+    Encode value, with a single bounds check.
+    Returns false, writing nothing, if there is insufficient space.
+    */
+    template <typename Writer>
+    static bool encode(Writer& writer, const struct_type& value) {
+        StreamBufWriter message = writer.reserve(WIRE_SIZE);
+        if (message.bytes_remaining() < WIRE_SIZE) {
+            return false;
+        }
+        (Fields::encode_unchecked(message, value), ...);
+        writer.commit(message);
+        return true;
+    }
+    /*!
+    Decode into value, with a single bounds check.
+    Returns false, leaving value unchanged, if there is insufficient data.
+    */
+    template <typename Reader>
+    static bool decode(Reader& reader, struct_type& value) {
+        if (!reader.require(WIRE_SIZE)) {
+            return false;
+        }
+        // decode into a local, whose stores cannot alias the reader's pointer, so the pointer is kept in a register
+        struct_type decoded = value;
+        (Fields::decode_unchecked(reader, decoded), ...);
+        value = decoded;
+        return true;
+    }
+    //! Encode value into buf, which must be at least WIRE_SIZE bytes, returns WIRE_SIZE
+    static size_t encode_unchecked(uint8_t* buf, const struct_type& value) {
+        StreamBufWriter message(buf, WIRE_SIZE);
+        (Fields::encode_unchecked(message, value), ...);
+        return WIRE_SIZE;
+    }
+    //! Decode from buf, which must be at least WIRE_SIZE bytes
+    static struct_type decode_unchecked(const uint8_t* buf) {
+        StreamBufReader message(buf, WIRE_SIZE);
+        struct_type value {};
+        (Fields::decode_unchecked(message, value), ...);
+        return value;
+    }
+};
+
+} // namespace stream_buf
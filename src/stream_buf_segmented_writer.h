@@ -0,0 +1,150 @@
+#pragma once
+
+#include "stream_buf_writer.h"
+#include <algorithm>
+#include <span>
+
+#if __has_include(<sys/uio.h>)
+#include <array>
+#include <cerrno>
+#include <sys/uio.h>
+#endif
+
+namespace stream_buf {
+//! Contiguous region of memory, one element of a scatter-gather list
+struct Segment {
+    const uint8_t* data;
+    size_t len;
+};
+} // namespace stream_buf
+
+template <typename BoundsPolicy, typename Checksum = stream_buf::NoChecksum>
+class StreamBufSegmentedWriterT;
+
+//! Segmented writer without bounds checking on the plain write functions, this is the default
+using StreamBufSegmentedWriter = StreamBufSegmentedWriterT<stream_buf::Unchecked>;
+using StreamBufSegmentedWriterChecked = StreamBufSegmentedWriterT<stream_buf::Checked>;
+
+/*!
+Scatter-gather writer, for framing large payloads without copying them.
+
+Headers and trailers are written to a small scratch buffer using the normal write functions, and large payloads are
+added by reference using write_borrowed(), which does not copy them. The output is a list of segments, alternating
+between chunks of the scratch buffer and borrowed payloads, which may be emitted using writev() or iterated over,
+eg to build a DMA descriptor chain.
+
+If a checksum is attached, borrowed payloads are folded into it, so a trailing checksum covers the whole frame.
+Note that bytes_written(), and so length_prefix(), count only the bytes in the scratch buffer, use total_size() for the frame size.
+
+Borrowed payloads are not owned by the writer and must remain valid until the segments have been emitted.
+Neither the scratch buffer nor the segment table are owned by the writer and both must outlive it.
+*/
+template <typename BoundsPolicy, typename Checksum>
+class StreamBufSegmentedWriterT : public StreamBufWriterT<BoundsPolicy, Checksum> {
+public:
+    StreamBufSegmentedWriterT(uint8_t* buf, size_t len, stream_buf::Segment* segments, size_t segment_count)
+        : StreamBufWriterT<BoundsPolicy, Checksum>(buf, len), _segments(segments), _segment_capacity(segment_count), _chunk_begin(buf) {}
+    StreamBufSegmentedWriterT(uint8_t* buf, size_t len, stream_buf::Segment* segments, size_t segment_count, Checksum& checksum)
+        : StreamBufWriterT<BoundsPolicy, Checksum>(buf, len, checksum), _segments(segments), _segment_capacity(segment_count), _chunk_begin(buf) {}
+public:
+    void reset() {
+        StreamBufWriterT<BoundsPolicy, Checksum>::reset();
+        _segment_count = 0;
+        _borrowed_size = 0;
+        _chunk_begin = this->_ptr;
+    }
+    /*!
+    Add len bytes at data to the output by reference, without copying them.
+    If the segment table is full the bytes are copied into the scratch buffer instead, as by write_data().
+    */
+    void write_borrowed(const void* data, size_t len) {
+        // leave room for the pending chunk, this segment, and a final chunk
+        const size_t pending = (this->_ptr != _chunk_begin) ? 1 : 0;
+        if (_segment_count + pending + 2 > _segment_capacity) {
+            this->write_data(data, len);
+            return;
+        }
+        close_chunk();
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        if constexpr (StreamBufWriterT<BoundsPolicy, Checksum>::HAS_CHECKSUM) { this->_checksum->update(bytes, len); }
+        _segments[_segment_count++] = { bytes, len }; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        _borrowed_size += len;
+    }
+    //! Returns the segments making up the output, in order
+    std::span<const stream_buf::Segment> segments() {
+        close_chunk();
+        return { _segments, _segment_count };
+    }
+    //! total number of bytes in the output, owned and borrowed
+    size_t total_size() const { return this->bytes_written() + _borrowed_size; }
+
+#if __has_include(<sys/uio.h>)
+    /*!
+    Write all the segments to the POSIX file descriptor fd, using writev() to avoid copying the borrowed payloads.
+    Partial and interrupted writes are retried. Returns false if a write fails.
+    */
+    bool writev(int fd) {
+        static constexpr size_t IOV_BATCH = 16;
+        std::array<iovec, IOV_BATCH> iov {};
+        const std::span<const stream_buf::Segment> list = segments();
+        size_t index = 0;
+        size_t offset = 0; // offset within list[index] of the first byte not yet written
+        while (index < list.size()) {
+            size_t count = 0;
+            for (; count < IOV_BATCH && index + count < list.size(); ++count) {
+                const stream_buf::Segment& segment = list[index + count];
+                const size_t skip = (count == 0) ? offset : 0;
+                iov[count] = { const_cast<uint8_t*>(segment.data + skip), segment.len - skip }; // NOLINT(cppcoreguidelines-pro-type-const-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            }
+            const ssize_t written = ::writev(fd, &iov[0], static_cast<int>(count));
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            if (written == 0 && std::any_of(&iov[0], &iov[count], [](const iovec& vec) { return vec.iov_len != 0; })) { // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+                return false; // no progress, retrying would loop forever
+            }
+            // advance past the bytes written, which may end part way through a segment
+            auto remaining = static_cast<size_t>(written);
+            while (index < list.size() && remaining >= list[index].len - offset) {
+                remaining -= list[index].len - offset;
+                offset = 0;
+                ++index;
+            }
+            offset += remaining;
+        }
+        return true;
+    }
+#endif
+private:
+    /*!
+    add the bytes written to the scratch buffer since the last segment as a segment, or extend the last segment if they follow on from it.
+    Since write_borrowed() leaves room for a final chunk, the table is only too small if it cannot hold a single segment,
+    in which case an overflow is recorded.
+    */
+    void close_chunk() {
+        if (this->_ptr == _chunk_begin) {
+            return;
+        }
+        // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        const auto len = static_cast<size_t>(this->_ptr - _chunk_begin);
+        if (_segment_count > 0 && _segments[_segment_count - 1].data + _segments[_segment_count - 1].len == _chunk_begin) {
+            _segments[_segment_count - 1].len += len;
+        } else if (_segment_count < _segment_capacity) {
+            _segments[_segment_count++] = { _chunk_begin, len };
+        } else {
+            this->record_overflow();
+            return;
+        }
+        // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        _chunk_begin = this->_ptr;
+    }
+private:
+    stream_buf::Segment* _segments;
+    size_t _segment_capacity;
+    size_t _segment_count {0};
+    size_t _borrowed_size {0};
+    uint8_t* _chunk_begin; //!< start of the scratch bytes not yet in a segment
+};
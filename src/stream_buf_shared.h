@@ -0,0 +1,102 @@
+#pragma once
+
+#include "stream_buf_reader.h"
+#include <algorithm>
+#include <atomic>
+
+/*!
+Buffer shared by multiple producer threads, each of which reserves a slice of the buffer with a single atomic fetch_add
+and then writes its record into the slice with an ordinary StreamBufWriter, so producers never wait for each other.
+
+Each slice is preceded by a header holding its publication state. A record becomes visible to the consumer only when
+the producer calls commit(), and the consumer sees records in reservation order, stopping at the first record that is
+reserved but not yet committed. So the consumer only ever sees fully written records.
+
+Slices are rounded up to a multiple of ALIGNMENT bytes, so that the headers may be accessed atomically, so the buffer
+must be aligned to ALIGNMENT bytes. The buffer is not owned by StreamBufShared and must outlive it.
+
+When the buffer is full, reservations fail. Once the consumer has read all the records and the producers are quiescent,
+reset() makes the whole buffer available again.
+*/
+class StreamBufShared {
+public:
+    static constexpr size_t ALIGNMENT = 4;
+    static constexpr size_t HEADER_SIZE = 8; // publication state, then slice size
+public:
+    StreamBufShared(uint8_t* buf, size_t len) : _buf(buf), _capacity(len) { memset(_buf, 0, _capacity); }
+    StreamBufShared(const StreamBufShared&) = delete;
+    StreamBufShared& operator=(const StreamBufShared&) = delete;
+    StreamBufShared(StreamBufShared&&) = delete;
+    StreamBufShared& operator=(StreamBufShared&&) = delete;
+public:
+    size_t capacity() const { return _capacity; }
+    //! number of bytes reserved, including headers and alignment, this may exceed the capacity once the buffer is full
+    size_t bytes_reserved() const { return _reserved.load(std::memory_order_relaxed); }
+//
+// Producer functions, these may be called concurrently from any number of threads
+//
+    /*!
+    Reserve a slice for a record of up to len bytes. Returns a writer over the slice, the unchecked write functions may be used on it.
+    If the buffer is full the returned writer has zero capacity, that is bytes_remaining() == 0.
+    */
+    StreamBufWriter reserve(size_t len) {
+        const size_t size = (len + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+        const size_t offset = _reserved.fetch_add(HEADER_SIZE + size, std::memory_order_acquire); // acquire pairs with reset()
+        if (offset + HEADER_SIZE + size > _capacity) {
+            return { _buf, size_t{0} };
+        }
+        uint8_t* header = _buf + offset; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        stream_buf::store<uint32_t, stream_buf::Endian::LITTLE>(header + sizeof(uint32_t), static_cast<uint32_t>(size)); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        return { header + HEADER_SIZE, len }; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+    //! Publish the record written to a writer obtained from reserve(), committing a failed reservation has no effect
+    void commit(const StreamBufWriter& slice) {
+        if (slice.begin() == _buf) {
+            return; // failed reservation, a successful reservation never starts at the beginning of the buffer, since it is preceded by its header
+        }
+        // state is zero while the record is pending, and the record length plus one once it is published
+        state(slice.begin() - HEADER_SIZE).store(static_cast<uint32_t>(slice.bytes_written() + 1), std::memory_order_release); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+//
+// Consumer functions, these must be called from only one thread
+//
+    /*!
+    Call fn(StreamBufReader& record) for each newly published record, in reservation order,
+    stopping at the first record that has not yet been committed. Returns the number of records consumed.
+    */
+    template <typename F>
+    size_t for_each_published(F&& fn) {
+        size_t count = 0;
+        const size_t end = std::min(_reserved.load(std::memory_order_relaxed), _capacity);
+        while (_read + HEADER_SIZE <= end) {
+            const uint8_t* header = _buf + _read; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            const uint32_t published = state(header).load(std::memory_order_acquire);
+            if (published == 0) {
+                break;
+            }
+            StreamBufReader record(header + HEADER_SIZE, published - 1); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            fn(record);
+            _read += HEADER_SIZE + stream_buf::load<uint32_t, stream_buf::Endian::LITTLE>(header + sizeof(uint32_t)); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            ++count;
+        }
+        return count;
+    }
+    /*!
+    Make the whole buffer available again. This must only be called when no producer is between reserve() and commit(),
+    any records that have not been consumed are discarded.
+    */
+    void reset() {
+        memset(_buf, 0, std::min(_reserved.load(std::memory_order_relaxed), _capacity));
+        _read = 0;
+        _reserved.store(0, std::memory_order_release);
+    }
+private:
+    static std::atomic_ref<uint32_t> state(const uint8_t* header) {
+        return std::atomic_ref<uint32_t>(*reinterpret_cast<uint32_t*>(const_cast<uint8_t*>(header))); // NOLINT(cppcoreguidelines-pro-type-const-cast,cppcoreguidelines-pro-type-reinterpret-cast)
+    }
+private:
+    uint8_t* _buf;
+    size_t _capacity;
+    std::atomic<size_t> _reserved {0};
+    size_t _read {0}; //!< consumer only
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if __has_include(<unistd.h>)
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+/*!
+Sinks for a StreamBufWriterT with the stream_buf::Flushing bounds policy.
+When the writer's buffer is full, the bytes written so far are handed to the sink and the buffer is reused.
+
+Each sink has the same interface:
+    bool write(const uint8_t* data, size_t len);
+which returns false if the data could not be accepted, in which case the writer keeps the data in its buffer.
+Any class with this interface may be used as a sink, eg one that starts a UART DMA transfer.
+*/
+namespace stream_buf {
+
+//! Sink that appends to a caller supplied buffer, primarily for testing
+class MemorySink {
+public:
+    MemorySink(uint8_t* data, size_t capacity) : _data(data), _capacity(capacity) {}
+    bool write(const uint8_t* data, size_t len) {
+        if (len > _capacity - _size) {
+            return false;
+        }
+        memcpy(_data + _size, data, len); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        _size += len;
+        return true;
+    }
+    const uint8_t* data() const { return _data; }
+    size_t size() const { return _size; }
+    void reset() { _size = 0; }
+private:
+    uint8_t* _data;
+    size_t _capacity;
+    size_t _size {0};
+};
+
+//! Sink that calls a plain function, with a context pointer, for each flush
+class CallbackSink {
+public:
+    using callback_t = bool (*)(void* context, const uint8_t* data, size_t len);
+public:
+    CallbackSink(callback_t callback, void* context) : _callback(callback), _context(context) {}
+    bool write(const uint8_t* data, size_t len) { return _callback(_context, data, len); }
+private:
+    callback_t _callback;
+    void* _context;
+};
+
+#if __has_include(<unistd.h>)
+//! Sink that writes to a POSIX file descriptor, retrying partial and interrupted writes. The descriptor is not owned by the sink.
+class FdSink {
+public:
+    explicit FdSink(int fd) : _fd(fd) {}
+    bool write(const uint8_t* data, size_t len) {
+        while (len > 0) {
+            const ssize_t written = ::write(_fd, data, len);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            if (written == 0) {
+                return false; // no progress, retrying would loop forever
+            }
+            data += written; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            len -= static_cast<size_t>(written);
+        }
+        return true;
+    }
+private:
+    int _fd;
+};
+#endif
+
+} // namespace stream_buf
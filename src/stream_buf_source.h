@@ -0,0 +1,85 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#if __has_include(<unistd.h>)
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+/*!
+Sources for a StreamBufReaderT with the stream_buf::Refilling bounds policy.
+When a read would run off the end of the reader's window, the window is refilled from the source.
+
+Each source has the same interface:
+    size_t read(uint8_t* data, size_t len);
+which reads up to len bytes into data and returns the number of bytes read, or zero at the end of the stream or on error.
+A source may return fewer than len bytes, eg if it is a serial port, the reader calls it again if it needs more.
+*/
+namespace stream_buf {
+
+//! Source that reads from a caller supplied buffer, primarily for testing. chunk_max limits the bytes returned by each read.
+class MemorySource {
+public:
+    MemorySource(const uint8_t* data, size_t len, size_t chunk_max = SIZE_MAX) : _data(data), _len(len), _chunk_max(chunk_max) {}
+    size_t read(uint8_t* data, size_t len) {
+        const size_t count = std::min({ len, _len - _offset, _chunk_max });
+        memcpy(data, _data + _offset, count); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        _offset += count;
+        return count;
+    }
+    void reset() { _offset = 0; }
+private:
+    const uint8_t* _data;
+    size_t _len;
+    size_t _chunk_max;
+    size_t _offset {0};
+};
+
+//! Source that calls a plain function, with a context pointer, for each refill
+class CallbackSource {
+public:
+    using callback_t = size_t (*)(void* context, uint8_t* data, size_t len);
+public:
+    CallbackSource(callback_t callback, void* context) : _callback(callback), _context(context) {}
+    size_t read(uint8_t* data, size_t len) { return _callback(_context, data, len); }
+private:
+    callback_t _callback;
+    void* _context;
+};
+
+//! Source that reads from a C stdio FILE, the FILE is not owned by the source
+class FileSource {
+public:
+    explicit FileSource(FILE* file) : _file(file) {}
+    size_t read(uint8_t* data, size_t len) { return fread(data, 1, len, _file); }
+private:
+    FILE* _file;
+};
+
+#if __has_include(<unistd.h>)
+//! Source that reads from a POSIX file descriptor, retrying interrupted reads. The descriptor is not owned by the source.
+class FdSource {
+public:
+    explicit FdSource(int fd) : _fd(fd) {}
+    size_t read(uint8_t* data, size_t len) {
+        for (;;) {
+            const ssize_t count = ::read(_fd, data, len);
+            if (count >= 0) {
+                return static_cast<size_t>(count);
+            }
+            if (errno != EINTR) {
+                return 0;
+            }
+        }
+    }
+private:
+    int _fd;
+};
+#endif
+
+} // namespace stream_buf
@@ -0,0 +1,275 @@
+#pragma once
+
+#include "stream_buf_reader.h"
+#include "stream_buf_writer.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+/*!
+Predictive encoding of time series, such as flight controller blackbox logs, where consecutive frames differ by a small amount.
+
+Each frame is a fixed set of N fields. Each field has a predictor, and the residual, that is the difference between the value and
+its prediction, is ZigZag encoded so that residuals of small magnitude are small unsigned values.
+The residuals are written in groups of four, each group preceded by a tag byte which holds a 2-bit width code for each residual:
+    0: 0 bits (the prediction was exact)
+    1: 4 bits
+    2: 8 bits
+    3: 32 bits
+with the first residual of the group in the least significant bits of the tag. The residuals of a group are packed
+as a little endian bit stream, first residual in the least significant bits, and padded to a whole number of bytes.
+The 4-bit width is what makes the encoding pay off for noisy sensor data, where few residuals are zero but most are small.
+
+The first frame after a reset has no history and so is written absolute, the second frame uses the PREVIOUS predictor
+in place of LINEAR. Writing a frame absolute from time to time, eg at the start of each flash page, allows decoding to resume after a lost page.
+Arithmetic is modulo 2^32, so values may be any 32-bit signed or unsigned quantity, such as a wrapping microsecond timestamp.
+*/
+namespace stream_buf {
+
+enum class Predictor : uint8_t {
+    NONE, //!< the value is written absolute
+    PREVIOUS, //!< the value of the field in the previous frame
+    LINEAR //!< linear extrapolation of the previous two frames, 2 * previous - previous_previous
+};
+
+/*!
+History of the previous two frames, and the prediction of the next frame from them.
+The prediction is computed as a * previous + b * previous_previous, with per-field coefficients, so that the
+loop over the fields has no branches and may be vectorized.
+*/
+template <size_t N>
+class TimeSeriesPredictor {
+public:
+    explicit TimeSeriesPredictor(const std::array<Predictor, N>& predictors) {
+        for (size_t ii = 0; ii < N; ++ii) {
+            _a[ii] = (predictors[ii] == Predictor::NONE) ? 0 : (predictors[ii] == Predictor::PREVIOUS) ? 1 : 2;
+            _b[ii] = (predictors[ii] == Predictor::LINEAR) ? UINT32_MAX : 0; // -1 modulo 2^32
+        }
+    }
+public:
+    //! Discard the history, so the next frame is written absolute
+    void reset() {
+        _previous.fill(0);
+        _previous_previous.fill(0);
+        _history = 0;
+    }
+    uint32_t predict(size_t index) const { return _a[index] * _previous[index] + _b[index] * _previous_previous[index]; }
+    void update(const std::array<uint32_t, N>& values) {
+        // repeat the first frame, so that LINEAR predicts the same as PREVIOUS for the second frame
+        _previous_previous = (_history == 0) ? values : _previous;
+        _previous = values;
+        _history = 1;
+    }
+private:
+    std::array<uint32_t, N> _a {};
+    std::array<uint32_t, N> _b {};
+    std::array<uint32_t, N> _previous {};
+    std::array<uint32_t, N> _previous_previous {};
+    uint32_t _history {0}; //!< 1 once there is a previous frame
+};
+
+static constexpr size_t TIME_SERIES_GROUP_SIZE = 4;
+//! maximum number of bytes of residuals following a tag byte
+static constexpr size_t TIME_SERIES_GROUP_PAYLOAD_MAX = TIME_SERIES_GROUP_SIZE * sizeof(uint32_t);
+
+//! width in bits of each residual width code
+static constexpr std::array<uint8_t, 4> TIME_SERIES_RESIDUAL_BITS = { 0, 4, 8, 32 };
+static constexpr std::array<uint32_t, 4> TIME_SERIES_RESIDUAL_MASK = { 0, 0xF, 0xFF, 0xFFFFFFFF };
+
+//! width code for residual, computed as a sum of comparisons rather than with branches, as the widths are unpredictable
+constexpr uint8_t time_series_width_code(uint32_t residual) {
+    return static_cast<uint8_t>(static_cast<unsigned>(residual != 0) + static_cast<unsigned>(residual > 0xF) + static_cast<unsigned>(residual > 0xFF));
+}
+
+//! number of bytes of residuals following each tag byte
+constexpr std::array<uint8_t, 256> make_time_series_group_size_table() {
+    std::array<uint8_t, 256> table {};
+    for (size_t tag = 0; tag < table.size(); ++tag) {
+        size_t bits = 0;
+        for (size_t ii = 0; ii < TIME_SERIES_GROUP_SIZE; ++ii) {
+            bits += TIME_SERIES_RESIDUAL_BITS[(tag >> (2 * ii)) & 3U];
+        }
+        table[tag] = static_cast<uint8_t>((bits + 7) / 8);
+    }
+    return table;
+}
+static constexpr std::array<uint8_t, 256> TIME_SERIES_GROUP_SIZE_TABLE = make_time_series_group_size_table();
+
+/*!
+Unpack the count residuals of a group with the given tag from payload.
+Each residual is extracted from a single unaligned 64-bit load, so payload must be followed by at least 8 readable bytes.
+*/
+inline void time_series_unpack_group(uint8_t tag, const uint8_t* payload, uint32_t* residuals, size_t count) {
+    size_t bit = 0;
+    for (size_t ii = 0; ii < count; ++ii) {
+        const size_t code = (tag >> (2 * ii)) & 3U;
+        const uint64_t word = load<uint64_t>(payload + bit / 8); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        residuals[ii] = static_cast<uint32_t>(word >> (bit % 8)) & TIME_SERIES_RESIDUAL_MASK[code]; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        bit += TIME_SERIES_RESIDUAL_BITS[code];
+    }
+}
+
+} // namespace stream_buf
+
+/*!
+Encoder for frames of N fields, see stream_buf_time_series.h.
+*/
+template <size_t N>
+class TimeSeriesEncoder {
+public:
+    static constexpr size_t GROUP_COUNT = (N + stream_buf::TIME_SERIES_GROUP_SIZE - 1) / stream_buf::TIME_SERIES_GROUP_SIZE;
+    //! maximum encoded size of a frame, when every residual requires 32 bits
+    static constexpr size_t FRAME_SIZE_MAX = GROUP_COUNT + N * sizeof(uint32_t);
+public:
+    explicit TimeSeriesEncoder(const std::array<stream_buf::Predictor, N>& predictors) : _predictor(predictors) {}
+public:
+    //! Discard the history, so the next frame is written absolute
+    void reset() { _predictor.reset(); }
+    /*!
+    Write a frame, with a single bounds check for the whole frame.
+    Returns false, writing nothing and leaving the history unchanged, if there is insufficient space for FRAME_SIZE_MAX bytes.
+    */
+    template <typename Writer, typename T>
+    bool write_frame(Writer& writer, const std::array<T, N>& values) {
+        static_assert(std::is_integral_v<T> && sizeof(T) <= sizeof(uint32_t), "values must be integers of up to 32 bits");
+        StreamBufWriter frame = writer.reserve(FRAME_SIZE_MAX);
+        if (frame.bytes_remaining() < FRAME_SIZE_MAX) {
+            return false;
+        }
+        std::array<uint32_t, N> current {};
+        std::array<uint32_t, N> residuals {};
+        for (size_t ii = 0; ii < N; ++ii) {
+            current[ii] = static_cast<uint32_t>(values[ii]);
+            const auto residual = static_cast<int32_t>(current[ii] - _predictor.predict(ii));
+            residuals[ii] = stream_buf::zigzag_encode(residual);
+        }
+        for (size_t group = 0; group < N; group += stream_buf::TIME_SERIES_GROUP_SIZE) {
+            const size_t count = std::min(stream_buf::TIME_SERIES_GROUP_SIZE, N - group);
+            // pack the residuals in a 64-bit accumulator, storing its whole bytes after each residual, so there are no data dependent branches
+            std::array<uint8_t, stream_buf::TIME_SERIES_GROUP_PAYLOAD_MAX + sizeof(uint64_t)> payload; // NOLINT(cppcoreguidelines-pro-type-member-init)
+            size_t size = 0;
+            uint64_t acc = 0;
+            size_t bits = 0;
+            uint8_t tag = 0;
+            for (size_t ii = 0; ii < count; ++ii) {
+                const uint32_t residual = residuals[group + ii];
+                const uint8_t code = stream_buf::time_series_width_code(residual);
+                tag = static_cast<uint8_t>(tag | (code << (2 * ii)));
+                acc |= static_cast<uint64_t>(residual) << bits;
+                bits += stream_buf::TIME_SERIES_RESIDUAL_BITS[code];
+                stream_buf::store<uint64_t>(&payload[size], acc);
+                size += bits / 8;
+                acc >>= bits & ~size_t{7};
+                bits %= 8;
+            }
+            stream_buf::store<uint64_t>(&payload[size], acc);
+            size += (bits + 7) / 8;
+            frame.write_u8(tag);
+            frame.write_data(&payload[0], size);
+        }
+        writer.commit(frame);
+        _predictor.update(current);
+        return true;
+    }
+private:
+    stream_buf::TimeSeriesPredictor<N> _predictor;
+};
+
+/*!
+Decoder for frames written by TimeSeriesEncoder, constructed with the same predictors.
+
+read_frames() decodes a batch of frames into columns, one array per field. The residuals of each frame are unpacked with
+branch-free shifted and masked loads, and the values of all the fields are then reconstructed in a single loop with no dependencies
+between fields, which the compiler may vectorize.
+*/
+template <size_t N>
+class TimeSeriesDecoder {
+public:
+    static constexpr size_t GROUP_COUNT = TimeSeriesEncoder<N>::GROUP_COUNT;
+    static constexpr size_t FRAME_SIZE_MAX = TimeSeriesEncoder<N>::FRAME_SIZE_MAX;
+public:
+    explicit TimeSeriesDecoder(const std::array<stream_buf::Predictor, N>& predictors) : _predictor(predictors) {}
+public:
+    //! Discard the history, at the same point in the stream as the encoder was reset
+    void reset() { _predictor.reset(); }
+    /*!
+    Read a frame into values.
+    Returns false, leaving values and the history unchanged, if the frame is truncated, in which case the reader is left part way through the frame.
+    */
+    template <typename Reader, typename T>
+    bool read_frame(Reader& reader, std::array<T, N>& values) {
+        std::array<uint32_t, N> current {};
+        if (!read_residuals(reader, current)) {
+            return false;
+        }
+        reconstruct(current);
+        for (size_t ii = 0; ii < N; ++ii) {
+            values[ii] = static_cast<T>(current[ii]);
+        }
+        return true;
+    }
+    /*!
+    Read up to count frames, writing the value of field ii of frame jj to columns[ii][jj].
+    Returns the number of frames read, which is less than count if the data is exhausted or truncated.
+    */
+    template <typename Reader, typename T>
+    size_t read_frames(Reader& reader, size_t count, const std::array<T*, N>& columns) {
+        // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        std::array<uint32_t, N> current {};
+        for (size_t frame = 0; frame < count; ++frame) {
+            if (!read_residuals(reader, current)) {
+                return frame;
+            }
+            reconstruct(current);
+            for (size_t ii = 0; ii < N; ++ii) {
+                columns[ii][frame] = static_cast<T>(current[ii]);
+            }
+        }
+        return count;
+        // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+private:
+    //! Read the ZigZag encoded residuals of a frame into residuals
+    template <typename Reader>
+    static bool read_residuals(Reader& reader, std::array<uint32_t, N>& residuals) {
+        // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        if (reader.bytes_remaining() >= FRAME_SIZE_MAX + sizeof(uint64_t)) {
+            // fast path, unpack directly from the buffer
+            const uint8_t* const start = reader.ptr();
+            const uint8_t* ptr = start;
+            for (size_t group = 0; group < N; group += stream_buf::TIME_SERIES_GROUP_SIZE) {
+                const uint8_t tag = *ptr++;
+                stream_buf::time_series_unpack_group(tag, ptr, &residuals[group], std::min(stream_buf::TIME_SERIES_GROUP_SIZE, N - group));
+                ptr += stream_buf::TIME_SERIES_GROUP_SIZE_TABLE[tag];
+            }
+            reader.advance(static_cast<size_t>(ptr - start));
+            return true;
+        }
+        // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        // near the end of the data, check each group and unpack from a copy, which for the Refilling policy refills the window as required
+        for (size_t group = 0; group < N; group += stream_buf::TIME_SERIES_GROUP_SIZE) {
+            if (!reader.require(1)) {
+                return false;
+            }
+            const uint8_t tag = reader.template read_unchecked<uint8_t>();
+            const size_t size = stream_buf::TIME_SERIES_GROUP_SIZE_TABLE[tag];
+            if (!reader.require(size)) {
+                return false;
+            }
+            std::array<uint8_t, stream_buf::TIME_SERIES_GROUP_PAYLOAD_MAX + sizeof(uint64_t)> payload {};
+            reader.read_data(&payload[0], size);
+            stream_buf::time_series_unpack_group(tag, &payload[0], &residuals[group], std::min(stream_buf::TIME_SERIES_GROUP_SIZE, N - group));
+        }
+        return true;
+    }
+    //! Replace the residuals with the reconstructed values, and update the history
+    void reconstruct(std::array<uint32_t, N>& values) {
+        for (size_t ii = 0; ii < N; ++ii) {
+            values[ii] = _predictor.predict(ii) + static_cast<uint32_t>(stream_buf::zigzag_decode(values[ii]));
+        }
+        _predictor.update(values);
+    }
+private:
+    stream_buf::TimeSeriesPredictor<N> _predictor;
+};
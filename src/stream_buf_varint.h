@@ -0,0 +1,123 @@
+#pragma once
+
+#include "stream_buf_endian.h"
+#include <cstddef>
+#include <cstdint>
+
+/*!
+Varint (LEB128) and ZigZag encoding helpers used by StreamBufWriter and StreamBufReader.
+
+A varint stores 7 bits of the value in each byte, least significant group first,
+with the top bit of each byte set if there are further bytes to follow.
+ZigZag maps signed integers to unsigned so that values of small magnitude have a short encoding.
+
+When there is sufficient space in the buffer, encoding and decoding use a single 64-bit word,
+spreading or compacting the 7-bit groups with shifts and masks rather than looping over the bytes.
+*/
+namespace stream_buf {
+
+static constexpr size_t VARINT_U32_SIZE_MAX = 5;
+static constexpr size_t VARINT_U64_SIZE_MAX = 10;
+
+constexpr uint32_t zigzag_encode(int32_t value) { return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31); }
+constexpr uint64_t zigzag_encode(int64_t value) { return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63); }
+constexpr int32_t zigzag_decode(uint32_t value) { return static_cast<int32_t>((value >> 1) ^ (0U - (value & 1U))); }
+constexpr int64_t zigzag_decode(uint64_t value) { return static_cast<int64_t>((value >> 1) ^ (0ULL - (value & 1ULL))); }
+
+constexpr size_t count_leading_zeros(uint64_t value) { // value must be non-zero
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<size_t>(__builtin_clzll(value));
+#else
+    size_t count = 0;
+    for (uint64_t bit = 1ULL << 63; (value & bit) == 0; bit >>= 1) { ++count; }
+    return count;
+#endif
+}
+
+constexpr size_t count_trailing_zeros(uint64_t value) { // value must be non-zero
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<size_t>(__builtin_ctzll(value));
+#else
+    size_t count = 0;
+    for (; (value & 1U) == 0; value >>= 1) { ++count; }
+    return count;
+#endif
+}
+
+//! number of bytes required to encode value as a varint
+constexpr size_t varint_size(uint64_t value) { return (70 - count_leading_zeros(value | 1U)) / 7; }
+
+//! spread the low 56 bits of value into 8 bytes of 7 bits each
+constexpr uint64_t varint_spread(uint64_t value) {
+    value = (value & 0x000000000FFFFFFFULL) | ((value & 0x00FFFFFFF0000000ULL) << 4);
+    value = (value & 0x00003FFF00003FFFULL) | ((value & 0x0FFFC0000FFFC000ULL) << 2);
+    value = (value & 0x007F007F007F007FULL) | ((value & 0x3F803F803F803F80ULL) << 1);
+    return value;
+}
+
+//! inverse of varint_spread, the top bit of each byte must be clear
+constexpr uint64_t varint_compact(uint64_t value) {
+    value = (value & 0x007F007F007F007FULL) | ((value & 0x7F007F007F007F00ULL) >> 1);
+    value = (value & 0x00003FFF00003FFFULL) | ((value & 0x3FFF00003FFF0000ULL) >> 2);
+    value = (value & 0x000000000FFFFFFFULL) | ((value & 0x0FFFFFFF00000000ULL) >> 4);
+    return value;
+}
+
+/*!
+Encode value, which requires size == varint_size(value) bytes, at ptr.
+space is the number of bytes available at ptr, if it is at least 8 then the encoding is written as a single word.
+*/
+constexpr void encode_varint(uint8_t* ptr, uint64_t value, size_t size, size_t space) {
+    constexpr uint64_t CONTINUATION_BITS = 0x8080808080808080ULL;
+    if (space >= sizeof(uint64_t) && size <= sizeof(uint64_t)) {
+        // set the continuation bit on all bytes but the last
+        const uint64_t continuation = CONTINUATION_BITS & ((1ULL << (8 * (size - 1))) - 1);
+        store_little_endian(ptr, varint_spread(value) | continuation);
+        return;
+    }
+    for (size_t ii = 1; ii < size; ++ii) {
+        *ptr++ = static_cast<uint8_t>(value | 0x80U);
+        value >>= 7;
+    }
+    *ptr = static_cast<uint8_t>(value);
+}
+
+/*!
+Decode a varint from the available bytes at ptr.
+Returns the number of bytes consumed, or zero if the encoding is truncated or longer than VARINT_U64_SIZE_MAX.
+*/
+constexpr size_t decode_varint(const uint8_t* ptr, size_t available, uint64_t& value) {
+    constexpr uint64_t CONTINUATION_BITS = 0x8080808080808080ULL;
+    if (available >= sizeof(uint64_t)) {
+        const uint64_t word = load_little_endian<uint64_t>(ptr);
+        const uint64_t stop = ~word & CONTINUATION_BITS;
+        if (stop != 0) {
+            // stop ^ (stop - 1) masks all bytes up to and including the first byte without a continuation bit
+            value = varint_compact(word & (stop ^ (stop - 1)) & ~CONTINUATION_BITS);
+            return (count_trailing_zeros(stop) >> 3) + 1;
+        }
+        value = varint_compact(word & ~CONTINUATION_BITS);
+        if (available > sizeof(uint64_t)) {
+            const uint8_t byte8 = ptr[8];
+            value |= static_cast<uint64_t>(byte8 & 0x7FU) << 56;
+            if ((byte8 & 0x80U) == 0) {
+                return 9;
+            }
+            if (available > 9 && ptr[9] <= 1) {
+                value |= static_cast<uint64_t>(ptr[9]) << 63;
+                return 10;
+            }
+        }
+        return 0;
+    }
+    value = 0;
+    for (size_t ii = 0; ii < available; ++ii) {
+        value |= static_cast<uint64_t>(ptr[ii] & 0x7FU) << (7 * ii);
+        if ((ptr[ii] & 0x80U) == 0) {
+            return ii + 1;
+        }
+    }
+    return 0;
+}
+
+} // namespace stream_buf
@@ -1,44 +1,169 @@
 #pragma once
 
+#include "stream_buf_ascii.h"
+#include "stream_buf_bounds_policy.h"
+#include "stream_buf_byte_swap.h"
+#include "stream_buf_checksum.h"
+#include "stream_buf_endian.h"
+#include "stream_buf_hex_base64.h"
+#include "stream_buf_varint.h"
+#include <algorithm>
+#include <array>
 #include <cstdint>
 #include <cstring>
+#include <limits>
 #include <string>
+#include <type_traits>
+
+template <typename BoundsPolicy, typename Checksum = stream_buf::NoChecksum>
+class StreamBufWriterT;
+
+namespace stream_buf {
+/*!
+Handle to a placeholder field of type T and byte order E, reserved by StreamBufWriterT::reserve_placeholder()
+and filled in later using StreamBufWriterT::patch().
+The offset is relative to the start of the stream, that is the start of the buffer plus, for the Flushing policy,
+the bytes already flushed, so the handle remains valid as the writer advances and a handle whose field has been flushed is detected.
+*/
+template <typename T, Endian E = Endian::LITTLE>
+struct Placeholder {
+    using value_type = T;
+    size_t offset;
+};
+
+template <typename Writer, typename T, Endian E>
+class LengthPrefix;
+} // namespace stream_buf
+
+//! Writer without bounds checking on the plain write functions, this is the default
+using StreamBufWriter = StreamBufWriterT<stream_buf::Unchecked>;
+using StreamBufWriterChecked = StreamBufWriterT<stream_buf::Checked>;
+using StreamBufWriterSticky = StreamBufWriterT<stream_buf::Sticky>;
+//! Writer that counts its bounds checks, see stream_buf::Counting
+using StreamBufWriterCounting = StreamBufWriterT<stream_buf::Counting>;
+//! Writer that hands full buffers to a sink rather than dropping writes, see stream_buf_sink.h
+template <typename Sink>
+using StreamBufWriterFlushing = StreamBufWriterT<stream_buf::Flushing<Sink>>;
 
 /*!
 Simple serializer/deserializer with optional bounds checking
+
+BoundsPolicy is one of stream_buf::Unchecked, stream_buf::Checked, stream_buf::Sticky, stream_buf::Counting, or stream_buf::Flushing
+and determines the bounds checking performed by the plain read and write functions.
+
+Checksum is stream_buf::NoChecksum, or a checksum accumulator such as stream_buf::Crc8DvbS2,
+into which bytes are folded as they are written or read.
+
+The writer may be used in constant expressions, except with the Flushing policy, see stream_buf::make_frame().
+Note that the writer forms a pointer one byte beyond the end of its buffer, which is only a constant expression
+if that byte is within the same array.
 */
-class StreamBufWriter {
+template <typename BoundsPolicy, typename Checksum>
+class StreamBufWriterT {
 public:
-    StreamBufWriter(uint8_t* ptr, size_t len) : _ptr(ptr), _begin(ptr), _end(ptr + len + 1) {}
-    StreamBufWriter(uint8_t* ptr, uint8_t* end) : _ptr(ptr), _begin(ptr), _end(end) {}
+    constexpr StreamBufWriterT(uint8_t* ptr, size_t len) : _ptr(ptr), _begin(ptr), _end(ptr + len + 1) { static_assert(!HAS_CHECKSUM, "checksum required"); }
+    constexpr StreamBufWriterT(uint8_t* ptr, uint8_t* end) : _ptr(ptr), _begin(ptr), _end(end) { static_assert(!HAS_CHECKSUM, "checksum required"); }
+    /*!
+    Construct a writer with a checksum accumulator attached, all bytes written are folded into the checksum.
+    The checksum is not owned by the writer and must outlive it.
+    */
+    constexpr StreamBufWriterT(uint8_t* ptr, size_t len, Checksum& checksum) : _ptr(ptr), _begin(ptr), _end(ptr + len + 1), _checksum(&checksum) {}
+    constexpr StreamBufWriterT(uint8_t* ptr, uint8_t* end, Checksum& checksum) : _ptr(ptr), _begin(ptr), _end(end), _checksum(&checksum) {}
+    //! Construct a writer with policy state, eg stream_buf::Flushing<Sink>{&sink}
+    constexpr StreamBufWriterT(uint8_t* ptr, size_t len, BoundsPolicy bounds) : _ptr(ptr), _begin(ptr), _end(ptr + len + 1), _bounds(bounds) { static_assert(!HAS_CHECKSUM, "checksum required"); }
+    constexpr StreamBufWriterT(uint8_t* ptr, size_t len, Checksum& checksum, BoundsPolicy bounds) : _ptr(ptr), _begin(ptr), _end(ptr + len + 1), _checksum(&checksum), _bounds(bounds) {}
 public:
-    StreamBufWriter reader() { return StreamBufWriter(_begin, _ptr + 1); }
+    static constexpr bool IS_COUNTING = std::is_same_v<BoundsPolicy, stream_buf::Counting>;
+    //! true if the plain functions are not bounds checked
+    static constexpr bool IS_UNCHECKED = std::is_same_v<BoundsPolicy, stream_buf::Unchecked> || IS_COUNTING;
+    static constexpr bool IS_STICKY = std::is_same_v<BoundsPolicy, stream_buf::Sticky>;
+    static constexpr bool IS_FLUSHING = stream_buf::is_flushing<BoundsPolicy>;
+    static constexpr bool HAS_CHECKSUM = !std::is_same_v<Checksum, stream_buf::NoChecksum>;
+
+    constexpr StreamBufWriterT<BoundsPolicy> reader() { return StreamBufWriterT<BoundsPolicy>(_begin, _ptr + 1); }
 
-    void reset() { _ptr = _begin; }
-    bool is_empty() const { return _ptr == _begin; }
-    bool is_full() const { return _ptr + 1 >= _end; }
-    const uint8_t* ptr() const { return _ptr; }
-    const uint8_t* begin() const { return _begin; }
-    const uint8_t* end() const { return _end; }
+    constexpr void reset() {
+        _ptr = _begin;
+        if constexpr (IS_STICKY) {
+            if (_bounds.end_offset != 0) {
+                _end = _begin + _bounds.end_offset;
+                _bounds.end_offset = 0;
+            }
+        }
+    }
+    //! returns true if there has been an overflow since construction or the last reset(), always false unless the policy is Sticky
+    constexpr bool overflowed() const {
+        if constexpr (IS_STICKY) { return _bounds.end_offset != 0; }
+        return false;
+    }
+    //! returns the number of bounds checks performed since construction, always zero unless the policy is Counting
+    constexpr size_t bounds_checks() const {
+        if constexpr (IS_COUNTING) { return _bounds.checks; }
+        return 0;
+    }
+    /*!
+    For the Flushing policy, hand the bytes written so far to the sink and reuse the buffer from the start.
+    Call this at the end of a stream to write out any remaining bytes.
+    Returns false, leaving the buffer unchanged, if the sink fails. For other policies this does nothing.
+    Note that bytes_written() restarts from zero, and placeholders reserved before a flush can no longer be patched,
+    patch() ignores them.
+    */
+    constexpr bool flush() {
+        if constexpr (IS_FLUSHING) {
+            if (_ptr != _begin) {
+                if (!_bounds.sink->write(_begin, bytes_written())) {
+                    return false;
+                }
+                _bounds.flushed += bytes_written();
+                _ptr = _begin;
+            }
+        }
+        return true;
+    }
+    constexpr bool is_empty() const { return _ptr == _begin; }
+    constexpr bool is_full() const { return _ptr + 1 >= _end; }
+    constexpr const uint8_t* ptr() const { return _ptr; }
+    constexpr const uint8_t* begin() const { return _begin; }
+    constexpr const uint8_t* end() const { return _end; }
 
     /*!
     when writing - return available space
     when reading - return the number of bytes remaining in the buffer
     */
-    size_t bytes_remaining() const { return static_cast<size_t>(_end - _ptr - 1); } // guaranteed to be >= 0
+    constexpr size_t bytes_remaining() const { return static_cast<size_t>(_end - _ptr - 1); } // guaranteed to be >= 0
     /*!
     when writing - return the number of bytes written to the buffer
     when reading - return the number of bytes read
     */
-    size_t bytes_written() const { return static_cast<size_t>(_ptr - _begin); } // guaranteed to be >= 0
+    constexpr size_t bytes_written() const { return static_cast<size_t>(_ptr - _begin); } // guaranteed to be >= 0
+    //! for the Flushing policy the number of bytes handed to the sink, so bytes_flushed() + bytes_written() is the position in the stream
+    constexpr size_t bytes_flushed() const {
+        if constexpr (IS_FLUSHING) { return _bounds.flushed; }
+        return 0;
+    }
 
     /*! Advance _ptr
     when reading - this skips data
     when writing - this effectively commits the written data
     */
-    void advance(size_t size) { if (_ptr + size < _end) { _ptr += size; } }
+    constexpr void advance(size_t size) { if (fits(size)) { advance_unchecked(size); } }
+    /*!
+    Reserve space for a fixed layout message, performing a single bounds check.
+    Returns a writer over the next len bytes, the unchecked write functions may be used on this writer.
+    If there is insufficient space the returned writer has zero capacity, that is bytes_remaining() == 0.
+    The reserved bytes are not committed until commit() is called.
+    */
+    constexpr StreamBufWriter reserve(size_t len) { return StreamBufWriter(_ptr, fits(len) ? len : 0); }
+    //! As reserve(), but with a checksum accumulator attached to the returned writer, eg for the checksum of a frame within the stream
+    template <typename ReservationChecksum>
+    constexpr StreamBufWriterT<stream_buf::Unchecked, ReservationChecksum> reserve(size_t len, ReservationChecksum& checksum) {
+        return StreamBufWriterT<stream_buf::Unchecked, ReservationChecksum>(_ptr, fits(len) ? len : 0, checksum);
+    }
+    //! Commit the data written to a writer obtained from reserve()
+    template <typename ReservationChecksum>
+    constexpr void commit(const StreamBufWriterT<stream_buf::Unchecked, ReservationChecksum>& reservation) { advance_unchecked(reservation.bytes_written()); }
      //! modifies internal pointers so that data can be read
-    const uint8_t* switch_to_reader() {
+    constexpr const uint8_t* switch_to_reader() {
         const uint8_t* end_previous = _end;
         _end = _ptr + 1;
         _ptr = _begin;
@@ -47,133 +172,498 @@ public:
 //
 // Read functions
 //
-    uint8_t read_u8() { return *_ptr++; }
-    uint16_t read_u16() { return read_u8() | static_cast<uint16_t>(read_u8() << 8); }
-    uint32_t read_u32() {
-        uint32_t ret = read_u8();
-        ret |= static_cast<uint32_t>(read_u8() <<  8);
-        ret |= static_cast<uint32_t>(read_u8() << 16);
-        ret |= static_cast<uint32_t>(read_u8() << 24);
-        return ret;
-    }
-    uint16_t read_u16_big_endian() { return static_cast<uint16_t>(read_u8() << 8) | read_u8(); }
-    uint32_t read_u32_big_endian() {
-        uint32_t ret = static_cast<uint32_t>(read_u8() << 24);
-        ret |= static_cast<uint32_t>(read_u8() << 16);
-        ret |= static_cast<uint32_t>(read_u8() <<  8);
-        ret |= read_u8();
-        return ret;
-    }
-    /*float read_f32() {
-        const uint32_t value = read_u32();
-        // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
-        return *reinterpret_cast<const float*>(&value); // cppcheck-suppress invalidPointerCast
-        // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
-    }*/
-
-    uint8_t read_u8_checked() { if (_ptr < _end) { return *_ptr++; } return 0; }
-    uint16_t read_u16_checked() {
-        if (_ptr < _end - sizeof(uint16_t)) {
-            return read_u16();
-        }
-        return 0;
+    /*!
+    Read a value of type T in byte order E.
+    T may be any integral, floating point or enum type.
+    */
+    template <typename T, stream_buf::Endian E = stream_buf::Endian::LITTLE>
+    constexpr T read() {
+        if constexpr (IS_UNCHECKED) { return read_unchecked<T, E>(); }
+        return read_checked<T, E>();
     }
-    uint32_t read_u32_checked() {
-        if (_ptr < _end - sizeof(uint32_t)) {
-            return read_u32();
+    //! Read a value of type T in byte order E, returns zero if there is not enough data remaining
+    template <typename T, stream_buf::Endian E = stream_buf::Endian::LITTLE>
+    constexpr T read_checked() { if (fits(sizeof(T))) { return read_unchecked<T, E>(); } return T{}; }
+    //! Read a value of type T in byte order E, regardless of BoundsPolicy
+    template <typename T, stream_buf::Endian E = stream_buf::Endian::LITTLE>
+    constexpr T read_unchecked() { const T ret = stream_buf::load<T, E>(_ptr); advance_unchecked(sizeof(T)); return ret; }
+    constexpr uint8_t read_u8() { return read<uint8_t>(); }
+    constexpr uint16_t read_u16() { return read<uint16_t>(); }
+    constexpr uint32_t read_u32() { return read<uint32_t>(); }
+    constexpr uint64_t read_u64() { return read<uint64_t>(); }
+    constexpr int8_t read_s8() { return read<int8_t>(); }
+    constexpr int16_t read_s16() { return read<int16_t>(); }
+    constexpr int32_t read_s32() { return read<int32_t>(); }
+    constexpr int64_t read_s64() { return read<int64_t>(); }
+    constexpr float read_f32() { return read<float>(); }
+    constexpr double read_f64() { return read<double>(); }
+    constexpr uint16_t read_u16_big_endian() { return read<uint16_t, stream_buf::Endian::BIG>(); }
+    constexpr uint32_t read_u32_big_endian() { return read<uint32_t, stream_buf::Endian::BIG>(); }
+    constexpr uint64_t read_u64_big_endian() { return read<uint64_t, stream_buf::Endian::BIG>(); }
+    constexpr int16_t read_s16_big_endian() { return read<int16_t, stream_buf::Endian::BIG>(); }
+    constexpr int32_t read_s32_big_endian() { return read<int32_t, stream_buf::Endian::BIG>(); }
+    constexpr int64_t read_s64_big_endian() { return read<int64_t, stream_buf::Endian::BIG>(); }
+    constexpr float read_f32_big_endian() { return read<float, stream_buf::Endian::BIG>(); }
+    constexpr double read_f64_big_endian() { return read<double, stream_buf::Endian::BIG>(); }
+
+    constexpr uint8_t read_u8_checked() { return read_checked<uint8_t>(); }
+    constexpr uint16_t read_u16_checked() { return read_checked<uint16_t>(); }
+    constexpr uint32_t read_u32_checked() { return read_checked<uint32_t>(); }
+    constexpr uint64_t read_u64_checked() { return read_checked<uint64_t>(); }
+    constexpr int8_t read_s8_checked() { return read_checked<int8_t>(); }
+    constexpr int16_t read_s16_checked() { return read_checked<int16_t>(); }
+    constexpr int32_t read_s32_checked() { return read_checked<int32_t>(); }
+    constexpr int64_t read_s64_checked() { return read_checked<int64_t>(); }
+    constexpr float read_f32_checked() { return read_checked<float>(); }
+    constexpr double read_f64_checked() { return read_checked<double>(); }
+    constexpr uint16_t read_u16_big_endian_checked() { return read_checked<uint16_t, stream_buf::Endian::BIG>(); }
+    constexpr uint32_t read_u32_big_endian_checked() { return read_checked<uint32_t, stream_buf::Endian::BIG>(); }
+    constexpr uint64_t read_u64_big_endian_checked() { return read_checked<uint64_t, stream_buf::Endian::BIG>(); }
+    constexpr int16_t read_s16_big_endian_checked() { return read_checked<int16_t, stream_buf::Endian::BIG>(); }
+    constexpr int32_t read_s32_big_endian_checked() { return read_checked<int32_t, stream_buf::Endian::BIG>(); }
+    constexpr int64_t read_s64_big_endian_checked() { return read_checked<int64_t, stream_buf::Endian::BIG>(); }
+    constexpr float read_f32_big_endian_checked() { return read_checked<float, stream_buf::Endian::BIG>(); }
+    constexpr double read_f64_big_endian_checked() { return read_checked<double, stream_buf::Endian::BIG>(); }
+
+    /*!
+    Read a varint (LEB128) encoded value. Varint reads are always bounds checked.
+    Returns zero, without advancing, if the encoding is truncated or malformed;
+    for the Sticky policy this is recorded as an overflow.
+    */
+    constexpr uint64_t read_varint_u64() {
+        uint64_t value = 0;
+        const size_t size = stream_buf::decode_varint(_ptr, bytes_remaining(), value);
+        if (size == 0) {
+            record_overflow();
+            return 0;
         }
-        return 0;
+        advance_unchecked(size);
+        return value;
     }
-    uint16_t read_u16_big_endian_checked() {
-        if (_ptr < _end - sizeof(uint16_t)) {
-            return read_u16_big_endian();
+    constexpr uint32_t read_varint_u32() {
+        uint64_t value = 0;
+        const size_t size = stream_buf::decode_varint(_ptr, bytes_remaining(), value);
+        if (size == 0 || size > stream_buf::VARINT_U32_SIZE_MAX || value > UINT32_MAX) {
+            record_overflow();
+            return 0;
         }
-        return 0;
+        advance_unchecked(size);
+        return static_cast<uint32_t>(value);
     }
-    uint32_t read_u32_big_endian_checked() {
-        if (_ptr < _end - sizeof(uint32_t)) {
-            return read_u32_big_endian();
+    //! Read a ZigZag varint encoded value
+    constexpr int32_t read_varint_s32() { return stream_buf::zigzag_decode(read_varint_u32()); }
+    constexpr int64_t read_varint_s64() { return stream_buf::zigzag_decode(read_varint_u64()); }
+
+    void read_data(void *data, size_t len) { read_data(static_cast<uint8_t*>(data), len); }
+    constexpr void read_data(uint8_t* data, size_t len) {
+        if (fits(len)) {
+            if (std::is_constant_evaluated()) {
+                std::copy_n(_ptr, len, data);
+            } else if (len != 0) { // memcpy requires valid pointers even when len is 0, and empty payloads may be nullptr
+                memcpy(data, _ptr, len);
+            }
+            advance_unchecked(len);
         }
-        return 0;
     }
-    /*float read_f32_checked() {
-        if (_ptr < _end - sizeof(float)) {
-            return read_f32();
+    /*!
+    Read an array of count values of type T in byte order E, with a single bounds check.
+    If the byte order matches the target this is a straight copy, otherwise a vectorized byte swap is used.
+    */
+    template <typename T, stream_buf::Endian E = stream_buf::Endian::LITTLE>
+    constexpr void read_array(T* data, size_t count) {
+        if (fits(count * sizeof(T))) {
+            stream_buf::load_array<T, E>(data, _ptr, count);
+            advance_unchecked(count * sizeof(T));
         }
-        return 0.0F;
-    }*/
-
-    void read_data(void *data, size_t len) { if (_ptr + len < _end) { memcpy(data, _ptr, len); _ptr += len; } }
+    }
 //
 // Write functions
 //
-    void write_u8(uint8_t value) { *_ptr++ = value; }
-    void write_u16(uint16_t value) {
-        write_u8(static_cast<uint8_t>(value));
-        write_u8(static_cast<uint8_t>(value >> 8));
-    }
-    void write_u32(uint32_t value) {
-        write_u8(static_cast<uint8_t>(value));
-        write_u8(static_cast<uint8_t>(value >> 8));
-        write_u8(static_cast<uint8_t>(value >> 16));
-        write_u8(static_cast<uint8_t>(value >> 24));
+    /*!
+    Write a value of type T in byte order E.
+    T may be any integral, floating point or enum type.
+    */
+    template <typename T, stream_buf::Endian E = stream_buf::Endian::LITTLE>
+    constexpr void write(T value) {
+        if constexpr (IS_UNCHECKED) { write_unchecked<T, E>(value); } else { write_checked<T, E>(value); }
     }
-    void write_u16_big_endian(uint16_t value) {
-        write_u8(static_cast<uint8_t>(value >> 8));
-        write_u8(static_cast<uint8_t>(value));
+    //! Write a value of type T in byte order E, the value is not written if there is insufficient space
+    template <typename T, stream_buf::Endian E = stream_buf::Endian::LITTLE>
+    constexpr void write_checked(T value) { if (fits(sizeof(T))) { write_unchecked<T, E>(value); } }
+    //! Write a value of type T in byte order E, regardless of BoundsPolicy
+    template <typename T, stream_buf::Endian E = stream_buf::Endian::LITTLE>
+    constexpr void write_unchecked(T value) { stream_buf::store<T, E>(_ptr, value); advance_unchecked(sizeof(T)); }
+    constexpr void write_u8(uint8_t value) { write<uint8_t>(value); }
+    constexpr void write_u16(uint16_t value) { write<uint16_t>(value); }
+    constexpr void write_u32(uint32_t value) { write<uint32_t>(value); }
+    constexpr void write_u64(uint64_t value) { write<uint64_t>(value); }
+    constexpr void write_s8(int8_t value) { write<int8_t>(value); }
+    constexpr void write_s16(int16_t value) { write<int16_t>(value); }
+    constexpr void write_s32(int32_t value) { write<int32_t>(value); }
+    constexpr void write_s64(int64_t value) { write<int64_t>(value); }
+    constexpr void write_f32(float value) { write<float>(value); }
+    constexpr void write_f64(double value) { write<double>(value); }
+    constexpr void write_u16_big_endian(uint16_t value) { write<uint16_t, stream_buf::Endian::BIG>(value); }
+    constexpr void write_u32_big_endian(uint32_t value) { write<uint32_t, stream_buf::Endian::BIG>(value); }
+    constexpr void write_u64_big_endian(uint64_t value) { write<uint64_t, stream_buf::Endian::BIG>(value); }
+    constexpr void write_s16_big_endian(int16_t value) { write<int16_t, stream_buf::Endian::BIG>(value); }
+    constexpr void write_s32_big_endian(int32_t value) { write<int32_t, stream_buf::Endian::BIG>(value); }
+    constexpr void write_s64_big_endian(int64_t value) { write<int64_t, stream_buf::Endian::BIG>(value); }
+    constexpr void write_f32_big_endian(float value) { write<float, stream_buf::Endian::BIG>(value); }
+    constexpr void write_f64_big_endian(double value) { write<double, stream_buf::Endian::BIG>(value); }
+
+    constexpr void write_u8_checked(uint8_t value) { write_checked<uint8_t>(value); }
+    constexpr void write_u16_checked(uint16_t value) { write_checked<uint16_t>(value); }
+    constexpr void write_u32_checked(uint32_t value) { write_checked<uint32_t>(value); }
+    constexpr void write_u64_checked(uint64_t value) { write_checked<uint64_t>(value); }
+    constexpr void write_s8_checked(int8_t value) { write_checked<int8_t>(value); }
+    constexpr void write_s16_checked(int16_t value) { write_checked<int16_t>(value); }
+    constexpr void write_s32_checked(int32_t value) { write_checked<int32_t>(value); }
+    constexpr void write_s64_checked(int64_t value) { write_checked<int64_t>(value); }
+    constexpr void write_f32_checked(float value) { write_checked<float>(value); }
+    constexpr void write_f64_checked(double value) { write_checked<double>(value); }
+    constexpr void write_u16_big_endian_checked(uint16_t value) { write_checked<uint16_t, stream_buf::Endian::BIG>(value); }
+    constexpr void write_u32_big_endian_checked(uint32_t value) { write_checked<uint32_t, stream_buf::Endian::BIG>(value); }
+    constexpr void write_u64_big_endian_checked(uint64_t value) { write_checked<uint64_t, stream_buf::Endian::BIG>(value); }
+    constexpr void write_s16_big_endian_checked(int16_t value) { write_checked<int16_t, stream_buf::Endian::BIG>(value); }
+    constexpr void write_s32_big_endian_checked(int32_t value) { write_checked<int32_t, stream_buf::Endian::BIG>(value); }
+    constexpr void write_s64_big_endian_checked(int64_t value) { write_checked<int64_t, stream_buf::Endian::BIG>(value); }
+    constexpr void write_f32_big_endian_checked(float value) { write_checked<float, stream_buf::Endian::BIG>(value); }
+    constexpr void write_f64_big_endian_checked(double value) { write_checked<double, stream_buf::Endian::BIG>(value); }
+
+    /*!
+    Write value as a varint (LEB128), using between 1 and 10 bytes.
+    The length of the encoding is calculated up front, so only a single bounds check is required.
+    */
+    constexpr void write_varint_u64(uint64_t value) {
+        const size_t size = stream_buf::varint_size(value);
+        if constexpr (!IS_UNCHECKED) {
+            if (!fits(size)) {
+                return;
+            }
+        }
+        stream_buf::encode_varint(_ptr, value, size, bytes_remaining());
+        advance_unchecked(size);
     }
-    void write_u32_big_endian(uint32_t value) {
-        write_u8(static_cast<uint8_t>(value >> 24));
-        write_u8(static_cast<uint8_t>(value >> 16));
-        write_u8(static_cast<uint8_t>(value >> 8));
-        write_u8(static_cast<uint8_t>(value));
+    constexpr void write_varint_u32(uint32_t value) { write_varint_u64(value); }
+    //! Write value as a ZigZag varint, so that values of small magnitude have a short encoding
+    constexpr void write_varint_s32(int32_t value) { write_varint_u64(stream_buf::zigzag_encode(value)); }
+    constexpr void write_varint_s64(int64_t value) { write_varint_u64(stream_buf::zigzag_encode(value)); }
+
+    /*!
+    Write value as ASCII decimal digits, with a leading '-' if negative, and no terminator.
+    The number of digits is calculated up front, so only a single bounds check is required.
+    */
+    constexpr void write_decimal_u32(uint32_t value) { write_decimal(value, false); }
+    constexpr void write_decimal_u64(uint64_t value) { write_decimal(value, false); }
+    constexpr void write_decimal_s32(int32_t value) { write_decimal(magnitude(value), value < 0); }
+    constexpr void write_decimal_s64(int64_t value) { write_decimal(magnitude(value), value < 0); }
+    //! Write value as upper case ASCII hexadecimal digits, two per byte of the type, with leading zeros, eg for an NMEA checksum
+    constexpr void write_hex_u8(uint8_t value) { write_hex(value, 2 * sizeof(uint8_t)); }
+    constexpr void write_hex_u16(uint16_t value) { write_hex(value, 2 * sizeof(uint16_t)); }
+    constexpr void write_hex_u32(uint32_t value) { write_hex(value, 2 * sizeof(uint32_t)); }
+    constexpr void write_hex_u64(uint64_t value) { write_hex(value, 2 * sizeof(uint64_t)); }
+    /*!
+    Write a fixed point value, that is value / 10^decimals, as ASCII, eg write_fixed_s32(-12345, 2) writes "-123.45".
+    decimals must be at most 19, if it is zero no decimal point is written.
+    */
+    constexpr void write_fixed_s32(int32_t value, size_t decimals) { write_fixed(magnitude(value), value < 0, decimals); }
+    constexpr void write_fixed_s64(int64_t value, size_t decimals) { write_fixed(magnitude(value), value < 0, decimals); }
+
+    /*!
+    Reserve a placeholder field of type T and byte order E, which is written as zero and may be filled in later using patch().
+    If the placeholder is not written, because of insufficient space, then subsequently patching it has no effect.
+    Note that if a checksum is attached, the zero value is folded into the checksum, so placeholders should not be
+    within the checksummed region of a frame.
+    */
+    template <typename T, stream_buf::Endian E = stream_buf::Endian::LITTLE>
+    constexpr stream_buf::Placeholder<T, E> reserve_placeholder() {
+        const stream_buf::Placeholder<T, E> placeholder { bytes_flushed() + bytes_written() };
+        write<T, E>(T{});
+        return placeholder;
     }
-    /*void write_f32(float value) {
-        // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
-        const uint32_t u = *reinterpret_cast<const uint32_t*>(&value); // cppcheck-suppress invalidPointerCast
-        // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
-        write_u32(u);
-    }*/
+    constexpr stream_buf::Placeholder<uint8_t> reserve_u8() { return reserve_placeholder<uint8_t>(); }
+    constexpr stream_buf::Placeholder<uint16_t> reserve_u16() { return reserve_placeholder<uint16_t>(); }
+    constexpr stream_buf::Placeholder<uint32_t> reserve_u32() { return reserve_placeholder<uint32_t>(); }
+    constexpr stream_buf::Placeholder<uint16_t, stream_buf::Endian::BIG> reserve_u16_big_endian() { return reserve_placeholder<uint16_t, stream_buf::Endian::BIG>(); }
+    constexpr stream_buf::Placeholder<uint32_t, stream_buf::Endian::BIG> reserve_u32_big_endian() { return reserve_placeholder<uint32_t, stream_buf::Endian::BIG>(); }
 
-    void write_u8_checked(uint8_t value) { if (_ptr < _end) { *_ptr++ = value; } }
-    void write_u16_checked(uint16_t value) {
-        if (_ptr < _end - sizeof(uint16_t)) {
-            write_u16(value);
+    /*!
+    Fill in a placeholder previously reserved with reserve_placeholder(), this does not change the write position.
+    Returns false, doing nothing, if the placeholder was not written or, for the Flushing policy, has since been flushed.
+    */
+    template <typename T, stream_buf::Endian E>
+    constexpr bool patch(stream_buf::Placeholder<T, E> placeholder, typename stream_buf::Placeholder<T, E>::value_type value) {
+        if (placeholder.offset < bytes_flushed() || placeholder.offset - bytes_flushed() + sizeof(T) > bytes_written()) {
+            return false;
         }
+        stream_buf::store<T, E>(_begin + (placeholder.offset - bytes_flushed()), value); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        return true;
+    }
+
+    /*!
+    Begin a length prefixed nested message.
+    Returns a guard that reserves a length field of type T and byte order E, and when closed, or when it goes out of scope,
+    fills in the field with the number of bytes written after it. See stream_buf::LengthPrefix for how failure is reported.
+    Not available with a checksum attached, since the zero placeholder would be folded into the checksum:
+    compute the checksum over the finished frame instead.
+    */
+    template <typename T = uint16_t, stream_buf::Endian E = stream_buf::Endian::LITTLE>
+    constexpr stream_buf::LengthPrefix<StreamBufWriterT, T, E> length_prefix() {
+        static_assert(!HAS_CHECKSUM, "length_prefix() would fold the placeholder into the checksum");
+        return stream_buf::LengthPrefix<StreamBufWriterT, T, E>(*this);
     }
-    void write_u32_checked(uint32_t value) {
-        if (_ptr < _end - sizeof(uint32_t)) {
-            write_u32(value);
+
+    // all bulk write operations are bounds checked, for the Flushing policy they are split across flushes
+    void write_data(const void* data, size_t len) { write_data(static_cast<const uint8_t*>(data), len); }
+    constexpr void write_data(const uint8_t* data, size_t len) {
+        if constexpr (IS_FLUSHING) {
+            write_flushing(len, 1, [data](uint8_t* dst, size_t offset, size_t chunk) { memcpy(dst, data + offset, chunk); }); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        } else if (fits(len)) {
+            if (std::is_constant_evaluated()) {
+                std::copy_n(data, len, _ptr);
+            } else if (len != 0) { // memcpy requires valid pointers even when len is 0, and empty payloads may be nullptr
+                memcpy(_ptr, data, len);
+            }
+            advance_unchecked(len);
         }
     }
-    void write_u16_big_endian_checked(uint16_t value) {
-        if (_ptr < _end - sizeof(uint16_t)) {
-            write_u16(value);
+    /*!
+    Write an array of count values of type T in byte order E, with a single bounds check.
+    If the byte order matches the target this is a straight copy, otherwise a vectorized byte swap is used.
+    */
+    template <typename T, stream_buf::Endian E = stream_buf::Endian::LITTLE>
+    constexpr void write_array(const T* data, size_t count) {
+        if constexpr (IS_FLUSHING) {
+            // split at element boundaries
+            write_flushing(count * sizeof(T), sizeof(T), [data](uint8_t* dst, size_t offset, size_t chunk) {
+                stream_buf::copy_array<T, E>(dst, data + offset / sizeof(T), chunk / sizeof(T)); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            });
+        } else if (fits(count * sizeof(T))) {
+            stream_buf::store_array<T, E>(_ptr, data, count);
+            advance_unchecked(count * sizeof(T));
         }
     }
-    void write_u32_big_endian_checked(uint32_t value) {
-        if (_ptr < _end - sizeof(uint32_t)) {
-            write_u32_big_endian(value);
+    /*!
+    Write the len bytes at data as 2 * len upper case ASCII hexadecimal digits, with a single bounds check.
+    SIMD kernels are used where available, see stream_buf_hex_base64.h.
+    */
+    void write_hex_encoded(const uint8_t* data, size_t len) {
+        if constexpr (IS_FLUSHING) {
+            write_flushing(2 * len, 2, [data](uint8_t* dst, size_t offset, size_t chunk) { stream_buf::hex_encode(dst, data + offset / 2, chunk / 2); }); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        } else if (fits(2 * len)) {
+            stream_buf::hex_encode(_ptr, data, len);
+            advance_unchecked(2 * len);
         }
     }
-    /*void write_f32Checked(float value) {
-        if (_ptr < _end - sizeof(float)) {
-            write_f32(value);
+    //! Write the len bytes at data as Base64 with padding, stream_buf::base64_encoded_size(len) characters, with a single bounds check
+    void write_base64(const uint8_t* data, size_t len) {
+        const size_t size = stream_buf::base64_encoded_size(len);
+        if constexpr (IS_FLUSHING) {
+            // split at groups of 4 characters, each encoding 3 bytes
+            write_flushing(size, 4, [data, len](uint8_t* dst, size_t offset, size_t chunk) {
+                const size_t start = offset / 4 * 3;
+                stream_buf::base64_encode(dst, data + start, std::min(chunk / 4 * 3, len - start)); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            });
+        } else if (fits(size)) {
+            stream_buf::base64_encode(_ptr, data, len);
+            advance_unchecked(size);
         }
-    }*/
-
-    // all bulk write operations are bounds checked
-    void write_data(const void* data, size_t len) { if (_ptr + len < _end) { memcpy(_ptr, data, len); _ptr += len; } }
-    void write_string(const char* str) { write_data(str, strlen(str)); }
-    void write_string(const std::string& str) { write_data(str.c_str(), str.size()); }
-    void write_string_with_zero_terminator(const char* string) { write_data(string, strlen(string) + 1); }
-    void write_string_with_zero_terminator(const std::string& str) { write_data(str.c_str(), str.size() + 1); }
+    }
+    constexpr void write_string(const char* str) { write_chars(str, std::char_traits<char>::length(str)); }
+    constexpr void write_string(const std::string& str) { write_chars(str.c_str(), str.size()); }
+    constexpr void write_string_with_zero_terminator(const char* string) { write_chars(string, std::char_traits<char>::length(string) + 1); }
+    constexpr void write_string_with_zero_terminator(const std::string& str) { write_chars(str.c_str(), str.size() + 1); }
 
-    void fill(uint8_t data, size_t len) { if (_ptr + len < _end) { memset(_ptr, data, len); _ptr += len; } }
-    void fill_without_advancing(uint8_t data, size_t len) { if (_ptr + len < _end) { memset(_ptr, data, len); } }
+    constexpr void fill(uint8_t data, size_t len) {
+        if constexpr (IS_FLUSHING) {
+            write_flushing(len, 1, [data](uint8_t* dst, size_t, size_t chunk) { memset(dst, data, chunk); });
+        } else if (fits(len)) {
+            fill_without_advancing(data, len);
+            advance_unchecked(len);
+        }
+    }
+    constexpr void fill_without_advancing(uint8_t data, size_t len) {
+        if (_ptr + len < _end) {
+            if (std::is_constant_evaluated()) {
+                std::fill_n(_ptr, len, data);
+            } else {
+                memset(_ptr, data, len);
+            }
+        }
+    }
 
+protected:
+    template <typename Writer, typename T, stream_buf::Endian E>
+    friend class stream_buf::LengthPrefix; // to record an unpatchable length field as an overflow
+    //! advance _ptr without bounds checking, folding the bytes advanced over into the checksum
+    constexpr void advance_unchecked(size_t len) {
+        if constexpr (HAS_CHECKSUM) { _checksum->update(_ptr, len); }
+        _ptr += len;
+    }
+    static constexpr uint64_t magnitude(int64_t value) { return (value < 0) ? 0ULL - static_cast<uint64_t>(value) : static_cast<uint64_t>(value); }
+    constexpr void write_decimal(uint64_t value, bool negative) {
+        const size_t sign = negative ? 1 : 0;
+        const size_t digits = stream_buf::decimal_size(value);
+        if constexpr (!IS_UNCHECKED) {
+            if (!fits(sign + digits)) {
+                return;
+            }
+        }
+        _ptr[0] = '-'; // overwritten by the first digit if not negative
+        stream_buf::encode_decimal(_ptr + sign, value, digits); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        advance_unchecked(sign + digits);
+    }
+    constexpr void write_hex(uint64_t value, size_t digits) {
+        if constexpr (!IS_UNCHECKED) {
+            if (!fits(digits)) {
+                return;
+            }
+        }
+        stream_buf::encode_hex(_ptr, value, digits, bytes_remaining());
+        advance_unchecked(digits);
+    }
+    constexpr void write_fixed(uint64_t value, bool negative, size_t decimals) {
+        if (decimals == 0) {
+            write_decimal(value, negative);
+            return;
+        }
+        const size_t sign = negative ? 1 : 0;
+        const uint64_t integer = value / stream_buf::POWERS_OF_10[decimals];
+        const size_t digits = stream_buf::decimal_size(integer);
+        if constexpr (!IS_UNCHECKED) {
+            if (!fits(sign + digits + 1 + decimals)) {
+                return;
+            }
+        }
+        // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        _ptr[0] = '-';
+        stream_buf::encode_decimal(_ptr + sign, integer, digits);
+        _ptr[sign + digits] = '.';
+        stream_buf::encode_decimal(_ptr + sign + digits + 1, value - integer * stream_buf::POWERS_OF_10[decimals], decimals);
+        // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        advance_unchecked(sign + digits + 1 + decimals);
+    }
+    //! write len chars, in constant expressions chars cannot be copied as bytes, so they are converted one at a time
+    constexpr void write_chars(const char* str, size_t len) {
+        if (!std::is_constant_evaluated()) {
+            write_data(str, len);
+        } else if (fits(len)) {
+            for (size_t ii = 0; ii < len; ++ii) { _ptr[ii] = static_cast<uint8_t>(str[ii]); } // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            advance_unchecked(len);
+        }
+    }
+    /*!
+    returns true if len bytes fit in the buffer, if they do not then an overflow is recorded for the Sticky policy.
+    For the Flushing policy the buffer is flushed to make room.
+    */
+    constexpr bool fits(size_t len) {
+        if constexpr (IS_COUNTING) {
+            ++_bounds.checks;
+        }
+        if (_ptr + len < _end) {
+            return true;
+        }
+        if constexpr (IS_FLUSHING) {
+            return flush() && _ptr + len < _end;
+        }
+        record_overflow();
+        return false;
+    }
+    /*!
+    For the Flushing policy, write len bytes in chunks of a multiple of granularity bytes, flushing whenever the buffer is full.
+    write_chunk(dst, offset, chunk) writes the chunk bytes starting at offset into dst.
+    Stops early if the sink fails or the buffer cannot hold granularity bytes.
+    */
+    template <typename F>
+    constexpr void write_flushing(size_t len, size_t granularity, F write_chunk) {
+        for (size_t offset = 0; offset < len;) {
+            const size_t chunk = std::min(len - offset, bytes_remaining()) / granularity * granularity;
+            if (chunk == 0) {
+                if (!flush() || bytes_remaining() < granularity) {
+                    return;
+                }
+                continue;
+            }
+            write_chunk(_ptr, offset, chunk);
+            advance_unchecked(chunk);
+            offset += chunk;
+        }
+    }
+    //! for the Sticky policy, record the first overflow
+    constexpr void record_overflow() {
+        if constexpr (IS_STICKY) {
+            if (_bounds.end_offset == 0) {
+                _bounds.end_offset = static_cast<size_t>(_end - _begin);
+                _end = _ptr + 1; // treat the buffer as full, so all subsequent reads and writes fail
+            }
+        }
+    }
 protected:
     uint8_t* _ptr; // data pointer must be first
     uint8_t* const _begin;
     uint8_t* _end; // points to byte after the end of the buffer, as is conventional
+    [[no_unique_address]] std::conditional_t<HAS_CHECKSUM, Checksum*, stream_buf::NoChecksum> _checksum {};
+    [[no_unique_address]] BoundsPolicy _bounds {};
+};
+
+namespace stream_buf {
+/*!
+Scoped guard for a length prefixed nested message, see StreamBufWriterT::length_prefix().
+Guards may be nested.
+
+close() fills in the length field and returns false if it cannot be filled in: because there was insufficient space
+for the field, because for the Flushing policy the field was flushed before the guard was closed,
+or because the length does not fit in T. In that case the field is left unchanged, and for the Sticky policy an overflow is recorded.
+If close() has not been called then the guard is closed when it goes out of scope, so use overflowed() to detect failure.
+*/
+template <typename Writer, typename T, Endian E>
+class LengthPrefix {
+public:
+    constexpr explicit LengthPrefix(Writer& writer) : _writer(writer), _placeholder(writer.template reserve_placeholder<T, E>()), _start(position()) {}
+    constexpr ~LengthPrefix() { close(); }
+    LengthPrefix(const LengthPrefix&) = delete;
+    LengthPrefix& operator=(const LengthPrefix&) = delete;
+    LengthPrefix(LengthPrefix&&) = delete;
+    LengthPrefix& operator=(LengthPrefix&&) = delete;
+
+    //! fill in the length field, returns false if it cannot be filled in. Subsequent calls return the same result.
+    constexpr bool close() {
+        if (_start < FAILED) {
+            const size_t len = position() - _start;
+            const bool patched = len <= std::numeric_limits<T>::max() && _writer.patch(_placeholder, static_cast<T>(len));
+            if (!patched) {
+                _writer.record_overflow();
+            }
+            _start = patched ? CLOSED : FAILED;
+        }
+        return _start == CLOSED;
+    }
+private:
+    //! position in the stream, which unlike bytes_written() does not restart after a flush
+    constexpr size_t position() const { return _writer.bytes_flushed() + _writer.bytes_written(); }
+private:
+    static constexpr size_t CLOSED = SIZE_MAX; //!< value of _start once the field has been filled in
+    static constexpr size_t FAILED = SIZE_MAX - 1; //!< value of _start once filling in the field has failed
+    Writer& _writer;
+    Placeholder<T, E> _placeholder;
+    size_t _start; //!< position after the length field, or CLOSED or FAILED
 };
+
+/*!
+Build a frame of N bytes at compile time, so that fixed frames may be placed in flash rather than being rebuilt on every send.
+build(writer) is called with a StreamBufWriter over the frame, eg
+    constexpr auto FRAME = stream_buf::make_frame<4>([](StreamBufWriter& sbw) { sbw.write_u8(0x24); sbw.write_u8(0x4D); sbw.write_u16(0); });
+The writer requires its buffer to have a byte beyond the end, so the frame is built in a buffer of N + 1 bytes and then copied.
+Writing more than N bytes is a compile time error.
+*/
+template <size_t N, typename F>
+constexpr std::array<uint8_t, N> make_frame(F build) {
+    std::array<uint8_t, N + 1> buf {};
+    StreamBufWriter sbw(&buf[0], N);
+    build(sbw);
+    std::array<uint8_t, N> frame {};
+    std::copy_n(buf.begin(), N, frame.begin());
+    return frame;
+}
+} // namespace stream_buf
@@ -0,0 +1,1027 @@
+#include "stream_buf_byte_stuffing.h"
+#include "stream_buf_lz.h"
+#include "stream_buf_mapped_reader.h"
+#include "stream_buf_msp.h"
+#include "stream_buf_reader.h"
+#include "stream_buf_schema.h"
+#include "stream_buf_shared.h"
+#include "stream_buf_time_series.h"
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <unity.h>
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+/*!
+Benchmarks are run as unit tests: they check that the compared paths produce identical output
+and report timings using TEST_MESSAGE. Timings are informational only and are not asserted.
+*/
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers,cppcoreguidelines-pro-bounds-pointer-arithmetic,readability-magic-numbers)
+template <typename F>
+static double time_ns_per_iteration(size_t iterations, F&& fn)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t ii = 0; ii < iterations; ++ii) {
+        fn(ii);
+    }
+    const auto finish = std::chrono::steady_clock::now();
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(finish - start).count()) / static_cast<double>(iterations);
+}
+
+using Message = std::array<char, 128>;
+
+//! Returns the text formatted by snprintf into message, len is its return value. Fails rather than using truncated text.
+static const char* checked_text(const Message& message, int len)
+{
+    TEST_ASSERT_TRUE(len >= 0 && static_cast<size_t>(len) < message.size());
+    return &message[0];
+}
+
+//! Emit a message formatted by snprintf, len is its return value. Fails rather than reporting a truncated message.
+static void report_message(const Message& message, int len)
+{
+    TEST_MESSAGE(checked_text(message, len));
+}
+
+static void report(const char* name, double ns_per_iteration)
+{
+    Message message;
+    report_message(message, snprintf(&message[0], message.size(), "%-40s %8.2f ns/iteration", name, ns_per_iteration));
+}
+
+static void report_size(const char* name, size_t size)
+{
+    Message message;
+    report_message(message, snprintf(&message[0], message.size(), "%-40s %8zu bytes", name, size));
+}
+
+static void report_throughput(const char* name, size_t bytes, double ns_per_iteration)
+{
+    Message message;
+    report_message(message, snprintf(&message[0], message.size(), "%-40s %8.1f MB/s", name, static_cast<double>(bytes) * 1000.0 / ns_per_iteration));
+}
+
+//! xorshift pseudo random number generator, so that benchmark data is reproducible
+class Random {
+public:
+    uint32_t next() {
+        _state ^= _state << 13;
+        _state ^= _state >> 17;
+        _state ^= _state << 5;
+        return _state;
+    }
+private:
+    uint32_t _state {2463534242U};
+};
+
+/*!
+Telemetry message with 7 fields, 18 bytes.
+Written using the checked functions this requires 7 bounds checks, using reserve() it requires 1.
+The functions are templates so that the checks may be counted using StreamBufWriterCounting and StreamBufReaderCounting.
+*/
+enum { TELEMETRY_MESSAGE_SIZE = 18 };
+
+template <typename Writer>
+static void write_telemetry_checked(Writer& sbuf, uint32_t value)
+{
+    sbuf.write_u8_checked(0x55);
+    sbuf.write_u8_checked(static_cast<uint8_t>(value));
+    sbuf.write_u16_checked(static_cast<uint16_t>(value));
+    sbuf.write_u32_checked(value);
+    sbuf.write_u16_big_endian_checked(static_cast<uint16_t>(value >> 16));
+    sbuf.write_u32_big_endian_checked(value ^ 0xA5A5A5A5U);
+    sbuf.write_u32_checked(value * 3);
+}
+
+template <typename Writer>
+static void write_telemetry_reserved(Writer& sbuf, uint32_t value)
+{
+    StreamBufWriter message = sbuf.reserve(TELEMETRY_MESSAGE_SIZE);
+    if (message.bytes_remaining() < TELEMETRY_MESSAGE_SIZE) {
+        return;
+    }
+    message.write_u8(0x55);
+    message.write_u8(static_cast<uint8_t>(value));
+    message.write_u16(static_cast<uint16_t>(value));
+    message.write_u32(value);
+    message.write_u16_big_endian(static_cast<uint16_t>(value >> 16));
+    message.write_u32_big_endian(value ^ 0xA5A5A5A5U);
+    message.write_u32(value * 3);
+    sbuf.commit(message);
+}
+
+template <typename Reader>
+static uint32_t read_telemetry_checked(Reader& sbuf)
+{
+    uint32_t sum = sbuf.read_u8_checked();
+    sum += sbuf.read_u8_checked();
+    sum += sbuf.read_u16_checked();
+    sum += sbuf.read_u32_checked();
+    sum += sbuf.read_u16_big_endian_checked();
+    sum += sbuf.read_u32_big_endian_checked();
+    sum += sbuf.read_u32_checked();
+    return sum;
+}
+
+template <typename Reader>
+static uint32_t read_telemetry_required(Reader& sbuf)
+{
+    if (!sbuf.require(TELEMETRY_MESSAGE_SIZE)) {
+        return 0;
+    }
+    uint32_t sum = sbuf.read_u8();
+    sum += sbuf.read_u8();
+    sum += sbuf.read_u16();
+    sum += sbuf.read_u32();
+    sum += sbuf.read_u16_big_endian();
+    sum += sbuf.read_u32_big_endian();
+    sum += sbuf.read_u32();
+    return sum;
+}
+
+void test_benchmark_reserve()
+{
+    enum { ITERATIONS = 20000, MESSAGES = 32, BUF_SIZE = MESSAGES * TELEMETRY_MESSAGE_SIZE };
+    std::array<uint8_t, BUF_SIZE + 1> buf_checked {};
+    std::array<uint8_t, BUF_SIZE + 1> buf_reserved {};
+    StreamBufWriter checked(&buf_checked[0], BUF_SIZE);
+    StreamBufWriter reserved(&buf_reserved[0], BUF_SIZE);
+
+    for (uint32_t ii = 0; ii < MESSAGES; ++ii) {
+        write_telemetry_checked(checked, ii * 0x01010101U);
+        write_telemetry_reserved(reserved, ii * 0x01010101U);
+    }
+    TEST_ASSERT_EQUAL(BUF_SIZE, checked.bytes_written());
+    TEST_ASSERT_EQUAL(BUF_SIZE, reserved.bytes_written());
+    TEST_ASSERT_EQUAL_MEMORY(&buf_checked[0], &buf_reserved[0], BUF_SIZE);
+
+    uint32_t sum_checked = 0;
+    uint32_t sum_required = 0;
+    StreamBufReader reader_checked(&buf_checked[0], BUF_SIZE);
+    StreamBufReader reader_required(&buf_checked[0], BUF_SIZE);
+    for (uint32_t ii = 0; ii < MESSAGES; ++ii) {
+        sum_checked += read_telemetry_checked(reader_checked);
+        sum_required += read_telemetry_required(reader_required);
+    }
+    TEST_ASSERT_EQUAL(sum_checked, sum_required);
+
+    // count the bounds checks of a single message
+    std::array<uint8_t, TELEMETRY_MESSAGE_SIZE + 1> buf_count {};
+    StreamBufWriterCounting count_write_checked(&buf_count[0], TELEMETRY_MESSAGE_SIZE);
+    write_telemetry_checked(count_write_checked, 1);
+    StreamBufWriterCounting count_write_reserved(&buf_count[0], TELEMETRY_MESSAGE_SIZE);
+    write_telemetry_reserved(count_write_reserved, 1);
+    StreamBufReaderCounting count_read_checked(&buf_count[0], TELEMETRY_MESSAGE_SIZE);
+    read_telemetry_checked(count_read_checked);
+    StreamBufReaderCounting count_read_required(&buf_count[0], TELEMETRY_MESSAGE_SIZE);
+    read_telemetry_required(count_read_required);
+    Message message;
+    report_message(message, snprintf(&message[0], message.size(), "bounds checks per 7 field message: write checked %zu, reserve %zu, read checked %zu, require %zu",
+        count_write_checked.bounds_checks(), count_write_reserved.bounds_checks(), count_read_checked.bounds_checks(), count_read_required.bounds_checks()));
+    TEST_ASSERT_EQUAL(7, count_write_checked.bounds_checks());
+    TEST_ASSERT_EQUAL(1, count_write_reserved.bounds_checks());
+    TEST_ASSERT_EQUAL(7, count_read_checked.bounds_checks());
+    TEST_ASSERT_EQUAL(1, count_read_required.bounds_checks());
+
+    report("write telemetry checked", time_ns_per_iteration(ITERATIONS, [&](size_t ii) {
+        checked.reset();
+        for (uint32_t jj = 0; jj < MESSAGES; ++jj) { write_telemetry_checked(checked, static_cast<uint32_t>(ii) + jj); }
+    }));
+    report("write telemetry reserve", time_ns_per_iteration(ITERATIONS, [&](size_t ii) {
+        reserved.reset();
+        for (uint32_t jj = 0; jj < MESSAGES; ++jj) { write_telemetry_reserved(reserved, static_cast<uint32_t>(ii) + jj); }
+    }));
+    report("read telemetry checked", time_ns_per_iteration(ITERATIONS, [&](size_t) {
+        reader_checked.reset();
+        for (uint32_t jj = 0; jj < MESSAGES; ++jj) { sum_checked += read_telemetry_checked(reader_checked); }
+    }));
+    report("read telemetry require", time_ns_per_iteration(ITERATIONS, [&](size_t) {
+        reader_required.reset();
+        for (uint32_t jj = 0; jj < MESSAGES; ++jj) { sum_required += read_telemetry_required(reader_required); }
+    }));
+    TEST_ASSERT_EQUAL(sum_checked, sum_required);
+    TEST_ASSERT_EQUAL_MEMORY(&buf_checked[0], &buf_reserved[0], BUF_SIZE);
+}
+//! the telemetry message as a struct, with a schema matching write_telemetry_reserved()
+struct Telemetry {
+    uint8_t sync;
+    uint8_t value_u8;
+    uint16_t value_u16;
+    uint32_t value;
+    uint32_t value_high; // sent as uint16_t
+    uint32_t value_xor;
+    uint32_t value_times_3;
+};
+
+using TelemetrySchema = stream_buf::Schema<
+    stream_buf::Field<&Telemetry::sync>,
+    stream_buf::Field<&Telemetry::value_u8>,
+    stream_buf::Field<&Telemetry::value_u16>,
+    stream_buf::Field<&Telemetry::value>,
+    stream_buf::Field<&Telemetry::value_high, uint16_t, stream_buf::Endian::BIG>,
+    stream_buf::FieldBigEndian<&Telemetry::value_xor>,
+    stream_buf::Field<&Telemetry::value_times_3>>;
+
+static_assert(TelemetrySchema::WIRE_SIZE == TELEMETRY_MESSAGE_SIZE);
+
+static void write_telemetry_schema(StreamBufWriter& sbuf, uint32_t value)
+{
+    const Telemetry telemetry {
+        0x55, static_cast<uint8_t>(value), static_cast<uint16_t>(value), value,
+        value >> 16, value ^ 0xA5A5A5A5U, value * 3
+    };
+    TelemetrySchema::encode(sbuf, telemetry);
+}
+
+static uint32_t read_telemetry_schema(StreamBufReader& sbuf)
+{
+    Telemetry telemetry {};
+    if (!TelemetrySchema::decode(sbuf, telemetry)) {
+        return 0;
+    }
+    return telemetry.sync + telemetry.value_u8 + telemetry.value_u16 + telemetry.value
+        + telemetry.value_high + telemetry.value_xor + telemetry.value_times_3;
+}
+
+void test_benchmark_schema()
+{
+    enum { ITERATIONS = 20000, MESSAGES = 32, BUF_SIZE = MESSAGES * TELEMETRY_MESSAGE_SIZE };
+    std::array<uint8_t, BUF_SIZE + 1> buf_hand {};
+    std::array<uint8_t, BUF_SIZE + 1> buf_schema {};
+    StreamBufWriter hand(&buf_hand[0], BUF_SIZE);
+    StreamBufWriter schema(&buf_schema[0], BUF_SIZE);
+
+    for (uint32_t ii = 0; ii < MESSAGES; ++ii) {
+        write_telemetry_reserved(hand, ii * 0x01010101U);
+        write_telemetry_schema(schema, ii * 0x01010101U);
+    }
+    TEST_ASSERT_EQUAL(BUF_SIZE, schema.bytes_written());
+    TEST_ASSERT_EQUAL_MEMORY(&buf_hand[0], &buf_schema[0], BUF_SIZE);
+
+    uint32_t sum_hand = 0;
+    uint32_t sum_schema = 0;
+    StreamBufReader reader_hand(&buf_hand[0], BUF_SIZE);
+    StreamBufReader reader_schema(&buf_schema[0], BUF_SIZE);
+    report("write telemetry hand-written reserve", time_ns_per_iteration(ITERATIONS, [&](size_t ii) {
+        hand.reset();
+        for (uint32_t jj = 0; jj < MESSAGES; ++jj) { write_telemetry_reserved(hand, static_cast<uint32_t>(ii) + jj); }
+    }));
+    report("write telemetry schema", time_ns_per_iteration(ITERATIONS, [&](size_t ii) {
+        schema.reset();
+        for (uint32_t jj = 0; jj < MESSAGES; ++jj) { write_telemetry_schema(schema, static_cast<uint32_t>(ii) + jj); }
+    }));
+    TEST_ASSERT_EQUAL_MEMORY(&buf_hand[0], &buf_schema[0], BUF_SIZE);
+    report("read telemetry hand-written require", time_ns_per_iteration(ITERATIONS, [&](size_t) {
+        reader_hand.reset();
+        for (uint32_t jj = 0; jj < MESSAGES; ++jj) { sum_hand += read_telemetry_required(reader_hand); }
+    }));
+    report("read telemetry schema", time_ns_per_iteration(ITERATIONS, [&](size_t) {
+        reader_schema.reset();
+        for (uint32_t jj = 0; jj < MESSAGES; ++jj) { sum_schema += read_telemetry_schema(reader_schema); }
+    }));
+    TEST_ASSERT_EQUAL(sum_hand, sum_schema);
+}
+void test_benchmark_varint()
+{
+    enum { ITERATIONS = 2000, VALUES = 1024 };
+    // gyro-like values of small magnitude, a slowly increasing timestamp, and uniformly distributed 32-bit values
+    std::array<int32_t, VALUES> gyro {};
+    std::array<uint32_t, VALUES> timestamp_delta {};
+    std::array<uint32_t, VALUES> uniform {};
+    Random random;
+    for (size_t ii = 0; ii < VALUES; ++ii) {
+        gyro[ii] = static_cast<int32_t>(random.next() % 1001) - 500;
+        timestamp_delta[ii] = 900 + random.next() % 200;
+        uniform[ii] = random.next();
+    }
+
+    std::array<uint8_t, VALUES * 5 + 1> buf {};
+    StreamBufWriter sbuf(&buf[0], buf.size() - 1);
+
+    const auto benchmark = [&](const char* name, auto& values, auto write_fixed, auto write_varint, auto read_fixed, auto read_varint) {
+        Message label;
+        int64_t sum_fixed = 0;
+        int64_t sum_varint = 0;
+
+        sbuf.reset();
+        for (auto value : values) { write_fixed(sbuf, value); }
+        const size_t fixed_size = sbuf.bytes_written();
+        sbuf.reset();
+        for (auto value : values) { write_varint(sbuf, value); }
+        const size_t varint_size = sbuf.bytes_written();
+        StreamBufReader sbufReader(sbuf.reader());
+        for (auto value : values) { TEST_ASSERT_EQUAL_INT64(value, read_varint(sbufReader)); }
+        TEST_ASSERT_EQUAL(0, sbufReader.bytes_remaining());
+
+        report_size(checked_text(label, snprintf(&label[0], label.size(), "%s fixed", name)), fixed_size);
+        report_size(checked_text(label, snprintf(&label[0], label.size(), "%s varint", name)), varint_size);
+        report(checked_text(label, snprintf(&label[0], label.size(), "%s write fixed", name)), time_ns_per_iteration(ITERATIONS, [&](size_t) {
+            sbuf.reset();
+            for (auto value : values) { write_fixed(sbuf, value); }
+        }));
+        StreamBufReader fixedReader(&buf[0], fixed_size);
+        report(checked_text(label, snprintf(&label[0], label.size(), "%s read fixed", name)), time_ns_per_iteration(ITERATIONS, [&](size_t) {
+            fixedReader.reset();
+            for (size_t ii = 0; ii < VALUES; ++ii) { sum_fixed += read_fixed(fixedReader); }
+        }));
+        report(checked_text(label, snprintf(&label[0], label.size(), "%s write varint", name)), time_ns_per_iteration(ITERATIONS, [&](size_t) {
+            sbuf.reset();
+            for (auto value : values) { write_varint(sbuf, value); }
+        }));
+        StreamBufReader varintReader(&buf[0], varint_size);
+        report(checked_text(label, snprintf(&label[0], label.size(), "%s read varint", name)), time_ns_per_iteration(ITERATIONS, [&](size_t) {
+            varintReader.reset();
+            for (size_t ii = 0; ii < VALUES; ++ii) { sum_varint += read_varint(varintReader); }
+        }));
+        TEST_ASSERT_EQUAL_INT64(sum_fixed, sum_varint);
+    };
+
+    benchmark("gyro s32", gyro,
+        [](StreamBufWriter& w, int32_t v) { w.write_s32(v); },
+        [](StreamBufWriter& w, int32_t v) { w.write_varint_s32(v); },
+        [](StreamBufReader& r) { return r.read_s32(); },
+        [](StreamBufReader& r) { return r.read_varint_s32(); });
+    benchmark("timestamp delta u32", timestamp_delta,
+        [](StreamBufWriter& w, uint32_t v) { w.write_u32(v); },
+        [](StreamBufWriter& w, uint32_t v) { w.write_varint_u32(v); },
+        [](StreamBufReader& r) { return r.read_u32(); },
+        [](StreamBufReader& r) { return r.read_varint_u32(); });
+    benchmark("uniform u32", uniform,
+        [](StreamBufWriter& w, uint32_t v) { w.write_u32(v); },
+        [](StreamBufWriter& w, uint32_t v) { w.write_varint_u32(v); },
+        [](StreamBufReader& r) { return r.read_u32(); },
+        [](StreamBufReader& r) { return r.read_varint_u32(); });
+}
+void test_benchmark_array()
+{
+    enum { ITERATIONS = 20000, COUNT = 512 };
+    std::array<int16_t, COUNT> imu_samples {};
+    std::array<uint32_t, COUNT> motor_outputs {};
+    Random random;
+    for (size_t ii = 0; ii < COUNT; ++ii) {
+        imu_samples[ii] = static_cast<int16_t>(random.next());
+        motor_outputs[ii] = random.next();
+    }
+    std::array<uint8_t, COUNT * sizeof(uint32_t) + 1> buf_loop {};
+    std::array<uint8_t, COUNT * sizeof(uint32_t) + 1> buf_array {};
+    StreamBufWriter loop(&buf_loop[0], buf_loop.size() - 1);
+    StreamBufWriter array(&buf_array[0], buf_array.size() - 1);
+
+    report("write s16 big endian, per element", time_ns_per_iteration(ITERATIONS, [&](size_t) {
+        loop.reset();
+        for (auto value : imu_samples) { loop.write_s16_big_endian(value); }
+    }));
+    report("write s16 big endian, write_array", time_ns_per_iteration(ITERATIONS, [&](size_t) {
+        array.reset();
+        array.write_array<int16_t, stream_buf::Endian::BIG>(&imu_samples[0], COUNT);
+    }));
+    TEST_ASSERT_EQUAL_MEMORY(&buf_loop[0], &buf_array[0], COUNT * sizeof(int16_t));
+
+    report("write u32 big endian, per element", time_ns_per_iteration(ITERATIONS, [&](size_t) {
+        loop.reset();
+        for (auto value : motor_outputs) { loop.write_u32_big_endian(value); }
+    }));
+    report("write u32 big endian, write_array", time_ns_per_iteration(ITERATIONS, [&](size_t) {
+        array.reset();
+        array.write_array<uint32_t, stream_buf::Endian::BIG>(&motor_outputs[0], COUNT);
+    }));
+    report("write u32 little endian, write_array", time_ns_per_iteration(ITERATIONS, [&](size_t) {
+        array.reset();
+        array.write_array(&motor_outputs[0], COUNT);
+    }));
+
+    std::array<uint32_t, COUNT> motor_outputs_read {};
+    StreamBufReader reader(&buf_loop[0], COUNT * sizeof(uint32_t));
+    report("read u32 big endian, per element", time_ns_per_iteration(ITERATIONS, [&](size_t) {
+        reader.reset();
+        for (auto& value : motor_outputs_read) { value = reader.read_u32_big_endian(); }
+    }));
+    report("read u32 big endian, read_array", time_ns_per_iteration(ITERATIONS, [&](size_t) {
+        reader.reset();
+        reader.read_array<uint32_t, stream_buf::Endian::BIG>(&motor_outputs_read[0], COUNT);
+    }));
+    TEST_ASSERT_EQUAL_MEMORY(&motor_outputs[0], &motor_outputs_read[0], sizeof(motor_outputs));
+}
+
+static void write_record(StreamBufWriter& sbuf, uint32_t id, uint32_t seq)
+{
+    sbuf.write_u32(id);
+    sbuf.write_u32(seq);
+    sbuf.write_u64(static_cast<uint64_t>(seq) * 0x9E3779B97F4A7C15ULL);
+    sbuf.write_u64(static_cast<uint64_t>(id) << 32 | seq);
+}
+
+void test_benchmark_shared()
+{
+    enum { RECORDS = 200000, RECORD_SIZE = 24, THREADS_MAX = 8 };
+    std::vector<uint8_t> buf_mutex(THREADS_MAX * RECORDS * RECORD_SIZE + 1);
+    std::vector<uint8_t> buf_shared(THREADS_MAX * RECORDS * (RECORD_SIZE + StreamBufShared::HEADER_SIZE));
+
+    const auto run = [](size_t threads, auto&& producer) {
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> producers;
+        for (size_t id = 0; id < threads; ++id) {
+            producers.emplace_back(producer, static_cast<uint32_t>(id));
+        }
+        for (auto& thread : producers) {
+            thread.join();
+        }
+        const auto finish = std::chrono::steady_clock::now();
+        return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(finish - start).count()) / static_cast<double>(threads * RECORDS);
+    };
+
+    Message label;
+    for (size_t threads = 1; threads <= THREADS_MAX; threads *= 2) {
+        StreamBufWriter sbuf(&buf_mutex[0], buf_mutex.size() - 1);
+        std::mutex mutex;
+        report(checked_text(label, snprintf(&label[0], label.size(), "mutex writer, %zu threads, per record", threads)), run(threads, [&](uint32_t id) {
+            for (uint32_t seq = 0; seq < RECORDS; ++seq) {
+                const std::lock_guard<std::mutex> lock(mutex);
+                write_record(sbuf, id, seq);
+            }
+        }));
+        TEST_ASSERT_EQUAL(threads * RECORDS * RECORD_SIZE, sbuf.bytes_written());
+
+        StreamBufShared shared(&buf_shared[0], buf_shared.size());
+        report(checked_text(label, snprintf(&label[0], label.size(), "shared slices, %zu threads, per record", threads)), run(threads, [&](uint32_t id) {
+            for (uint32_t seq = 0; seq < RECORDS; ++seq) {
+                StreamBufWriter record = shared.reserve(RECORD_SIZE);
+                write_record(record, id, seq);
+                shared.commit(record);
+            }
+        }));
+        size_t bytes = 0;
+        TEST_ASSERT_EQUAL(threads * RECORDS, shared.for_each_published([&bytes](StreamBufReader& record) { bytes += record.bytes_remaining(); }));
+        TEST_ASSERT_EQUAL(threads * RECORDS * RECORD_SIZE, bytes);
+    }
+}
+
+/*!
+Reference MSP parser, as commonly written: one byte at a time, updating the checksum and copying each payload byte as it arrives.
+*/
+class MspNaiveParser {
+public:
+    template <typename F>
+    size_t parse(const uint8_t* data, size_t len, F&& on_frame) {
+        size_t frames = 0;
+        for (size_t ii = 0; ii < len; ++ii) {
+            const uint8_t c = data[ii];
+            switch (_state) {
+            case 0: _state = (c == '$') ? 1 : 0; break;
+            case 1: _v2 = (c == 'X'); _state = (c == 'M' || c == 'X') ? 2 : 0; break;
+            case 2: _state = (c == '<' || c == '>' || c == '!') ? 3 : 0; _header_len = 0; _xor = 0; _crc = 0; break;
+            case 3:
+                _header[_header_len++] = c;
+                _xor ^= c;
+                _crc = crc8_dvb_s2(_crc, c);
+                if (_header_len == (_v2 ? 5U : 2U)) {
+                    _size = _v2 ? static_cast<size_t>(_header[3] | (_header[4] << 8)) : _header[0];
+                    _len = 0;
+                    _state = (_size > _buf.size()) ? 0 : (_size == 0 ? 5 : 4);
+                }
+                break;
+            case 4:
+                _buf[_len++] = c;
+                _xor ^= c;
+                _crc = crc8_dvb_s2(_crc, c);
+                if (_len == _size) { _state = 5; }
+                break;
+            default:
+                if (c == (_v2 ? _crc : _xor)) {
+                    on_frame(_v2 ? static_cast<uint32_t>(_header[1] | (_header[2] << 8)) : _header[1], &_buf[0], _size);
+                    ++frames;
+                }
+                _state = 0;
+                break;
+            }
+        }
+        return frames;
+    }
+private:
+    static uint8_t crc8_dvb_s2(uint8_t crc, uint8_t c) {
+        crc ^= c;
+        for (int ii = 0; ii < 8; ++ii) {
+            crc = (crc & 0x80U) ? static_cast<uint8_t>((crc << 1U) ^ 0xD5U) : static_cast<uint8_t>(crc << 1U);
+        }
+        return crc;
+    }
+private:
+    size_t _state {0};
+    size_t _header_len {0};
+    size_t _size {0};
+    size_t _len {0};
+    std::array<uint8_t, 256> _buf {};
+    std::array<uint8_t, 5> _header {};
+    uint8_t _xor {0};
+    uint8_t _crc {0};
+    bool _v2 {false};
+};
+
+void test_benchmark_msp()
+{
+    enum { ITERATIONS = 200, FRAMES = 2000 };
+    // a recorded stream of mixed v1 and v2 frames of varying size, with line noise between some of them
+    std::vector<uint8_t> stream(FRAMES * (stream_buf::MSP_V2_OVERHEAD + 64 + 4));
+    StreamBufWriter sbw(&stream[0], stream.size());
+    std::array<uint8_t, 64> payload {};
+    Random random;
+    size_t frames = 0;
+    for (size_t ii = 0; ii < FRAMES; ++ii) {
+        for (auto& byte : payload) { byte = static_cast<uint8_t>(random.next()); }
+        const size_t len = random.next() % payload.size();
+        const uint32_t r = random.next();
+        if (r % 8 == 0) {
+            sbw.write_u32(r & 0x1F1F1F1FU); // noise, without any '$' that could start a spurious frame
+        }
+        const bool ok = (r & 0x10U)
+            ? stream_buf::write_msp_v2(sbw, stream_buf::MspDirection::RESPONSE, static_cast<uint16_t>(r >> 16U), &payload[0], len)
+            : stream_buf::write_msp_v1(sbw, stream_buf::MspDirection::RESPONSE, static_cast<uint8_t>(r >> 16U), &payload[0], len);
+        TEST_ASSERT_TRUE(ok);
+        ++frames;
+    }
+    const size_t size = sbw.bytes_written();
+
+    Message label;
+    for (const size_t chunk_size : { size_t{1}, size_t{16}, size }) {
+        uint64_t sum_naive = 0;
+        size_t frames_naive = 0;
+        report_throughput(checked_text(label, snprintf(&label[0], label.size(), "MSP naive parser, %zu byte chunks", chunk_size)), size, time_ns_per_iteration(ITERATIONS, [&](size_t) {
+            MspNaiveParser parser;
+            sum_naive = 0;
+            frames_naive = 0;
+            for (size_t pos = 0; pos < size; pos += chunk_size) {
+                frames_naive += parser.parse(&stream[pos], std::min(chunk_size, size - pos), [&sum_naive](uint32_t command, const uint8_t* data, size_t len) {
+                    sum_naive += command;
+                    for (size_t ii = 0; ii < len; ++ii) { sum_naive += data[ii]; }
+                });
+            }
+        }));
+
+        uint64_t sum_decoder = 0;
+        size_t frames_decoder = 0;
+        report_throughput(checked_text(label, snprintf(&label[0], label.size(), "MspDecoder, %zu byte chunks", chunk_size)), size, time_ns_per_iteration(ITERATIONS, [&](size_t) {
+            std::array<uint8_t, 256> payload_buf;
+            MspDecoder decoder(&payload_buf[0], payload_buf.size());
+            sum_decoder = 0;
+            frames_decoder = 0;
+            for (size_t pos = 0; pos < size; pos += chunk_size) {
+                frames_decoder += decoder.decode(&stream[pos], std::min(chunk_size, size - pos), [&sum_decoder](const stream_buf::MspFrame& frame) {
+                    sum_decoder += frame.command;
+                    for (const uint8_t byte : frame.payload) { sum_decoder += byte; }
+                });
+            }
+        }));
+        TEST_ASSERT_EQUAL(frames, frames_naive);
+        TEST_ASSERT_EQUAL(frames, frames_decoder);
+        TEST_ASSERT_EQUAL_UINT64(sum_naive, sum_decoder);
+    }
+}
+
+//! COBS encoder as commonly written, a byte at a time
+static size_t cobs_encode_bytewise(uint8_t* dst, const uint8_t* src, size_t len)
+{
+    size_t code_pos = 0;
+    size_t out = 1;
+    uint8_t code = 1;
+    for (size_t ii = 0; ii < len; ++ii) {
+        if (src[ii] == 0) {
+            dst[code_pos] = code;
+            code_pos = out++;
+            code = 1;
+            continue;
+        }
+        dst[out++] = src[ii];
+        if (++code == 0xFF) {
+            dst[code_pos] = code;
+            code_pos = out++;
+            code = 1;
+        }
+    }
+    dst[code_pos] = code;
+    dst[out++] = 0;
+    return out;
+}
+
+//! COBS decoder as commonly written, a byte at a time
+static size_t cobs_decode_bytewise(uint8_t* dst, const uint8_t* src, size_t len)
+{
+    size_t out = 0;
+    for (size_t pos = 0; pos < len;) {
+        const uint8_t code = src[pos++];
+        for (uint8_t ii = 1; ii < code; ++ii) {
+            dst[out++] = src[pos++];
+        }
+        if (code != 0xFF && pos < len) {
+            dst[out++] = 0;
+        }
+    }
+    return out;
+}
+
+void test_benchmark_byte_stuffing()
+{
+    enum { ITERATIONS = 2000, SIZE = 16384 };
+    // telemetry-like data: mostly non-zero with occasional zero bytes, and an occasional SLIP special byte
+    std::vector<uint8_t> data(SIZE);
+    Random random;
+    for (auto& byte : data) {
+        const uint32_t r = random.next();
+        byte = (r % 97 == 0) ? 0 : (r % 211 == 0) ? stream_buf::SLIP_END : static_cast<uint8_t>(r | 1U);
+    }
+    std::vector<uint8_t> encoded_bytewise(stream_buf::cobs_max_encoded_size(SIZE) + 1);
+    std::vector<uint8_t> encoded(stream_buf::cobs_max_encoded_size(SIZE) + 1);
+    size_t size_bytewise = 0;
+    report_throughput("COBS encode bytewise", SIZE, time_ns_per_iteration(ITERATIONS, [&](size_t) {
+        size_bytewise = cobs_encode_bytewise(&encoded_bytewise[0], &data[0], SIZE);
+    }));
+    StreamBufWriter sbw(&encoded[0], encoded.size());
+    report_throughput("COBS encode write_cobs", SIZE, time_ns_per_iteration(ITERATIONS, [&](size_t) {
+        sbw.reset();
+        stream_buf::write_cobs(sbw, &data[0], SIZE);
+    }));
+    TEST_ASSERT_EQUAL(size_bytewise, sbw.bytes_written());
+    TEST_ASSERT_EQUAL_MEMORY(&encoded_bytewise[0], &encoded[0], size_bytewise);
+
+    std::vector<uint8_t> decoded(SIZE);
+    report_throughput("COBS decode bytewise", SIZE, time_ns_per_iteration(ITERATIONS, [&](size_t) {
+        cobs_decode_bytewise(&decoded[0], &encoded[0], size_bytewise - 1);
+    }));
+    TEST_ASSERT_EQUAL_MEMORY(&data[0], &decoded[0], SIZE);
+    decoded.assign(SIZE, 0);
+    report_throughput("COBS decode cobs_decode", SIZE, time_ns_per_iteration(ITERATIONS, [&](size_t) {
+        stream_buf::cobs_decode(&decoded[0], &encoded[0], size_bytewise - 1);
+    }));
+    TEST_ASSERT_EQUAL_MEMORY(&data[0], &decoded[0], SIZE);
+    decoded.assign(SIZE, 0);
+    report_throughput("COBS decode CobsDecoder, 64 byte chunks", SIZE, time_ns_per_iteration(ITERATIONS, [&](size_t) {
+        CobsDecoder decoder(&decoded[0], decoded.size());
+        for (size_t pos = 0; pos < size_bytewise; pos += 64) {
+            decoder.decode(&encoded[pos], std::min(size_t{64}, size_bytewise - pos), [](std::span<const uint8_t>) {});
+        }
+    }));
+    TEST_ASSERT_EQUAL_MEMORY(&data[0], &decoded[0], SIZE);
+
+    std::vector<uint8_t> slip(SIZE * 2 + 1);
+    StreamBufWriter sbw_slip(&slip[0], slip.size());
+    report_throughput("SLIP encode write_slip", SIZE, time_ns_per_iteration(ITERATIONS, [&](size_t) {
+        sbw_slip.reset();
+        stream_buf::write_slip(sbw_slip, &data[0], SIZE);
+    }));
+    decoded.assign(SIZE, 0);
+    report_throughput("SLIP decode SlipDecoder, 64 byte chunks", SIZE, time_ns_per_iteration(ITERATIONS, [&](size_t) {
+        SlipDecoder decoder(&decoded[0], decoded.size());
+        for (size_t pos = 0; pos < sbw_slip.bytes_written(); pos += 64) {
+            decoder.decode(&slip[pos], std::min(size_t{64}, sbw_slip.bytes_written() - pos), [](std::span<const uint8_t>) {});
+        }
+    }));
+    TEST_ASSERT_EQUAL_MEMORY(&data[0], &decoded[0], SIZE);
+}
+
+void test_benchmark_time_series()
+{
+    enum { PASSES = 20, FRAMES = 8000, FIELDS = 11, ABSOLUTE_FRAME_SIZE = 4 + 10 * 2 };
+    // synthetic IMU trace at 8kHz: timestamp, gyro, accelerometer and motors, smooth signals with sensor noise
+    std::vector<std::array<int32_t, FIELDS>> trace(FRAMES);
+    Random random;
+    uint32_t time_us = 0;
+    for (size_t ii = 0; ii < FRAMES; ++ii) {
+        const auto noise = [&random](uint32_t amplitude) { return static_cast<int32_t>(random.next() % (2 * amplitude + 1)) - static_cast<int32_t>(amplitude); };
+        const double t = static_cast<double>(ii) / 8000.0;
+        time_us += 125 + static_cast<uint32_t>(noise(1));
+        auto& frame = trace[ii];
+        frame[0] = static_cast<int32_t>(time_us);
+        for (size_t axis = 0; axis < 3; ++axis) {
+            const double phase = static_cast<double>(axis) * 2.1;
+            frame[1 + axis] = static_cast<int16_t>(800.0 * sin(2 * M_PI * 3.0 * t + phase) + noise(3));
+            frame[4 + axis] = static_cast<int16_t>(2048.0 + 300.0 * sin(2 * M_PI * 0.5 * t + phase) + noise(6));
+        }
+        for (size_t motor = 0; motor < 4; ++motor) {
+            frame[7 + motor] = static_cast<int32_t>(1400.0 + 200.0 * sin(2 * M_PI * 1.0 * t + static_cast<double>(motor)) + noise(2));
+        }
+    }
+    using stream_buf::Predictor;
+    const std::array<Predictor, FIELDS> predictors = {
+        Predictor::LINEAR,
+        Predictor::PREVIOUS, Predictor::PREVIOUS, Predictor::PREVIOUS,
+        Predictor::PREVIOUS, Predictor::PREVIOUS, Predictor::PREVIOUS,
+        Predictor::PREVIOUS, Predictor::PREVIOUS, Predictor::PREVIOUS, Predictor::PREVIOUS };
+
+    std::vector<uint8_t> buf_absolute(FRAMES * ABSOLUTE_FRAME_SIZE + 1);
+    std::vector<uint8_t> buf_encoded(FRAMES * TimeSeriesEncoder<FIELDS>::FRAME_SIZE_MAX + 1);
+    StreamBufWriter absolute(&buf_absolute[0], buf_absolute.size() - 1);
+    StreamBufWriter encoded(&buf_encoded[0], buf_encoded.size() - 1);
+    const auto per_frame = [](double ns_per_pass) { return ns_per_pass / static_cast<double>(FRAMES); };
+    report("time series write absolute, per frame", per_frame(time_ns_per_iteration(PASSES, [&](size_t) {
+        absolute.reset();
+        for (const auto& frame : trace) {
+            absolute.write_u32(static_cast<uint32_t>(frame[0]));
+            for (size_t field = 1; field < FIELDS; ++field) { absolute.write_u16(static_cast<uint16_t>(frame[field])); }
+        }
+    })));
+    TimeSeriesEncoder<FIELDS> encoder(predictors);
+    report("time series write predictive, per frame", per_frame(time_ns_per_iteration(PASSES, [&](size_t) {
+        encoded.reset();
+        encoder.reset();
+        for (const auto& frame : trace) { encoder.write_frame(encoded, frame); }
+    })));
+    report_size("time series absolute", absolute.bytes_written());
+    report_size("time series predictive", encoded.bytes_written());
+    Message message;
+    report_message(message, snprintf(&message[0], message.size(), "time series compression ratio %.2f", static_cast<double>(absolute.bytes_written()) / static_cast<double>(encoded.bytes_written())));
+    TEST_ASSERT_TRUE(encoded.bytes_written() * 2 < absolute.bytes_written());
+
+    std::vector<std::array<int32_t, FIELDS>> decoded(FRAMES);
+    TimeSeriesDecoder<FIELDS> decoder(predictors);
+    report("time series read_frame, per frame", per_frame(time_ns_per_iteration(PASSES, [&](size_t) {
+        StreamBufReader reader(&buf_encoded[0], encoded.bytes_written());
+        decoder.reset();
+        for (auto& frame : decoded) { decoder.read_frame(reader, frame); }
+    })));
+    TEST_ASSERT_EQUAL_MEMORY(&trace[0], &decoded[0], sizeof(trace[0]) * FRAMES);
+
+    std::array<std::vector<int32_t>, FIELDS> columns;
+    std::array<int32_t*, FIELDS> column_ptrs {};
+    for (size_t field = 0; field < FIELDS; ++field) {
+        columns[field].resize(FRAMES);
+        column_ptrs[field] = &columns[field][0];
+    }
+    size_t frames = 0;
+    report("time series read_frames, per frame", per_frame(time_ns_per_iteration(PASSES, [&](size_t) {
+        StreamBufReader reader(&buf_encoded[0], encoded.bytes_written());
+        decoder.reset();
+        frames = decoder.read_frames(reader, FRAMES, column_ptrs);
+    })));
+    TEST_ASSERT_EQUAL(FRAMES, frames);
+    for (size_t ii = 0; ii < FRAMES; ++ii) {
+        TEST_ASSERT_EQUAL_INT32(trace[ii][5], columns[5][ii]);
+    }
+}
+
+void test_benchmark_lz()
+{
+    enum { PASSES = 20, MESSAGES = 8192, RAW_SIZE = MESSAGES * TELEMETRY_MESSAGE_SIZE };
+    // telemetry messages with a sequence counter and noisy values, serialized directly into the compressor's window
+    std::vector<uint32_t> values(MESSAGES);
+    Random random;
+    for (uint32_t ii = 0; ii < MESSAGES; ++ii) { values[ii] = 0x00120000U + ii + (random.next() & 0x0FU); }
+    std::vector<uint8_t> compressed(stream_buf::lz_block_size_max(RAW_SIZE) * 2);
+    std::array<char, 128> name;
+
+    for (const size_t window_size : { 1024, 4096, 16384, 65535 }) {
+        std::vector<uint8_t> compressor_window(window_size);
+        std::vector<uint8_t> decompressor_window(window_size);
+        LzCompressor<> compressor(&compressor_window[0], window_size);
+        LzDecompressor decompressor(&decompressor_window[0], window_size);
+        StreamBufWriter out(&compressed[0], compressed.size() - 1);
+        const double compress_ns = time_ns_per_iteration(PASSES, [&](size_t) {
+            out.reset();
+            compressor.reset();
+            for (const uint32_t value : values) {
+                StreamBufWriter message = compressor.reserve(out, TELEMETRY_MESSAGE_SIZE);
+                write_telemetry_reserved(message, value);
+                compressor.commit(message);
+            }
+            compressor.flush(out);
+        });
+        TEST_ASSERT_EQUAL(0, compressor.bytes_pending());
+
+        uint32_t sum = 0;
+        const double decompress_ns = time_ns_per_iteration(PASSES, [&](size_t) {
+            StreamBufReader in(&compressed[0], out.bytes_written());
+            decompressor.reset();
+            sum = 0;
+            while (in.bytes_remaining() > 0) {
+                StreamBufReader messages = decompressor.read_block(in);
+                for (size_t count = messages.bytes_remaining() / TELEMETRY_MESSAGE_SIZE; count > 0; --count) {
+                    sum += read_telemetry_required(messages);
+                }
+            }
+        });
+        TEST_ASSERT_EQUAL(0, decompressor.errors());
+        uint32_t expected = 0;
+        for (const uint32_t value : values) {
+            StreamBufWriter message(&compressed[0], TELEMETRY_MESSAGE_SIZE); // scratch, compressed is no longer needed
+            write_telemetry_reserved(message, value);
+            StreamBufReader reader(&compressed[0], TELEMETRY_MESSAGE_SIZE);
+            expected += read_telemetry_required(reader);
+        }
+        TEST_ASSERT_EQUAL(expected, sum);
+
+        report_throughput(checked_text(name, snprintf(&name[0], name.size(), "lz window %5zu compress", window_size)), RAW_SIZE, compress_ns);
+        report_throughput(checked_text(name, snprintf(&name[0], name.size(), "lz window %5zu decompress", window_size)), RAW_SIZE, decompress_ns);
+        Message message;
+        report_message(message, snprintf(&message[0], message.size(), "lz window %5zu compression ratio %.2f", window_size, static_cast<double>(RAW_SIZE) / static_cast<double>(out.bytes_written())));
+        TEST_ASSERT_TRUE(out.bytes_written() * 3 < RAW_SIZE * 2);
+    }
+}
+
+void test_benchmark_ascii()
+{
+    enum { ITERATIONS = 200, VALUES = 1024 };
+    // CSV telemetry: values of mixed magnitudes and signs
+    std::vector<int32_t> values(VALUES);
+    Random random;
+    for (auto& value : values) { value = static_cast<int32_t>(random.next()) >> (random.next() % 31); }
+    std::vector<uint8_t> buf_snprintf(VALUES * 12 + 1);
+    std::vector<uint8_t> buf_decimal(VALUES * 12 + 1);
+    StreamBufWriter csv_snprintf(&buf_snprintf[0], buf_snprintf.size() - 1);
+    StreamBufWriter csv_decimal(&buf_decimal[0], buf_decimal.size() - 1);
+    const auto per_value = [](double ns_per_pass) { return ns_per_pass / static_cast<double>(VALUES); };
+    report("snprintf and write_data, per value", per_value(time_ns_per_iteration(ITERATIONS, [&](size_t) {
+        csv_snprintf.reset();
+        std::array<char, 16> text;
+        for (const int32_t value : values) {
+            const int len = snprintf(&text[0], text.size(), "%d,", value);
+            csv_snprintf.write_data(&text[0], static_cast<size_t>(len));
+        }
+    })));
+    report("write_decimal_s32, per value", per_value(time_ns_per_iteration(ITERATIONS, [&](size_t) {
+        csv_decimal.reset();
+        for (const int32_t value : values) {
+            csv_decimal.write_decimal_s32(value);
+            csv_decimal.write_u8(',');
+        }
+    })));
+    TEST_ASSERT_EQUAL(csv_snprintf.bytes_written(), csv_decimal.bytes_written());
+    TEST_ASSERT_EQUAL_MEMORY(&buf_snprintf[0], &buf_decimal[0], csv_decimal.bytes_written());
+
+    buf_decimal[csv_decimal.bytes_written()] = 0; // terminate for strtol
+    int64_t sum_strtol = 0;
+    int64_t sum_decimal = 0;
+    report("strtol, per value", per_value(time_ns_per_iteration(ITERATIONS, [&](size_t) {
+        sum_strtol = 0;
+        const char* text = reinterpret_cast<const char*>(&buf_decimal[0]); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        for (size_t ii = 0; ii < VALUES; ++ii) {
+            char* end = nullptr;
+            sum_strtol += strtol(text, &end, 10);
+            text = end + 1; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        }
+    })));
+    report("read_decimal_s32, per value", per_value(time_ns_per_iteration(ITERATIONS, [&](size_t) {
+        sum_decimal = 0;
+        StreamBufReader reader(&buf_decimal[0], csv_decimal.bytes_written());
+        for (size_t ii = 0; ii < VALUES; ++ii) {
+            sum_decimal += reader.read_decimal_s32();
+            reader.advance(1);
+        }
+    })));
+    TEST_ASSERT_EQUAL_INT64(sum_strtol, sum_decimal);
+}
+
+//! Hex encoder as commonly written, a byte at a time using a digit table
+static void hex_encode_bytewise(uint8_t* dst, const uint8_t* src, size_t len)
+{
+    static constexpr std::array<char, 16> DIGITS = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
+    for (size_t ii = 0; ii < len; ++ii) {
+        dst[2 * ii] = static_cast<uint8_t>(DIGITS[src[ii] >> 4U]);
+        dst[2 * ii + 1] = static_cast<uint8_t>(DIGITS[src[ii] & 0x0FU]);
+    }
+}
+
+//! Base64 decoder as commonly written, a character at a time using a value table
+static bool base64_decode_bytewise(uint8_t* dst, const uint8_t* src, size_t size)
+{
+    uint32_t bits = 0;
+    size_t count = 0;
+    for (size_t ii = 0; ii < size && src[ii] != '='; ++ii) {
+        const uint8_t value = stream_buf::BASE64_VALUES[src[ii]];
+        if (value > 0x3F) {
+            return false;
+        }
+        bits = (bits << 6U) | value;
+        count += 6;
+        if (count >= 8) {
+            count -= 8;
+            *dst++ = static_cast<uint8_t>(bits >> count);
+        }
+    }
+    return true;
+}
+
+void test_benchmark_hex_base64()
+{
+    enum { ITERATIONS = 2000, SIZE = 16384 };
+    std::vector<uint8_t> data(SIZE);
+    Random random;
+    for (auto& byte : data) { byte = static_cast<uint8_t>(random.next()); }
+    std::vector<uint8_t> hex_bytewise(2 * SIZE);
+    std::vector<uint8_t> hex(2 * SIZE);
+    report_throughput("hex encode bytewise", SIZE, time_ns_per_iteration(ITERATIONS, [&](size_t) {
+        hex_encode_bytewise(&hex_bytewise[0], &data[0], SIZE);
+    }));
+    StreamBufWriter sbw_hex(&hex[0], hex.size());
+    report_throughput("hex encode write_hex_encoded", SIZE, time_ns_per_iteration(ITERATIONS, [&](size_t) {
+        sbw_hex.reset();
+        sbw_hex.write_hex_encoded(&data[0], SIZE);
+    }));
+    TEST_ASSERT_EQUAL_MEMORY(&hex_bytewise[0], &hex[0], hex.size());
+    std::vector<uint8_t> decoded(SIZE);
+    report_throughput("hex decode read_hex_decoded", SIZE, time_ns_per_iteration(ITERATIONS, [&](size_t) {
+        StreamBufReader reader(&hex[0], hex.size());
+        TEST_ASSERT_TRUE(reader.read_hex_decoded(&decoded[0], SIZE));
+    }));
+    TEST_ASSERT_EQUAL_MEMORY(&data[0], &decoded[0], SIZE);
+
+    const size_t base64_size = stream_buf::base64_encoded_size(SIZE);
+    std::vector<uint8_t> base64(base64_size);
+    StreamBufWriter sbw_base64(&base64[0], base64.size());
+    report_throughput("Base64 encode write_base64", SIZE, time_ns_per_iteration(ITERATIONS, [&](size_t) {
+        sbw_base64.reset();
+        sbw_base64.write_base64(&data[0], SIZE);
+    }));
+    TEST_ASSERT_EQUAL(base64_size, sbw_base64.bytes_written());
+    decoded.assign(SIZE, 0);
+    report_throughput("Base64 decode bytewise", SIZE, time_ns_per_iteration(ITERATIONS, [&](size_t) {
+        TEST_ASSERT_TRUE(base64_decode_bytewise(&decoded[0], &base64[0], base64_size));
+    }));
+    TEST_ASSERT_EQUAL_MEMORY(&data[0], &decoded[0], SIZE);
+    decoded.assign(SIZE, 0);
+    report_throughput("Base64 decode read_base64", SIZE, time_ns_per_iteration(ITERATIONS, [&](size_t) {
+        StreamBufReader reader(&base64[0], base64_size);
+        TEST_ASSERT_TRUE(reader.read_base64(&decoded[0], SIZE));
+    }));
+    TEST_ASSERT_EQUAL_MEMORY(&data[0], &decoded[0], SIZE);
+}
+
+#if __has_include(<sys/mman.h>)
+template <typename Reader>
+static uint64_t sum_log(Reader& reader, bool prefetch)
+{
+    uint64_t sum = 0;
+    while (reader.bytes_remaining() >= 1024 * sizeof(uint32_t)) {
+        if constexpr (requires { reader.prefetch(); }) {
+            if (prefetch) { reader.prefetch(); }
+        }
+        for (size_t ii = 0; ii < 1024; ++ii) { sum += reader.read_u32(); }
+    }
+    return sum;
+}
+
+void test_benchmark_mapped_file()
+{
+    enum { ITERATIONS = 4, FILE_SIZE = 32 * 1024 * 1024 };
+    FILE* file = tmpfile();
+    TEST_ASSERT_NOT_NULL(file);
+    std::vector<uint32_t> block(1024 * 1024);
+    Random random;
+    for (size_t ii = 0; ii < FILE_SIZE / (block.size() * sizeof(uint32_t)); ++ii) {
+        for (auto& value : block) { value = random.next(); }
+        fwrite(&block[0], sizeof(uint32_t), block.size(), file);
+    }
+    fflush(file);
+    const int fd = fileno(file);
+
+    // read the whole file into a vector, then decode
+    uint64_t sum_vector = 0;
+    report("log read into vector, per pass", time_ns_per_iteration(ITERATIONS, [&](size_t) {
+        std::vector<uint8_t> contents(FILE_SIZE);
+        TEST_ASSERT_EQUAL(FILE_SIZE, pread(fd, &contents[0], contents.size(), 0));
+        StreamBufReader reader(&contents[0], contents.size());
+        sum_vector = sum_log(reader, false);
+    }));
+    uint64_t sum_mapped = 0;
+    report("log mapped, per pass", time_ns_per_iteration(ITERATIONS, [&](size_t) {
+        MappedStreamBufReader reader(fd);
+        TEST_ASSERT_TRUE(reader.is_mapped());
+        sum_mapped = sum_log(reader, true);
+    }));
+    fclose(file);
+    TEST_ASSERT_EQUAL_UINT64(sum_vector, sum_mapped);
+}
+#endif
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers,cppcoreguidelines-pro-bounds-pointer-arithmetic,readability-magic-numbers)
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char **argv)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_benchmark_reserve);
+    RUN_TEST(test_benchmark_schema);
+    RUN_TEST(test_benchmark_varint);
+    RUN_TEST(test_benchmark_array);
+    RUN_TEST(test_benchmark_shared);
+    RUN_TEST(test_benchmark_msp);
+    RUN_TEST(test_benchmark_byte_stuffing);
+    RUN_TEST(test_benchmark_time_series);
+    RUN_TEST(test_benchmark_lz);
+    RUN_TEST(test_benchmark_ascii);
+    RUN_TEST(test_benchmark_hex_base64);
+#if __has_include(<sys/mman.h>)
+    RUN_TEST(test_benchmark_mapped_file);
+#endif
+
+    UNITY_END();
+}
@@ -0,0 +1,134 @@
+#include "stream_buf_bit_stream.h"
+#include <array>
+#include <unity.h>
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers,cppcoreguidelines-pro-bounds-pointer-arithmetic,readability-magic-numbers)
+void test_bit_stream_msb_first()
+{
+    std::array<uint8_t, 16> buf {};
+    StreamBufWriter sbw(&buf[0], buf.size());
+    BitStreamWriter bw(sbw);
+
+    bw.write_bits(0b101, 3);
+    bw.write_bits(0b00001, 5);
+    bw.write_bits(0xABC, 12);
+    bw.write_bit(true);
+    TEST_ASSERT_EQUAL(0, sbw.bytes_written()); // still in the accumulator
+    bw.align();
+    TEST_ASSERT_EQUAL(3, sbw.bytes_written());
+    TEST_ASSERT_EQUAL_HEX8(0xA1, buf[0]);
+    TEST_ASSERT_EQUAL_HEX8(0xAB, buf[1]);
+    TEST_ASSERT_EQUAL_HEX8(0xC8, buf[2]); // 0xC, then a 1 bit, then padding
+
+    StreamBufReader sbr(&buf[0], sbw.bytes_written());
+    BitStreamReader br(sbr);
+    TEST_ASSERT_EQUAL(0b101, br.read_bits(3));
+    TEST_ASSERT_EQUAL(0b00001, br.read_bits(5));
+    TEST_ASSERT_EQUAL(0xABC, br.read_bits(12));
+    TEST_ASSERT_TRUE(br.read_bit());
+    TEST_ASSERT_EQUAL(0, br.read_bits(3)); // padding
+    TEST_ASSERT_EQUAL(0, sbr.bytes_remaining());
+}
+
+void test_bit_stream_lsb_first()
+{
+    // SBUS packs 16 11-bit channels LSB first into 22 bytes
+    std::array<uint16_t, 16> channels {};
+    for (size_t ii = 0; ii < channels.size(); ++ii) {
+        channels[ii] = static_cast<uint16_t>(172 + ii * 101);
+    }
+    std::array<uint8_t, 22> expected {};
+    for (size_t bit = 0; bit < 16 * 11; ++bit) {
+        if ((channels[bit / 11] >> (bit % 11)) & 1U) {
+            expected[bit / 8] |= static_cast<uint8_t>(1U << (bit % 8));
+        }
+    }
+
+    std::array<uint8_t, 24> buf {};
+    StreamBufWriter sbw(&buf[0], buf.size());
+    sbw.write_u8(0x0F); // SBUS header
+    BitStreamWriter<StreamBufWriter, stream_buf::BitOrder::LSB_FIRST> bw(sbw);
+    for (const uint16_t channel : channels) {
+        bw.write_bits(channel, 11);
+    }
+    bw.align();
+    sbw.write_u8(0x00); // byte aligned write after align()
+    TEST_ASSERT_EQUAL(24, sbw.bytes_written());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&expected[0], &buf[1], expected.size());
+
+    StreamBufReader sbr(&buf[0], sbw.bytes_written());
+    TEST_ASSERT_EQUAL_HEX8(0x0F, sbr.read_u8());
+    BitStreamReader<StreamBufReader, stream_buf::BitOrder::LSB_FIRST> br(sbr);
+    for (const uint16_t channel : channels) {
+        TEST_ASSERT_EQUAL(channel, br.read_bits(11));
+    }
+    br.align();
+    TEST_ASSERT_EQUAL(1, sbr.bytes_remaining());
+}
+
+template <stream_buf::BitOrder O>
+static void round_trip_mixed_widths()
+{
+    std::array<uint8_t, 272> buf {};
+    StreamBufWriter sbw(&buf[0], buf.size());
+    BitStreamWriter<StreamBufWriter, O> bw(sbw);
+    uint64_t value = 0x0123456789ABCDEFULL;
+    for (size_t n = 0; n <= 64; ++n) {
+        bw.write_bits(value, n);
+        value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+    }
+    bw.align();
+    bw.write_bits(0x5, 3);
+    bw.align();
+    sbw.write_u16(0xBEEF);
+    TEST_ASSERT_EQUAL(65 * 32 / 8 + 1 + 2, sbw.bytes_written()); // 0 + 1 + ... + 64 bits is 260 bytes
+
+    StreamBufReader sbr(&buf[0], sbw.bytes_written());
+    BitStreamReader<StreamBufReader, O> br(sbr);
+    value = 0x0123456789ABCDEFULL;
+    for (size_t n = 0; n <= 64; ++n) {
+        TEST_ASSERT_EQUAL_HEX64(stream_buf::low_bits(value, n), br.read_bits(n));
+        value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+    }
+    br.align();
+    TEST_ASSERT_EQUAL(5, br.read_bits(3));
+    br.align();
+    TEST_ASSERT_EQUAL_HEX16(0xBEEF, sbr.read_u16());
+}
+
+void test_bit_stream_round_trip()
+{
+    round_trip_mixed_widths<stream_buf::BitOrder::MSB_FIRST>();
+    round_trip_mixed_widths<stream_buf::BitOrder::LSB_FIRST>();
+}
+
+void test_bit_stream_end_of_buffer()
+{
+    const std::array<uint8_t, 3> buf = { 0xFF, 0x00, 0xFF };
+    StreamBufReaderSticky sbr(&buf[0], buf.size());
+    BitStreamReader br(sbr);
+    TEST_ASSERT_EQUAL(0xFF0, br.read_bits(12));
+    TEST_ASSERT_EQUAL(0, br.read_bits(13)); // only 12 bits remain
+    TEST_ASSERT_TRUE(sbr.overflowed());
+}
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers,cppcoreguidelines-pro-bounds-pointer-arithmetic,readability-magic-numbers)
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char **argv)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_bit_stream_msb_first);
+    RUN_TEST(test_bit_stream_lsb_first);
+    RUN_TEST(test_bit_stream_round_trip);
+    RUN_TEST(test_bit_stream_end_of_buffer);
+
+    UNITY_END();
+}
@@ -0,0 +1,260 @@
+#include "stream_buf_byte_stuffing.h"
+#include <array>
+#include <unity.h>
+#include <vector>
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers,cppcoreguidelines-pro-bounds-pointer-arithmetic,readability-magic-numbers)
+static std::vector<uint8_t> sequence(uint8_t first, uint8_t last)
+{
+    std::vector<uint8_t> ret;
+    for (unsigned value = first; value <= last; ++value) {
+        ret.push_back(static_cast<uint8_t>(value));
+    }
+    return ret;
+}
+
+static std::vector<uint8_t> concat(std::initializer_list<std::vector<uint8_t>> parts)
+{
+    std::vector<uint8_t> ret;
+    for (const auto& part : parts) {
+        ret.insert(ret.end(), part.begin(), part.end());
+    }
+    return ret;
+}
+
+//! pseudo random data with runs of zeros and of SLIP special bytes
+static std::vector<uint8_t> random_payload(size_t len, uint32_t seed)
+{
+    std::vector<uint8_t> ret(len);
+    for (auto& byte : ret) {
+        seed = seed * 1664525U + 1013904223U;
+        const uint32_t r = seed >> 24U;
+        byte = (r < 16) ? 0 : (r < 24) ? stream_buf::SLIP_END : (r < 32) ? stream_buf::SLIP_ESC : static_cast<uint8_t>(r);
+    }
+    return ret;
+}
+
+void test_scan()
+{
+    std::array<uint8_t, 100> buf {};
+    buf.fill(0x55);
+    for (size_t pos = 0; pos < buf.size(); ++pos) {
+        buf[pos] = 0xC0;
+        TEST_ASSERT_EQUAL(pos, stream_buf::find_byte(&buf[0], buf.size(), 0xC0));
+        TEST_ASSERT_EQUAL(pos, stream_buf::find_either(&buf[0], buf.size(), 0xDB, 0xC0));
+        TEST_ASSERT_EQUAL(pos, stream_buf::find_either(&buf[0], buf.size(), 0xC0, 0xDB));
+        TEST_ASSERT_EQUAL(pos, stream_buf::find_byte(&buf[0], pos, 0xC0)); // not found, so the length
+        buf[pos] = 0x55;
+    }
+    TEST_ASSERT_EQUAL(0, stream_buf::find_byte(&buf[0], 0, 0x55));
+    TEST_ASSERT_EQUAL(buf.size(), stream_buf::find_either(&buf[0], buf.size(), 0x00, 0xFF));
+}
+
+void test_cobs_encode()
+{
+    // examples from the COBS paper and Wikipedia
+    const std::vector<std::pair<std::vector<uint8_t>, std::vector<uint8_t>>> examples = {
+        { {}, { 0x01, 0x00 } },
+        { { 0x00 }, { 0x01, 0x01, 0x00 } },
+        { { 0x00, 0x00 }, { 0x01, 0x01, 0x01, 0x00 } },
+        { { 0x00, 0x11, 0x00 }, { 0x01, 0x02, 0x11, 0x01, 0x00 } },
+        { { 0x11, 0x22, 0x00, 0x33 }, { 0x03, 0x11, 0x22, 0x02, 0x33, 0x00 } },
+        { { 0x11, 0x22, 0x33, 0x44 }, { 0x05, 0x11, 0x22, 0x33, 0x44, 0x00 } },
+        { { 0x11, 0x00, 0x00, 0x00 }, { 0x02, 0x11, 0x01, 0x01, 0x01, 0x00 } },
+        { sequence(0x01, 0xFE), concat({ { 0xFF }, sequence(0x01, 0xFE), { 0x00 } }) },
+        { concat({ { 0x00 }, sequence(0x01, 0xFE) }), concat({ { 0x01, 0xFF }, sequence(0x01, 0xFE), { 0x00 } }) },
+        { sequence(0x01, 0xFF), concat({ { 0xFF }, sequence(0x01, 0xFE), { 0x02, 0xFF, 0x00 } }) },
+        { concat({ sequence(0x02, 0xFF), { 0x00 } }), concat({ { 0xFF }, sequence(0x02, 0xFF), { 0x01, 0x01, 0x00 } }) },
+        { concat({ sequence(0x03, 0xFF), { 0x00, 0x01 } }), concat({ { 0xFE }, sequence(0x03, 0xFF), { 0x02, 0x01, 0x00 } }) },
+    };
+    for (const auto& [decoded, encoded] : examples) {
+        std::array<uint8_t, 300> buf {};
+        StreamBufWriter sbw(&buf[0], buf.size());
+        TEST_ASSERT_TRUE(stream_buf::write_cobs(sbw, decoded.data(), decoded.size()));
+        TEST_ASSERT_EQUAL(encoded.size(), sbw.bytes_written());
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(encoded.data(), &buf[0], encoded.size());
+        TEST_ASSERT_TRUE(encoded.size() <= stream_buf::cobs_max_encoded_size(decoded.size()) + 1);
+
+        // the streaming encoder gives the same encoding, however the data is split
+        for (const size_t piece : { size_t{1}, size_t{3}, size_t{254} }) {
+            std::array<uint8_t, 300> streamed {};
+            StreamBufWriterChecked sbw_streamed(&streamed[0], streamed.size());
+            CobsEncoder encoder(sbw_streamed);
+            for (size_t pos = 0; pos < decoded.size(); pos += piece) {
+                encoder.write(decoded.data() + pos, std::min(piece, decoded.size() - pos));
+            }
+            TEST_ASSERT_TRUE(encoder.finish());
+            TEST_ASSERT_EQUAL(encoded.size(), sbw_streamed.bytes_written());
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(encoded.data(), &streamed[0], encoded.size());
+        }
+
+        std::vector<uint8_t> frame(encoded.begin(), encoded.end() - 1);
+        TEST_ASSERT_EQUAL(decoded.size(), stream_buf::cobs_decode_in_place(frame.data(), frame.size()));
+        if (!decoded.empty()) { // comparing zero bytes is rejected by Unity
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(decoded.data(), frame.data(), decoded.size());
+        }
+    }
+
+    // an empty payload may be passed as nullptr
+    {
+        std::array<uint8_t, 4> buf {};
+        StreamBufWriter sbw(&buf[0], buf.size());
+        TEST_ASSERT_TRUE(stream_buf::write_cobs(sbw, nullptr, 0));
+        TEST_ASSERT_EQUAL(2, sbw.bytes_written());
+        TEST_ASSERT_EQUAL_HEX8(0x01, buf[0]);
+        TEST_ASSERT_EQUAL_HEX8(0x00, buf[1]);
+    }
+
+    // insufficient space for the worst case, so nothing is written
+    std::array<uint8_t, 4> small {};
+    StreamBufWriter sbw(&small[0], small.size());
+    const std::array<uint8_t, 3> data = { 1, 2, 3 };
+    TEST_ASSERT_FALSE(stream_buf::write_cobs(sbw, &data[0], data.size()));
+    TEST_ASSERT_EQUAL(0, sbw.bytes_written());
+}
+
+void test_cobs_decode_malformed()
+{
+    const std::array<uint8_t, 3> truncated = { 0x05, 0x11, 0x22 };
+    std::array<uint8_t, 8> out {};
+    TEST_ASSERT_EQUAL(stream_buf::DECODE_ERROR, stream_buf::cobs_decode(&out[0], &truncated[0], truncated.size()));
+    const std::array<uint8_t, 3> zero_code = { 0x02, 0x11, 0x00 };
+    TEST_ASSERT_EQUAL(stream_buf::DECODE_ERROR, stream_buf::cobs_decode(&out[0], &zero_code[0], zero_code.size()));
+}
+
+template <typename Decoder>
+static std::vector<std::vector<uint8_t>> decode_chunked(Decoder& decoder, const std::vector<uint8_t>& stream, size_t chunk_size)
+{
+    std::vector<std::vector<uint8_t>> frames;
+    for (size_t pos = 0; pos < stream.size(); pos += chunk_size) {
+        decoder.decode(&stream[pos], std::min(chunk_size, stream.size() - pos), [&frames](std::span<const uint8_t> frame) {
+            frames.emplace_back(frame.begin(), frame.end());
+        });
+    }
+    return frames;
+}
+
+void test_cobs_decoder()
+{
+    std::vector<std::vector<uint8_t>> payloads;
+    std::vector<uint8_t> stream(4096);
+    StreamBufWriter sbw(&stream[0], stream.size());
+    sbw.write_u8(0x00); // leading delimiters are skipped
+    for (size_t ii = 0; ii < 12; ++ii) {
+        payloads.push_back(random_payload(ii * 37, static_cast<uint32_t>(ii)));
+        stream_buf::write_cobs(sbw, payloads.back().data(), payloads.back().size());
+    }
+    // frames too large for the decoder, and truncated, are discarded
+    const std::vector<uint8_t> too_large = random_payload(600, 99);
+    stream_buf::write_cobs(sbw, too_large.data(), too_large.size());
+    const std::array<uint8_t, 4> truncated = { 0x05, 0x01, 0x02, 0x00 };
+    sbw.write_data(&truncated[0], truncated.size());
+    payloads.push_back({ 0xAA, 0x00 });
+    stream_buf::write_cobs(sbw, payloads.back().data(), payloads.back().size());
+    stream.resize(sbw.bytes_written());
+
+    for (const size_t chunk_size : { size_t{1}, size_t{5}, size_t{64}, stream.size() }) {
+        std::array<uint8_t, 512> buf {};
+        CobsDecoder decoder(&buf[0], buf.size());
+        const auto frames = decode_chunked(decoder, stream, chunk_size);
+        TEST_ASSERT_EQUAL(payloads.size(), frames.size());
+        for (size_t ii = 0; ii < payloads.size(); ++ii) {
+            TEST_ASSERT_EQUAL(payloads[ii].size(), frames[ii].size());
+            TEST_ASSERT_TRUE(payloads[ii] == frames[ii]);
+        }
+        TEST_ASSERT_EQUAL(1, decoder.dropped());
+        TEST_ASSERT_EQUAL(1, decoder.errors());
+        TEST_ASSERT_FALSE(decoder.in_frame());
+    }
+
+    // decoding from a reader
+    std::array<uint8_t, 512> buf {};
+    CobsDecoder decoder(&buf[0], buf.size());
+    StreamBufReader sbr(&stream[0], stream.size());
+    TEST_ASSERT_EQUAL(payloads.size(), decoder.decode(sbr, [](std::span<const uint8_t>) {}));
+    TEST_ASSERT_EQUAL(0, sbr.bytes_remaining());
+}
+
+void test_slip_encode()
+{
+    const std::array<uint8_t, 6> data = { 0x01, 0xC0, 0x02, 0xDB, 0xDB, 0x03 };
+    const std::array<uint8_t, 10> expected = { 0x01, 0xDB, 0xDC, 0x02, 0xDB, 0xDD, 0xDB, 0xDD, 0x03, 0xC0 };
+    std::array<uint8_t, 16> buf {};
+    StreamBufWriter sbw(&buf[0], buf.size());
+    TEST_ASSERT_TRUE(stream_buf::write_slip(sbw, &data[0], data.size()));
+    TEST_ASSERT_EQUAL(expected.size(), sbw.bytes_written());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&expected[0], &buf[0], expected.size());
+
+    // only 6 bytes remain, so nothing is written
+    TEST_ASSERT_FALSE(stream_buf::write_slip(sbw, &data[0], data.size()));
+    TEST_ASSERT_EQUAL(expected.size(), sbw.bytes_written());
+    // but an unescaped frame of 5 bytes fits exactly
+    TEST_ASSERT_TRUE(stream_buf::write_slip(sbw, &data[2], 1));
+    TEST_ASSERT_TRUE(stream_buf::write_slip(sbw, &data[0], 1));
+    TEST_ASSERT_TRUE(sbw.bytes_remaining() == 2);
+
+    std::array<uint8_t, 9> frame {};
+    std::copy_n(&expected[0], frame.size(), &frame[0]);
+    TEST_ASSERT_EQUAL(data.size(), stream_buf::slip_decode_in_place(&frame[0], frame.size()));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&data[0], &frame[0], data.size());
+
+    const std::array<uint8_t, 3> bad_escape = { 0x01, 0xDB, 0x02 };
+    std::array<uint8_t, 3> out {};
+    TEST_ASSERT_EQUAL(stream_buf::DECODE_ERROR, stream_buf::slip_decode(&out[0], &bad_escape[0], bad_escape.size()));
+    TEST_ASSERT_EQUAL(stream_buf::DECODE_ERROR, stream_buf::slip_decode(&out[0], &bad_escape[0], 2));
+}
+
+void test_slip_decoder()
+{
+    std::vector<std::vector<uint8_t>> payloads;
+    std::vector<uint8_t> stream(8192);
+    StreamBufWriter sbw(&stream[0], stream.size());
+    for (size_t ii = 0; ii < 12; ++ii) {
+        payloads.push_back(random_payload(ii * 41 + 1, static_cast<uint32_t>(ii + 100)));
+        sbw.write_u8(stream_buf::SLIP_END);
+        stream_buf::write_slip(sbw, payloads.back().data(), payloads.back().size());
+    }
+    const std::vector<uint8_t> too_large = random_payload(600, 99);
+    stream_buf::write_slip(sbw, too_large.data(), too_large.size());
+    const std::array<uint8_t, 4> bad_escape = { 0x01, 0xDB, 0x02, 0xC0 };
+    sbw.write_data(&bad_escape[0], bad_escape.size());
+    payloads.push_back({ 0xC0 });
+    stream_buf::write_slip(sbw, payloads.back().data(), payloads.back().size());
+    stream.resize(sbw.bytes_written());
+
+    for (const size_t chunk_size : { size_t{1}, size_t{5}, size_t{64}, stream.size() }) {
+        std::array<uint8_t, 512> buf {};
+        SlipDecoder decoder(&buf[0], buf.size());
+        const auto frames = decode_chunked(decoder, stream, chunk_size);
+        TEST_ASSERT_EQUAL(payloads.size(), frames.size());
+        for (size_t ii = 0; ii < payloads.size(); ++ii) {
+            TEST_ASSERT_TRUE(payloads[ii] == frames[ii]);
+        }
+        TEST_ASSERT_EQUAL(1, decoder.dropped());
+        TEST_ASSERT_EQUAL(1, decoder.errors());
+        TEST_ASSERT_FALSE(decoder.in_frame());
+    }
+}
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers,cppcoreguidelines-pro-bounds-pointer-arithmetic,readability-magic-numbers)
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char **argv)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_scan);
+    RUN_TEST(test_cobs_encode);
+    RUN_TEST(test_cobs_decode_malformed);
+    RUN_TEST(test_cobs_decoder);
+    RUN_TEST(test_slip_encode);
+    RUN_TEST(test_slip_decoder);
+
+    UNITY_END();
+}
@@ -0,0 +1,141 @@
+#include "stream_buf_reader.h"
+#include <array>
+#include <unity.h>
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers,cppcoreguidelines-pro-bounds-pointer-arithmetic,readability-magic-numbers)
+static const std::array<uint8_t, 9> CHECK = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+
+void test_checksum_check_values()
+{
+    stream_buf::Xor8 xor8;
+    xor8.update(&CHECK[0], CHECK.size());
+    TEST_ASSERT_EQUAL_HEX8(0x31, xor8.value());
+
+    stream_buf::Crc8DvbS2 crc8;
+    crc8.update(&CHECK[0], CHECK.size());
+    TEST_ASSERT_EQUAL_HEX8(0xBC, crc8.value());
+
+    stream_buf::Crc16Ccitt crc16;
+    crc16.update(&CHECK[0], CHECK.size());
+    TEST_ASSERT_EQUAL_HEX16(0x29B1, crc16.value());
+
+    stream_buf::Crc16Ccitt crc16_xmodem(0);
+    crc16_xmodem.update(&CHECK[0], CHECK.size());
+    TEST_ASSERT_EQUAL_HEX16(0x31C3, crc16_xmodem.value());
+
+    stream_buf::Crc32 crc32;
+    crc32.update(&CHECK[0], CHECK.size());
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926, crc32.value());
+
+    crc32.reset();
+    crc16.reset();
+    crc8.reset();
+    xor8.reset();
+    TEST_ASSERT_EQUAL_HEX32(0, crc32.value());
+    TEST_ASSERT_EQUAL_HEX16(0xFFFF, crc16.value());
+    TEST_ASSERT_EQUAL_HEX8(0, crc8.value());
+    TEST_ASSERT_EQUAL_HEX8(0, xor8.value());
+}
+
+void test_checksum_incremental()
+{
+    // checksums computed in pieces, of all lengths, must match those computed in one go
+    // lengths of 64 and over exercise the PCLMUL CRC32 path when it is enabled
+    std::array<uint8_t, 300> data;
+    uint32_t state = 1;
+    for (auto& byte : data) {
+        state = state * 1103515245U + 12345U;
+        byte = static_cast<uint8_t>(state >> 16);
+    }
+    for (size_t split = 0; split <= data.size(); split += 7) {
+        stream_buf::Crc32 whole;
+        stream_buf::Crc32 bytewise;
+        stream_buf::Crc32 pieces;
+        whole.update(&data[0], data.size());
+        for (const uint8_t byte : data) {
+            bytewise.update(&byte, 1);
+        }
+        pieces.update(&data[0], split);
+        pieces.update(&data[split], data.size() - split);
+        TEST_ASSERT_EQUAL_HEX32(bytewise.value(), whole.value());
+        TEST_ASSERT_EQUAL_HEX32(bytewise.value(), pieces.value());
+
+        stream_buf::Xor8 xor8_whole;
+        stream_buf::Xor8 xor8_pieces;
+        uint8_t xor8 = 0;
+        for (const uint8_t byte : data) {
+            xor8 ^= byte;
+        }
+        xor8_whole.update(&data[0], data.size());
+        xor8_pieces.update(&data[0], split);
+        xor8_pieces.update(&data[split], data.size() - split);
+        TEST_ASSERT_EQUAL_HEX8(xor8, xor8_whole.value());
+        TEST_ASSERT_EQUAL_HEX8(xor8, xor8_pieces.value());
+    }
+}
+
+void test_checksum_writer()
+{
+    enum { BUF_SIZE = 64 };
+    std::array<uint8_t, BUF_SIZE> buf;
+    stream_buf::Crc8DvbS2 crc;
+    StreamBufWriterT<stream_buf::Unchecked, stream_buf::Crc8DvbS2> sbuf(&buf[0], BUF_SIZE, crc);
+
+    sbuf.write_u8(0x01);
+    sbuf.write_u16(0x0302);
+    sbuf.write_u32_big_endian(0x04050607);
+    sbuf.write_data("89", 2);
+    sbuf.write_varint_u32(300);
+    const std::array<uint16_t, 2> array = { 0x0102, 0x0304 };
+    sbuf.write_array<uint16_t, stream_buf::Endian::BIG>(&array[0], array.size());
+    StreamBufWriter message = sbuf.reserve(2);
+    message.write_u16(0xABCD);
+    sbuf.commit(message);
+    sbuf.fill(0xEE, 3);
+
+    stream_buf::Crc8DvbS2 expected;
+    expected.update(sbuf.begin(), sbuf.bytes_written());
+    TEST_ASSERT_EQUAL(20, sbuf.bytes_written());
+    TEST_ASSERT_EQUAL_HEX8(expected.value(), crc.value());
+
+    // a failed write does not affect the checksum
+    const uint8_t value = crc.value();
+    sbuf.write_data(&buf[0], BUF_SIZE);
+    TEST_ASSERT_EQUAL_HEX8(value, crc.value());
+
+    // bytes read are folded into the reader checksum
+    stream_buf::Crc8DvbS2 crc_read;
+    StreamBufReaderT<stream_buf::Checked, stream_buf::Crc8DvbS2> sbufReader(sbuf.begin(), sbuf.bytes_written(), crc_read);
+    TEST_ASSERT_EQUAL(0x01, sbufReader.read_u8());
+    TEST_ASSERT_EQUAL(0x0302, sbufReader.read_u16());
+    TEST_ASSERT_EQUAL(0x04050607, sbufReader.read_u32_big_endian());
+    std::array<char, 2> data;
+    sbufReader.read_data(&data[0], data.size());
+    TEST_ASSERT_EQUAL(300, sbufReader.read_varint_u32());
+    std::array<uint16_t, 2> array_read {};
+    sbufReader.read_array<uint16_t, stream_buf::Endian::BIG>(&array_read[0], array_read.size());
+    TEST_ASSERT_EQUAL(0x0304, array_read[1]);
+    sbufReader.advance(5);
+    TEST_ASSERT_EQUAL(0, sbufReader.bytes_remaining());
+    TEST_ASSERT_EQUAL_HEX8(crc.value(), crc_read.value());
+}
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers,cppcoreguidelines-pro-bounds-pointer-arithmetic,readability-magic-numbers)
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char **argv)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_checksum_check_values);
+    RUN_TEST(test_checksum_incremental);
+    RUN_TEST(test_checksum_writer);
+
+    UNITY_END();
+}
@@ -0,0 +1,237 @@
+#include "stream_buf_lz.h"
+#include <array>
+#include <unity.h>
+#include <vector>
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers,cppcoreguidelines-pro-bounds-pointer-arithmetic,readability-magic-numbers)
+static std::vector<uint8_t> make_text(size_t len)
+{
+    // records with repeated field names and slowly changing values, like serialized telemetry
+    std::vector<uint8_t> text;
+    uint32_t seed = 1;
+    while (text.size() < len) {
+        seed = seed * 1664525U + 1013904223U;
+        const std::array<char, 24> record = { 'a', 'l', 't', '=', static_cast<char>('0' + (seed >> 29U)), ';',
+            'r', 'o', 'l', 'l', '=', static_cast<char>('0' + (seed >> 26U) % 8), ';',
+            'p', 'i', 't', 'c', 'h', '=', '1', '2', ';', '\n', static_cast<char>(seed >> 24U) };
+        text.insert(text.end(), record.begin(), record.end());
+    }
+    text.resize(len);
+    return text;
+}
+
+static std::vector<uint8_t> make_noise(size_t len)
+{
+    std::vector<uint8_t> noise(len);
+    uint32_t seed = 7;
+    for (auto& byte : noise) {
+        seed = seed * 1664525U + 1013904223U;
+        byte = static_cast<uint8_t>(seed >> 24U);
+    }
+    return noise;
+}
+
+// compress data in writes of chunk bytes, flushing every flush_interval bytes, and check that it decompresses
+static size_t round_trip(const std::vector<uint8_t>& data, size_t window_size, size_t chunk, size_t flush_interval)
+{
+    std::vector<uint8_t> compressor_window(window_size);
+    std::vector<uint8_t> decompressor_window(window_size);
+    std::vector<uint8_t> compressed(stream_buf::lz_block_size_max(data.size()) * 2 + 1024);
+    LzCompressor<> compressor(&compressor_window[0], window_size);
+    LzDecompressor decompressor(&decompressor_window[0], window_size);
+
+    StreamBufWriter sbw(&compressed[0], compressed.size());
+    size_t since_flush = 0;
+    for (size_t pos = 0; pos < data.size(); pos += chunk) {
+        const size_t len = std::min(chunk, data.size() - pos);
+        TEST_ASSERT_EQUAL(len, compressor.write(sbw, &data[pos], len));
+        since_flush += len;
+        if (since_flush >= flush_interval) {
+            TEST_ASSERT_TRUE(compressor.flush(sbw));
+            since_flush = 0;
+        }
+    }
+    TEST_ASSERT_TRUE(compressor.flush(sbw));
+    TEST_ASSERT_EQUAL(0, compressor.bytes_pending());
+
+    std::vector<uint8_t> decompressed;
+    StreamBufReader sbr(&compressed[0], sbw.bytes_written());
+    while (sbr.bytes_remaining() > 0) {
+        StreamBufReader block = decompressor.read_block(sbr);
+        TEST_ASSERT_TRUE(block.bytes_remaining() > 0);
+        decompressed.insert(decompressed.end(), block.ptr(), block.ptr() + block.bytes_remaining());
+    }
+    TEST_ASSERT_EQUAL(0, decompressor.errors());
+    TEST_ASSERT_EQUAL(data.size(), decompressed.size());
+    TEST_ASSERT_EQUAL_MEMORY(&data[0], &decompressed[0], data.size());
+    return sbw.bytes_written();
+}
+
+void test_lz_round_trip()
+{
+    const std::vector<uint8_t> text = make_text(100000);
+    for (const size_t window_size : { 256, 4096, 65535 }) {
+        const size_t compressed_size = round_trip(text, window_size, 100, SIZE_MAX);
+        TEST_ASSERT_TRUE(compressed_size < text.size() / 2);
+        // flushing often makes smaller blocks, but the history still gives matches
+        TEST_ASSERT_TRUE(round_trip(text, window_size, 37, 200) < text.size() / 2);
+    }
+    // a larger window finds more matches
+    TEST_ASSERT_TRUE(round_trip(text, 65535, 1000, SIZE_MAX) < round_trip(text, 256, 1000, SIZE_MAX));
+
+    // long runs use overlapping matches and extended lengths
+    const std::vector<uint8_t> zeros(50000);
+    TEST_ASSERT_TRUE(round_trip(zeros, 4096, 5000, SIZE_MAX) < 500);
+
+    // incompressible data is stored, so expands only by the block headers
+    const std::vector<uint8_t> noise = make_noise(20000);
+    TEST_ASSERT_TRUE(round_trip(noise, 4096, 20000, SIZE_MAX) <= noise.size() + 4 * (noise.size() / 2048 + 1));
+
+    // a mixture of short messages, which flush blocks that are too short to compress
+    std::vector<uint8_t> mixed = make_text(3000);
+    mixed.insert(mixed.end(), noise.begin(), noise.begin() + 3000);
+    mixed.insert(mixed.end(), 3000, 0xAA);
+    round_trip(mixed, 1024, 7, 3);
+}
+
+void test_lz_block_format()
+{
+    std::array<uint8_t, 64> window {};
+    std::array<uint8_t, 128> buf {};
+    LzCompressor<> compressor(&window[0], window.size());
+    StreamBufWriter sbw(&buf[0], buf.size());
+    const std::array<uint8_t, 20> data = { 'a', 'b', 'c', 'd', 'a', 'b', 'c', 'd', 'a', 'b', 'c', 'd', 'a', 'b', 'c', 'd', 'x', 'y', 'z', '!' };
+    TEST_ASSERT_EQUAL(data.size(), compressor.write(sbw, &data[0], data.size()));
+    TEST_ASSERT_EQUAL(data.size(), compressor.bytes_pending());
+    TEST_ASSERT_EQUAL(0, sbw.bytes_written());
+    TEST_ASSERT_TRUE(compressor.flush(sbw));
+    const std::array<uint8_t, 16> expected = {
+        20, 0, 12, 0, // raw size and stored size
+        0x48, 'a', 'b', 'c', 'd', 4, 0, // 4 literals, then a match of 12 at offset 4
+        0x40, 'x', 'y', 'z', '!', // the last 4 literals
+    };
+    TEST_ASSERT_EQUAL(expected.size(), sbw.bytes_written());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&expected[0], &buf[0], expected.size());
+
+    // a short block is stored
+    sbw.reset();
+    TEST_ASSERT_EQUAL(3, compressor.write(sbw, &data[16], 3));
+    TEST_ASSERT_TRUE(compressor.flush(sbw));
+    const std::array<uint8_t, 7> stored = { 3, 0, 3, 0, 'x', 'y', 'z' };
+    TEST_ASSERT_EQUAL(stored.size(), sbw.bytes_written());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&stored[0], &buf[0], stored.size());
+
+    // nothing pending, so nothing is written
+    sbw.reset();
+    TEST_ASSERT_TRUE(compressor.flush(sbw));
+    TEST_ASSERT_EQUAL(0, sbw.bytes_written());
+}
+
+void test_lz_reserve()
+{
+    std::array<uint8_t, 256> compressor_window {};
+    std::array<uint8_t, 256> decompressor_window {};
+    std::vector<uint8_t> buf(4096);
+    LzCompressor<10> compressor(&compressor_window[0], compressor_window.size());
+    LzDecompressor decompressor(&decompressor_window[0], decompressor_window.size());
+    StreamBufWriter sbw(&buf[0], buf.size());
+
+    // serialize messages directly into the window, which compresses a block whenever it fills
+    for (uint32_t ii = 0; ii < 100; ++ii) {
+        StreamBufWriter message = compressor.reserve(sbw, 12);
+        TEST_ASSERT_EQUAL(12, message.bytes_remaining());
+        message.write_u32(0xCAFEF00D);
+        message.write_u32(ii);
+        message.write_u32(ii * 3);
+        compressor.commit(message);
+    }
+    TEST_ASSERT_TRUE(compressor.flush(sbw));
+    TEST_ASSERT_TRUE(sbw.bytes_written() < 1200);
+
+    StreamBufReader sbr(&buf[0], sbw.bytes_written());
+    uint32_t ii = 0;
+    while (sbr.bytes_remaining() > 0) {
+        StreamBufReader block = decompressor.read_block(sbr);
+        TEST_ASSERT_TRUE(block.bytes_remaining() > 0);
+        while (block.bytes_remaining() > 0) {
+            TEST_ASSERT_EQUAL_HEX32(0xCAFEF00D, block.read_u32());
+            TEST_ASSERT_EQUAL(ii, block.read_u32());
+            TEST_ASSERT_EQUAL(ii * 3, block.read_u32());
+            ++ii;
+        }
+    }
+    TEST_ASSERT_EQUAL(100, ii);
+    TEST_ASSERT_EQUAL(0, decompressor.errors());
+
+    // insufficient space in the output for the block
+    StreamBufWriter small(&buf[0], 16);
+    StreamBufWriter message = compressor.reserve(small, 100);
+    message.write_data(&buf[0], 100);
+    compressor.commit(message);
+    TEST_ASSERT_EQUAL(0, compressor.reserve(small, 100).bytes_remaining());
+    TEST_ASSERT_FALSE(compressor.flush(small));
+    TEST_ASSERT_EQUAL(100, compressor.bytes_pending());
+    TEST_ASSERT_EQUAL(0, small.bytes_written());
+}
+
+void test_lz_truncated_and_corrupt()
+{
+    const std::vector<uint8_t> text = make_text(1000);
+    std::array<uint8_t, 1024> compressor_window {};
+    std::array<uint8_t, 1024> decompressor_window {};
+    std::vector<uint8_t> buf(2048);
+    LzCompressor<> compressor(&compressor_window[0], compressor_window.size());
+    LzDecompressor decompressor(&decompressor_window[0], decompressor_window.size());
+    StreamBufWriter sbw(&buf[0], buf.size());
+    compressor.write(sbw, &text[0], text.size());
+    TEST_ASSERT_TRUE(compressor.flush(sbw));
+    const size_t size = sbw.bytes_written();
+
+    // an incomplete block is left unread, so that it may be read once the rest has arrived
+    for (const size_t len : { size_t { 0 }, size_t { 3 }, size - 1 }) {
+        StreamBufReader truncated(&buf[0], len);
+        TEST_ASSERT_EQUAL(0, decompressor.read_block(truncated).bytes_remaining());
+        TEST_ASSERT_EQUAL(0, truncated.bytes_read());
+    }
+    TEST_ASSERT_EQUAL(0, decompressor.errors());
+
+    // a corrupt offset is detected, rather than reading outside the window
+    std::vector<uint8_t> corrupt = buf;
+    corrupt[4] = 0x0F; // the first token, now with no literals, so its match is before the start of the window
+    StreamBufReader sbr(&corrupt[0], size);
+    TEST_ASSERT_EQUAL(0, decompressor.read_block(sbr).bytes_remaining());
+    TEST_ASSERT_EQUAL(size, sbr.bytes_read());
+    TEST_ASSERT_EQUAL(1, decompressor.errors());
+
+    // a raw size larger than the window is detected
+    corrupt = buf;
+    corrupt[1] = 0xFF;
+    StreamBufReader oversized(&corrupt[0], size);
+    TEST_ASSERT_EQUAL(0, decompressor.read_block(oversized).bytes_remaining());
+    TEST_ASSERT_EQUAL(2, decompressor.errors());
+
+    // the decompressor resets after an error, so decodes the next stream
+    StreamBufReader good(&buf[0], size);
+    TEST_ASSERT_EQUAL(text.size(), decompressor.read_block(good).bytes_remaining());
+}
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers,cppcoreguidelines-pro-bounds-pointer-arithmetic,readability-magic-numbers)
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char **argv)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_lz_round_trip);
+    RUN_TEST(test_lz_block_format);
+    RUN_TEST(test_lz_reserve);
+    RUN_TEST(test_lz_truncated_and_corrupt);
+
+    UNITY_END();
+}
@@ -0,0 +1,195 @@
+#include "stream_buf_msp.h"
+#include <array>
+#include <unity.h>
+#include <vector>
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers,cppcoreguidelines-pro-bounds-pointer-arithmetic,readability-magic-numbers)
+struct Decoded {
+    std::vector<uint8_t> payload;
+    uint32_t command;
+    stream_buf::MspVersion version;
+    stream_buf::MspDirection direction;
+    uint8_t flags;
+    uint8_t checksum;
+};
+
+static std::vector<uint8_t> encode_stream(size_t& frame_count)
+{
+    std::array<uint8_t, 1024> buf {};
+    StreamBufWriter sbw(&buf[0], buf.size());
+    const std::array<uint8_t, 5> payload = { 1, 2, 3, 4, 5 };
+    sbw.write_string("noise$$M");
+    stream_buf::write_msp_v1(sbw, stream_buf::MspDirection::REQUEST, 101, nullptr, 0);
+    stream_buf::write_msp_v2(sbw, stream_buf::MspDirection::RESPONSE, 0x1F03, &payload[0], payload.size(), 0x01);
+    sbw.write_u8('$');
+    stream_buf::write_msp_v1(sbw, stream_buf::MspDirection::RESPONSE, 108, &payload[0], 3);
+    sbw.write_string("$X"); // truncated frame, followed by a complete frame
+    stream_buf::write_msp_v2(sbw, stream_buf::MspDirection::ERROR, 0x3000, &payload[0], 2);
+    frame_count = 4;
+    return { &buf[0], &buf[0] + sbw.bytes_written() };
+}
+
+void test_msp_encode_v1()
+{
+    std::array<uint8_t, 12> buf {};
+    StreamBufWriter sbw(&buf[0], buf.size());
+    const std::array<uint8_t, 2> payload = { 0x10, 0x20 };
+    TEST_ASSERT_TRUE(stream_buf::write_msp_v1(sbw, stream_buf::MspDirection::RESPONSE, 0x6C, &payload[0], payload.size()));
+    const std::array<uint8_t, 8> expected = { '$', 'M', '>', 0x02, 0x6C, 0x10, 0x20, 0x02 ^ 0x6C ^ 0x10 ^ 0x20 };
+    TEST_ASSERT_EQUAL(expected.size(), sbw.bytes_written());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&expected[0], &buf[0], expected.size());
+
+    // insufficient space, nothing is written
+    TEST_ASSERT_FALSE(stream_buf::write_msp_v1(sbw, stream_buf::MspDirection::RESPONSE, 0x6C, &payload[0], payload.size()));
+    TEST_ASSERT_EQUAL(expected.size(), sbw.bytes_written());
+    // jumbo frames are not supported
+    std::array<uint8_t, 512> big {};
+    StreamBufWriter sbw_big(&big[0], big.size());
+    TEST_ASSERT_FALSE(stream_buf::write_msp_v1(sbw_big, stream_buf::MspDirection::RESPONSE, 1, &big[0], 255));
+    TEST_ASSERT_EQUAL(0, sbw_big.bytes_written());
+}
+
+void test_msp_encode_v2()
+{
+    // MSP_V2_REQUEST for command 100, with an empty payload
+    std::array<uint8_t, 16> buf {};
+    StreamBufWriter sbw(&buf[0], buf.size());
+    TEST_ASSERT_TRUE(stream_buf::write_msp_v2(sbw, stream_buf::MspDirection::REQUEST, 100, nullptr, 0));
+    const std::array<uint8_t, 9> expected = { '$', 'X', '<', 0x00, 0x64, 0x00, 0x00, 0x00, 0x8F };
+    TEST_ASSERT_EQUAL(expected.size(), sbw.bytes_written());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&expected[0], &buf[0], expected.size());
+
+    // the frame checksum is also folded into a checksum attached to the writer
+    std::array<uint8_t, 32> buf2 {};
+    stream_buf::Xor8 xor8;
+    StreamBufWriterT<stream_buf::Checked, stream_buf::Xor8> sbw2(&buf2[0], buf2.size(), xor8);
+    TEST_ASSERT_TRUE(stream_buf::write_msp_v2(sbw2, stream_buf::MspDirection::REQUEST, 100, nullptr, 0));
+    stream_buf::Xor8 check;
+    check.update(&expected[0], expected.size());
+    TEST_ASSERT_EQUAL_HEX8(check.value(), xor8.value());
+}
+
+void test_msp_decode_chunked()
+{
+    size_t frame_count = 0;
+    const std::vector<uint8_t> stream = encode_stream(frame_count);
+
+    for (const size_t chunk_size : { size_t{1}, size_t{2}, size_t{3}, size_t{7}, stream.size() }) {
+        std::array<uint8_t, 64> payload_buf {};
+        MspDecoder decoder(&payload_buf[0], payload_buf.size());
+        std::vector<Decoded> frames;
+        size_t count = 0;
+        for (size_t pos = 0; pos < stream.size(); pos += chunk_size) {
+            const size_t len = std::min(chunk_size, stream.size() - pos);
+            count += decoder.decode(&stream[pos], len, [&frames](const stream_buf::MspFrame& frame) {
+                frames.push_back({ { frame.payload.begin(), frame.payload.end() }, frame.command, frame.version, frame.direction, frame.flags, frame.checksum });
+            });
+        }
+        TEST_ASSERT_EQUAL(frame_count, count);
+        TEST_ASSERT_EQUAL(frame_count, frames.size());
+        TEST_ASSERT_EQUAL(0, decoder.checksum_errors());
+        TEST_ASSERT_FALSE(decoder.in_frame());
+
+        TEST_ASSERT_TRUE(frames[0].version == stream_buf::MspVersion::V1);
+        TEST_ASSERT_TRUE(frames[0].direction == stream_buf::MspDirection::REQUEST);
+        TEST_ASSERT_EQUAL(101, frames[0].command);
+        TEST_ASSERT_EQUAL(0, frames[0].payload.size());
+
+        TEST_ASSERT_TRUE(frames[1].version == stream_buf::MspVersion::V2);
+        TEST_ASSERT_TRUE(frames[1].direction == stream_buf::MspDirection::RESPONSE);
+        TEST_ASSERT_EQUAL_HEX32(0x1F03, frames[1].command);
+        TEST_ASSERT_EQUAL(1, frames[1].flags);
+        TEST_ASSERT_EQUAL(5, frames[1].payload.size());
+        TEST_ASSERT_EQUAL(5, frames[1].payload[4]);
+
+        TEST_ASSERT_EQUAL(108, frames[2].command);
+        TEST_ASSERT_EQUAL(3, frames[2].payload.size());
+
+        TEST_ASSERT_TRUE(frames[3].direction == stream_buf::MspDirection::ERROR);
+        TEST_ASSERT_EQUAL_HEX32(0x3000, frames[3].command);
+        TEST_ASSERT_EQUAL(2, frames[3].payload[1]);
+    }
+}
+
+void test_msp_decode_zero_copy()
+{
+    std::array<uint8_t, 32> buf {};
+    StreamBufWriter sbw(&buf[0], buf.size());
+    const std::array<uint8_t, 4> payload = { 9, 8, 7, 6 };
+    stream_buf::write_msp_v2(sbw, stream_buf::MspDirection::RESPONSE, 200, &payload[0], payload.size());
+
+    // no payload buffer is needed when whole frames are decoded, though the payload limit still applies
+    std::array<uint8_t, 4> payload_buf {};
+    MspDecoder decoder(&payload_buf[0], payload_buf.size());
+    StreamBufReader sbr(&buf[0], sbw.bytes_written());
+    const uint8_t* data = nullptr;
+    TEST_ASSERT_EQUAL(1, decoder.decode(sbr, [&data](const stream_buf::MspFrame& frame) { data = frame.payload.data(); }));
+    TEST_ASSERT_EQUAL_PTR(&buf[8], data);
+    TEST_ASSERT_EQUAL(0, sbr.bytes_remaining());
+}
+
+void test_msp_decode_errors()
+{
+    std::array<uint8_t, 64> buf {};
+    StreamBufWriter sbw(&buf[0], buf.size());
+    const std::array<uint8_t, 16> payload {};
+    stream_buf::write_msp_v1(sbw, stream_buf::MspDirection::REQUEST, 1, &payload[0], 2);
+    buf[sbw.bytes_written() - 1] ^= 0xFF; // corrupt the checksum
+    stream_buf::write_msp_v2(sbw, stream_buf::MspDirection::REQUEST, 2, &payload[0], payload.size()); // too large for the decoder
+    stream_buf::write_msp_v1(sbw, stream_buf::MspDirection::REQUEST, 3, &payload[0], 4);
+
+    for (const size_t chunk_size : { size_t{1}, sbw.bytes_written() }) {
+        std::array<uint8_t, 8> payload_buf {};
+        MspDecoder decoder(&payload_buf[0], payload_buf.size());
+        uint32_t command = 0;
+        size_t count = 0;
+        for (size_t pos = 0; pos < sbw.bytes_written(); pos += chunk_size) {
+            const size_t len = std::min(chunk_size, sbw.bytes_written() - pos);
+            count += decoder.decode(&buf[pos], len, [&command](const stream_buf::MspFrame& frame) { command = frame.command; });
+        }
+        TEST_ASSERT_EQUAL(1, count);
+        TEST_ASSERT_EQUAL(3, command);
+        TEST_ASSERT_EQUAL(1, decoder.checksum_errors());
+        TEST_ASSERT_EQUAL(1, decoder.dropped());
+    }
+}
+
+void test_msp_forward()
+{
+    // a decoded frame may be re-encoded as is
+    std::array<uint8_t, 32> buf {};
+    StreamBufWriter sbw(&buf[0], buf.size());
+    const std::array<uint8_t, 3> payload = { 0xA, 0xB, 0xC };
+    stream_buf::write_msp_v2(sbw, stream_buf::MspDirection::RESPONSE, 0x1234, &payload[0], payload.size(), 0x80);
+
+    std::array<uint8_t, 32> out {};
+    StreamBufWriter sbw_out(&out[0], out.size());
+    std::array<uint8_t, 8> payload_buf {};
+    MspDecoder decoder(&payload_buf[0], payload_buf.size());
+    decoder.decode(&buf[0], sbw.bytes_written(), [&sbw_out](const stream_buf::MspFrame& frame) { stream_buf::write_msp(sbw_out, frame); });
+    TEST_ASSERT_EQUAL(sbw.bytes_written(), sbw_out.bytes_written());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&buf[0], &out[0], sbw.bytes_written());
+}
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers,cppcoreguidelines-pro-bounds-pointer-arithmetic,readability-magic-numbers)
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char **argv)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_msp_encode_v1);
+    RUN_TEST(test_msp_encode_v2);
+    RUN_TEST(test_msp_decode_chunked);
+    RUN_TEST(test_msp_decode_zero_copy);
+    RUN_TEST(test_msp_decode_errors);
+    RUN_TEST(test_msp_forward);
+
+    UNITY_END();
+}
@@ -0,0 +1,126 @@
+#include "stream_buf_ping_pong.h"
+#include "stream_buf_reader.h"
+#include <cstdint>
+#include <unity.h>
+#include <vector>
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers,cppcoreguidelines-pro-bounds-pointer-arithmetic,readability-magic-numbers)
+
+//! Host side stand-in for a DMA channel: start() takes a buffer and complete() copies it out and signals completion
+struct FakeDma {
+    std::span<const uint8_t> transfer;
+    std::vector<uint8_t> received;
+    void start(std::span<const uint8_t> data) { transfer = data; }
+    template <typename PingPong>
+    void complete(PingPong& ping_pong) {
+        received.insert(received.end(), transfer.begin(), transfer.end());
+        transfer = {};
+        ping_pong.transfer_complete();
+    }
+};
+
+template <typename PingPong>
+static void write_message(PingPong& ping_pong, uint32_t value)
+{
+    StreamBufWriter message = ping_pong.reserve(6);
+    TEST_ASSERT_EQUAL(6, message.bytes_remaining());
+    message.write_u16(0xAA55);
+    message.write_u32(value);
+    ping_pong.commit(message);
+}
+
+void test_ping_pong_swap()
+{
+    static StreamBufPingPong<64> ping_pong;
+    FakeDma dma;
+    TEST_ASSERT_EQUAL(64, ping_pong.capacity());
+    TEST_ASSERT_TRUE(ping_pong.swap().empty()); // nothing written
+
+    write_message(ping_pong, 1);
+    write_message(ping_pong, 2);
+    TEST_ASSERT_EQUAL(12, ping_pong.bytes_written());
+    const std::span<const uint8_t> first = ping_pong.swap();
+    TEST_ASSERT_EQUAL(12, first.size());
+    TEST_ASSERT_EQUAL(0, reinterpret_cast<uintptr_t>(first.data()) % stream_buf::DMA_ALIGNMENT); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    TEST_ASSERT_TRUE(ping_pong.is_transmitting());
+    TEST_ASSERT_EQUAL(0, ping_pong.bytes_written());
+    dma.start(first);
+
+    // writing continues into the other buffer while the transfer is in progress
+    write_message(ping_pong, 3);
+    TEST_ASSERT_TRUE(ping_pong.swap().empty());
+    write_message(ping_pong, 4);
+    TEST_ASSERT_EQUAL(12, ping_pong.bytes_written());
+
+    dma.complete(ping_pong);
+    TEST_ASSERT_FALSE(ping_pong.is_transmitting());
+    TEST_ASSERT_EQUAL(1, ping_pong.transfer_count());
+    const std::span<const uint8_t> second = ping_pong.swap();
+    TEST_ASSERT_EQUAL(12, second.size());
+    TEST_ASSERT_EQUAL(0, reinterpret_cast<uintptr_t>(second.data()) % stream_buf::DMA_ALIGNMENT); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    TEST_ASSERT_TRUE(second.data() != first.data());
+    dma.start(second);
+    dma.complete(ping_pong);
+
+    // a completion without a transfer is ignored
+    ping_pong.transfer_complete();
+    TEST_ASSERT_EQUAL(2, ping_pong.transfer_count());
+
+    // the buffers alternate
+    write_message(ping_pong, 5);
+    TEST_ASSERT_TRUE(ping_pong.swap().data() == first.data());
+    dma.start(first.first(6));
+    dma.complete(ping_pong);
+
+    StreamBufReader sbr(&dma.received[0], dma.received.size());
+    for (uint32_t ii = 1; ii <= 5; ++ii) {
+        TEST_ASSERT_EQUAL_HEX16(0xAA55, sbr.read_u16());
+        TEST_ASSERT_EQUAL(ii, sbr.read_u32());
+    }
+    TEST_ASSERT_EQUAL(0, sbr.bytes_remaining());
+}
+
+void test_ping_pong_full()
+{
+    StreamBufPingPong<32, 16> ping_pong;
+    FakeDma dma;
+    for (uint32_t ii = 0; ii < 5; ++ii) {
+        write_message(ping_pong, ii);
+    }
+    TEST_ASSERT_EQUAL(2, ping_pong.bytes_remaining());
+    // insufficient space, so nothing is reserved
+    StreamBufWriter message = ping_pong.reserve(6);
+    TEST_ASSERT_EQUAL(0, message.bytes_remaining());
+    ping_pong.commit(message);
+    TEST_ASSERT_EQUAL(30, ping_pong.bytes_written());
+
+    dma.start(ping_pong.swap());
+    TEST_ASSERT_EQUAL(32, ping_pong.bytes_remaining());
+    // a transfer is in progress, so once the active buffer fills writes are dropped rather than waiting
+    for (uint32_t ii = 0; ii < 5; ++ii) {
+        write_message(ping_pong, ii);
+    }
+    TEST_ASSERT_EQUAL(0, ping_pong.reserve(6).bytes_remaining());
+    dma.complete(ping_pong);
+    TEST_ASSERT_EQUAL(30, ping_pong.swap().size());
+    TEST_ASSERT_EQUAL(6, ping_pong.reserve(6).bytes_remaining());
+}
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers,cppcoreguidelines-pro-bounds-pointer-arithmetic,readability-magic-numbers)
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char **argv)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_ping_pong_swap);
+    RUN_TEST(test_ping_pong_full);
+
+    UNITY_END();
+}
@@ -1,5 +1,7 @@
+#include "stream_buf_mapped_reader.h"
 #include "stream_buf_reader.h"
 #include <array>
+#include <cstdio>
 #include <unity.h>
 
 void setUp()
@@ -106,6 +108,287 @@ void test_stream_buf_reader_strings()
     TEST_ASSERT_EQUAL('o', ptr[4]);
     TEST_ASSERT_EQUAL(0xFF, ptr[5]);
 }
+void test_stream_buf_reader_byte_order()
+{
+    const std::array<uint8_t, 14> buf = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E };
+
+    StreamBufReader little_endian(&buf[0], buf.size());
+    TEST_ASSERT_EQUAL(0x0201, little_endian.read_u16());
+    TEST_ASSERT_EQUAL(0x06050403, little_endian.read_u32());
+    TEST_ASSERT_EQUAL_UINT64(0x0E0D0C0B0A090807ULL, little_endian.read_u64());
+    TEST_ASSERT_EQUAL(0, little_endian.bytes_remaining());
+
+    StreamBufReader big_endian(&buf[0], buf.size());
+    TEST_ASSERT_EQUAL(0x0102, big_endian.read_u16_big_endian());
+    TEST_ASSERT_EQUAL(0x03040506, big_endian.read_u32_big_endian());
+    TEST_ASSERT_EQUAL_UINT64(0x0708090A0B0C0D0EULL, big_endian.read_u64_big_endian());
+    TEST_ASSERT_EQUAL(0, big_endian.bytes_remaining());
+
+    StreamBufReader checked(&buf[0], buf.size());
+    checked.advance(7);
+    TEST_ASSERT_EQUAL_UINT64(0, checked.read_u64_checked()); // only 7 bytes remaining
+    TEST_ASSERT_EQUAL(7, checked.bytes_read());
+    TEST_ASSERT_EQUAL(0x0809, checked.read_u16_big_endian_checked());
+    TEST_ASSERT_EQUAL(0x0D0C0B0A, checked.read_u32_checked());
+    TEST_ASSERT_EQUAL(1, checked.bytes_remaining());
+}
+
+void test_stream_buf_reader_signed()
+{
+    const std::array<uint8_t, 8> buf = { 0xFE, 0xD4, 0xFE, 0xFF, 0xFF, 0xFF, 0xFF, 0x80 };
+
+    StreamBufReader sbufReader(&buf[0], buf.size());
+    TEST_ASSERT_EQUAL(-2, sbufReader.read_s8());
+    TEST_ASSERT_EQUAL(-300, sbufReader.read_s16());
+    TEST_ASSERT_EQUAL(-1, sbufReader.read_s32_big_endian());
+    TEST_ASSERT_EQUAL(-128, sbufReader.read_s8());
+    TEST_ASSERT_EQUAL(0, sbufReader.bytes_remaining());
+}
+void test_stream_buf_reader_require()
+{
+    const std::array<uint8_t, 7> buf = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07 };
+
+    StreamBufReader sbufReader(&buf[0], buf.size());
+    TEST_ASSERT_TRUE(sbufReader.require(7));
+    TEST_ASSERT_FALSE(sbufReader.require(8));
+    TEST_ASSERT_EQUAL(0x01, sbufReader.read_u8());
+    TEST_ASSERT_EQUAL(0x0302, sbufReader.read_u16());
+    TEST_ASSERT_TRUE(sbufReader.require(4));
+    TEST_ASSERT_FALSE(sbufReader.require(5));
+    TEST_ASSERT_EQUAL(0x04050607, sbufReader.read_u32_big_endian());
+    TEST_ASSERT_TRUE(sbufReader.require(0));
+    TEST_ASSERT_FALSE(sbufReader.require(1));
+}
+void test_stream_buf_reader_bounds_policy()
+{
+    const std::array<uint8_t, 5> buf = { 0x01, 0x02, 0x03, 0x04, 0x05 };
+
+    StreamBufReaderChecked checked(&buf[0], buf.size());
+    TEST_ASSERT_EQUAL(0x0201, checked.read_u16());
+    TEST_ASSERT_EQUAL(0, checked.read_u32()); // does not fit
+    TEST_ASSERT_EQUAL(0x03, checked.read_u8());
+    TEST_ASSERT_EQUAL(false, checked.overflowed());
+
+    StreamBufReaderSticky sticky(&buf[0], buf.size());
+    TEST_ASSERT_EQUAL(0x0201, sticky.read_u16());
+    TEST_ASSERT_EQUAL(0, sticky.read_u32()); // does not fit
+    TEST_ASSERT_EQUAL(true, sticky.overflowed());
+    TEST_ASSERT_EQUAL(0, sticky.read_u8()); // subsequent reads also fail
+    TEST_ASSERT_EQUAL(2, sticky.bytes_read());
+    TEST_ASSERT_EQUAL(0, sticky.bytes_remaining());
+    TEST_ASSERT_FALSE(sticky.require(1));
+
+    sticky.reset();
+    TEST_ASSERT_EQUAL(false, sticky.overflowed());
+    TEST_ASSERT_TRUE(sticky.require(5));
+    TEST_ASSERT_EQUAL(0x04030201, sticky.read_u32());
+    TEST_ASSERT_EQUAL(0x05, sticky.read_u8());
+    TEST_ASSERT_EQUAL(false, sticky.overflowed());
+
+    // plain reads are unchecked, the _checked, bulk and require() functions are counted
+    StreamBufReaderCounting counting(&buf[0], buf.size());
+    TEST_ASSERT_TRUE(counting.require(3));
+    TEST_ASSERT_EQUAL(0x0201, counting.read_u16());
+    TEST_ASSERT_EQUAL(0x03, counting.read_u8());
+    TEST_ASSERT_EQUAL(1, counting.bounds_checks());
+    TEST_ASSERT_EQUAL(0, counting.read_u32_checked()); // does not fit, but is counted
+    TEST_ASSERT_EQUAL(0x0504, counting.read_u16_checked());
+    TEST_ASSERT_EQUAL(3, counting.bounds_checks());
+    TEST_ASSERT_EQUAL(false, counting.overflowed());
+}
+void test_stream_buf_reader_varint()
+{
+    // 300, 1, UINT32_MAX + 1
+    const std::array<uint8_t, 9> buf = { 0xAC, 0x02, 0x01, 0x80, 0x80, 0x80, 0x80, 0x10, 0x7F };
+
+    StreamBufReader sbufReader(&buf[0], buf.size());
+    TEST_ASSERT_EQUAL(300, sbufReader.read_varint_u32());
+    TEST_ASSERT_EQUAL(1, sbufReader.read_varint_u32());
+    TEST_ASSERT_EQUAL(0, sbufReader.read_varint_u32()); // does not fit in a u32
+    TEST_ASSERT_EQUAL(3, sbufReader.bytes_read());
+    TEST_ASSERT_EQUAL_UINT64(0x100000000ULL, sbufReader.read_varint_u64());
+    TEST_ASSERT_EQUAL(-64, sbufReader.read_varint_s32());
+    TEST_ASSERT_EQUAL(0, sbufReader.bytes_remaining());
+
+    // truncated, using the byte loop and the word-at-a-time paths
+    const std::array<uint8_t, 12> truncated = { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 };
+    for (size_t len = 0; len <= truncated.size(); ++len) {
+        StreamBufReaderSticky sticky(&truncated[0], len);
+        TEST_ASSERT_EQUAL_UINT64(0, sticky.read_varint_u64());
+        TEST_ASSERT_EQUAL(0, sticky.bytes_read());
+        TEST_ASSERT_EQUAL(true, sticky.overflowed());
+    }
+
+    // 10 byte encoding where the final byte has more than one significant bit
+    const std::array<uint8_t, 10> malformed = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x02 };
+    StreamBufReader malformedReader(&malformed[0], malformed.size());
+    TEST_ASSERT_EQUAL_UINT64(0, malformedReader.read_varint_u64());
+    TEST_ASSERT_EQUAL(0, malformedReader.bytes_read());
+}
+void test_stream_buf_reader_ascii()
+{
+    const std::string_view text = "$GPGGA,123519,-4807,+1,0x1F,ff0A,4294967296,-2147483648,-2147483649,18446744073709551616,00000000000000000000000042*7B";
+    StreamBufReader sbufReader(reinterpret_cast<const uint8_t*>(text.data()), text.size()); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    TEST_ASSERT_EQUAL(0, sbufReader.read_decimal_u32()); // no digits
+    TEST_ASSERT_EQUAL(0, sbufReader.bytes_read());
+    sbufReader.advance(7);
+    TEST_ASSERT_EQUAL(123519, sbufReader.read_decimal_u32());
+    TEST_ASSERT_EQUAL(',', sbufReader.read_u8()); // the terminator is not consumed
+    TEST_ASSERT_EQUAL(0, sbufReader.read_decimal_u32()); // unsigned values have no sign
+    TEST_ASSERT_EQUAL(-4807, sbufReader.read_decimal_s32());
+    sbufReader.advance(1);
+    TEST_ASSERT_EQUAL(0, sbufReader.read_decimal_s32()); // '+' is not accepted
+    sbufReader.advance(3);
+    TEST_ASSERT_EQUAL(0, sbufReader.read_hex_u32()); // the '0', stopping at the 'x'
+    TEST_ASSERT_EQUAL('x', sbufReader.read_u8());
+    TEST_ASSERT_EQUAL_HEX32(0x1F, sbufReader.read_hex_u32());
+    sbufReader.advance(1);
+    TEST_ASSERT_EQUAL_HEX32(0xFF0A, sbufReader.read_hex_u32());
+    sbufReader.advance(1);
+    TEST_ASSERT_EQUAL(0, sbufReader.read_decimal_u32()); // out of range, so not consumed
+    TEST_ASSERT_EQUAL_UINT64(4294967296ULL, sbufReader.read_decimal_u64());
+    sbufReader.advance(1);
+    TEST_ASSERT_EQUAL_INT32(INT32_MIN, sbufReader.read_decimal_s32());
+    sbufReader.advance(1);
+    TEST_ASSERT_EQUAL(0, sbufReader.read_decimal_s32());
+    TEST_ASSERT_EQUAL_INT64(-2147483649LL, sbufReader.read_decimal_s64());
+    sbufReader.advance(1);
+    TEST_ASSERT_EQUAL_UINT64(0, sbufReader.read_decimal_u64());
+    sbufReader.advance(21);
+    TEST_ASSERT_EQUAL_UINT64(42, sbufReader.read_decimal_u64()); // leading zeros do not overflow
+    sbufReader.advance(1);
+    TEST_ASSERT_EQUAL(0x7B, sbufReader.read_hex_u32());
+    TEST_ASSERT_EQUAL(0, sbufReader.bytes_remaining());
+
+    // digits up to the end of the buffer, using the byte loop and the word-at-a-time paths
+    const std::string_view digits = "1234567890123456789";
+    for (size_t len = 0; len <= digits.size(); ++len) {
+        StreamBufReaderSticky sticky(reinterpret_cast<const uint8_t*>(digits.data()), len); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        const uint64_t expected = (len == 0) ? 0 : 1234567890123456789ULL / stream_buf::POWERS_OF_10[digits.size() - len];
+        TEST_ASSERT_EQUAL_UINT64(expected, sticky.read_decimal_u64());
+        TEST_ASSERT_EQUAL(len, sticky.bytes_read());
+        TEST_ASSERT_EQUAL(len == 0, sticky.overflowed());
+    }
+}
+
+void test_stream_buf_reader_hex_base64()
+{
+    const std::string_view text = "0a1B2c3D4e5F60718293a4b5c6d7e8f9,Zm9vYmFy,Zm9vYg==,Zm9vYmE=";
+    StreamBufReader sbufReader(reinterpret_cast<const uint8_t*>(text.data()), text.size()); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    std::array<uint8_t, 16> data {};
+    TEST_ASSERT_TRUE(sbufReader.read_hex_decoded(&data[0], 16));
+    const std::array<uint8_t, 16> expected = { 0x0A, 0x1B, 0x2C, 0x3D, 0x4E, 0x5F, 0x60, 0x71, 0x82, 0x93, 0xA4, 0xB5, 0xC6, 0xD7, 0xE8, 0xF9 };
+    TEST_ASSERT_EQUAL_MEMORY(&expected[0], &data[0], expected.size());
+    TEST_ASSERT_FALSE(sbufReader.read_base64(&data[0], 6)); // ',' is not Base64, so nothing is consumed
+    TEST_ASSERT_EQUAL(32, sbufReader.bytes_read());
+    sbufReader.advance(1);
+    TEST_ASSERT_TRUE(sbufReader.read_base64(&data[0], 6));
+    TEST_ASSERT_EQUAL_MEMORY("foobar", &data[0], 6);
+    sbufReader.advance(1);
+    TEST_ASSERT_FALSE(sbufReader.read_base64(&data[0], 5)); // padded for 4 bytes, not 5
+    TEST_ASSERT_TRUE(sbufReader.read_base64(&data[0], 4));
+    TEST_ASSERT_EQUAL_MEMORY("foob", &data[0], 4);
+    sbufReader.advance(1);
+    TEST_ASSERT_FALSE(sbufReader.read_base64(&data[0], 4)); // padded for 5 bytes, not 4
+    TEST_ASSERT_TRUE(sbufReader.read_base64(&data[0], 5));
+    TEST_ASSERT_EQUAL_MEMORY("fooba", &data[0], 5);
+    TEST_ASSERT_EQUAL(0, sbufReader.bytes_remaining());
+
+    // an invalid character in any position is detected, whether decoded by the SIMD or scalar loops
+    std::array<uint8_t, 256> buf {};
+    std::array<uint8_t, 128> decoded {};
+    for (size_t len = 1; len <= decoded.size(); len += 7) {
+        for (size_t pos = 0; pos < 2 * len; pos += 5) {
+            StreamBufWriter sbuf(&buf[0], buf.size());
+            sbuf.write_hex_encoded(&decoded[0], len);
+            buf[pos] = 'g';
+            StreamBufReaderSticky hexReader(&buf[0], 2 * len);
+            TEST_ASSERT_FALSE(hexReader.read_hex_decoded(&decoded[0], len));
+            TEST_ASSERT_EQUAL(0, hexReader.bytes_read());
+            TEST_ASSERT_TRUE(hexReader.overflowed());
+        }
+        const size_t size = stream_buf::base64_encoded_size(len);
+        for (size_t pos = 0; pos < size; pos += 3) {
+            StreamBufWriter sbuf(&buf[0], buf.size());
+            sbuf.write_base64(&decoded[0], len);
+            buf[pos] = (pos % 2 == 0) ? '-' : 0xC1;
+            StreamBufReaderSticky base64Reader(&buf[0], size);
+            TEST_ASSERT_FALSE(base64Reader.read_base64(&decoded[0], len));
+            TEST_ASSERT_EQUAL(0, base64Reader.bytes_read());
+        }
+    }
+
+    // insufficient characters
+    StreamBufReaderChecked checked(reinterpret_cast<const uint8_t*>(text.data()), 7); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    TEST_ASSERT_FALSE(checked.read_hex_decoded(&data[0], 4));
+    TEST_ASSERT_FALSE(checked.read_base64(&data[0], 6));
+    TEST_ASSERT_EQUAL(0, checked.bytes_read());
+}
+void test_stream_buf_reader_views()
+{
+    const std::array<uint8_t, 16> buf = { 0x02, 0xAA, 0xBB, 'H', 'i', 0, 0, 'a', 'b', 'c', 0x01, 0x02, 'x', 'y', 'z', 'w' };
+
+    StreamBufReader sbufReader(&buf[0], buf.size());
+    TEST_ASSERT_EQUAL(0x02, sbufReader.peek<uint8_t>());
+    TEST_ASSERT_EQUAL(0xAA02, sbufReader.peek<uint16_t>());
+    TEST_ASSERT_EQUAL(0, sbufReader.bytes_read());
+
+    const uint8_t len = sbufReader.read_u8();
+    const std::span<const uint8_t> span = sbufReader.read_span(len);
+    TEST_ASSERT_EQUAL(2, span.size());
+    TEST_ASSERT_EQUAL_PTR(&buf[1], span.data()); // no copy
+    TEST_ASSERT_EQUAL(3, sbufReader.bytes_read());
+
+    TEST_ASSERT_TRUE(sbufReader.peek_cstring_view() == "Hi");
+    TEST_ASSERT_EQUAL(3, sbufReader.bytes_read());
+    TEST_ASSERT_TRUE(sbufReader.read_cstring_view() == "Hi");
+    TEST_ASSERT_EQUAL(6, sbufReader.bytes_read());
+    const std::string_view empty = sbufReader.read_cstring_view();
+    TEST_ASSERT_EQUAL(0, empty.size());
+    TEST_ASSERT_NOT_NULL(empty.data());
+    TEST_ASSERT_EQUAL(7, sbufReader.bytes_read());
+
+    TEST_ASSERT_TRUE(sbufReader.peek_string_view(3) == "abc");
+    TEST_ASSERT_TRUE(sbufReader.read_string_view(3) == "abc");
+    const uint16_t value = sbufReader.peek<uint16_t, stream_buf::Endian::BIG>();
+    TEST_ASSERT_EQUAL(0x0102, value);
+    sbufReader.advance(2);
+
+    // requests that run off the end of the buffer return empty views and do not advance
+    TEST_ASSERT_EQUAL(4, sbufReader.bytes_remaining());
+    TEST_ASSERT_EQUAL(0, sbufReader.peek<uint64_t>());
+    TEST_ASSERT_EQUAL(0, sbufReader.peek_span(5).size());
+    TEST_ASSERT_EQUAL(0, sbufReader.read_span(5).size());
+    TEST_ASSERT_NULL(sbufReader.read_cstring_view().data()); // no terminator
+    TEST_ASSERT_EQUAL(4, sbufReader.bytes_remaining());
+    TEST_ASSERT_TRUE(sbufReader.read_string_view(4) == "xyzw");
+    TEST_ASSERT_EQUAL(0, sbufReader.bytes_remaining());
+}
+
+#if __has_include(<sys/mman.h>)
+void test_stream_buf_reader_mapped()
+{
+    const MappedStreamBufReaderChecked missing("/nonexistent/stream_buf.log");
+    TEST_ASSERT_FALSE(missing.is_mapped());
+    TEST_ASSERT_EQUAL(0, missing.bytes_remaining());
+
+    FILE* file = tmpfile();
+    TEST_ASSERT_NOT_NULL(file);
+    const std::array<uint8_t, 7> data = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07 };
+    fwrite(&data[0], 1, data.size(), file);
+    fflush(file);
+
+    MappedStreamBufReaderChecked sbufReader(fileno(file));
+    fclose(file); // the mapping remains valid after the file is closed
+    TEST_ASSERT_TRUE(sbufReader.is_mapped());
+    TEST_ASSERT_EQUAL(7, sbufReader.size());
+    sbufReader.prefetch();
+    TEST_ASSERT_EQUAL_HEX32(0x04030201, sbufReader.read_u32());
+    TEST_ASSERT_EQUAL_HEX16(0x0506, sbufReader.read_u16_big_endian());
+    TEST_ASSERT_EQUAL(0, sbufReader.read_u16()); // off the end
+    TEST_ASSERT_EQUAL_HEX8(0x07, sbufReader.read_u8());
+}
+#endif
 // NOLINTEND(cppcoreguidelines-avoid-magic-numbers,cppcoreguidelines-pro-bounds-pointer-arithmetic,readability-magic-numbers)
 
 int main([[maybe_unused]] int argc, [[maybe_unused]] char **argv)
@@ -115,6 +398,17 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char **argv)
     RUN_TEST(test_stream_buf_reader_offset);
     RUN_TEST(test_stream_buf_reader);
     RUN_TEST(test_stream_buf_reader_strings);
+    RUN_TEST(test_stream_buf_reader_byte_order);
+    RUN_TEST(test_stream_buf_reader_signed);
+    RUN_TEST(test_stream_buf_reader_require);
+    RUN_TEST(test_stream_buf_reader_bounds_policy);
+    RUN_TEST(test_stream_buf_reader_varint);
+    RUN_TEST(test_stream_buf_reader_ascii);
+    RUN_TEST(test_stream_buf_reader_hex_base64);
+    RUN_TEST(test_stream_buf_reader_views);
+#if __has_include(<sys/mman.h>)
+    RUN_TEST(test_stream_buf_reader_mapped);
+#endif
 
     UNITY_END();
 }
@@ -0,0 +1,160 @@
+#include "stream_buf_ring.h"
+#include <array>
+#include <thread>
+#include <unity.h>
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers,cppcoreguidelines-pro-bounds-pointer-arithmetic,readability-magic-numbers)
+void test_ring_stream()
+{
+    std::array<uint8_t, 16> buf {};
+    StreamBufRing ring(&buf[0], buf.size());
+
+    TEST_ASSERT_EQUAL(0, ring.bytes_available());
+    TEST_ASSERT_EQUAL(0, ring.read_u32());
+    TEST_ASSERT_TRUE(ring.write_u32(0x01020304));
+    TEST_ASSERT_TRUE(ring.write_u64(0x1112131415161718ULL));
+    TEST_ASSERT_EQUAL(12, ring.bytes_available());
+    TEST_ASSERT_EQUAL_HEX32(0x01020304, ring.read_u32());
+    TEST_ASSERT_EQUAL_HEX64(0x1112131415161718ULL, ring.read_u64());
+
+    // the write position is now 12, so this value wraps around the end of the buffer
+    TEST_ASSERT_TRUE((ring.write<uint64_t, stream_buf::Endian::BIG>(0x2122232425262728ULL)));
+    TEST_ASSERT_EQUAL(8, ring.bytes_available());
+    TEST_ASSERT_EQUAL_HEX64(0x2122232425262728ULL, (ring.read<uint64_t, stream_buf::Endian::BIG>()));
+
+    // full: the write index may not catch up with the read index
+    std::array<uint8_t, 16> data {};
+    TEST_ASSERT_FALSE(ring.write_data(&data[0], 16));
+    TEST_ASSERT_TRUE(ring.write_data(&data[0], 15));
+    TEST_ASSERT_FALSE(ring.write_u8(0));
+    TEST_ASSERT_EQUAL(15, ring.bytes_available());
+    TEST_ASSERT_FALSE(ring.read_data(&data[0], 16));
+    TEST_ASSERT_TRUE(ring.read_data(&data[0], 15));
+    TEST_ASSERT_EQUAL(0, ring.bytes_available());
+}
+
+void test_ring_reserve()
+{
+    std::array<uint8_t, 16> buf {};
+    StreamBufRing ring(&buf[0], buf.size());
+
+    StreamBufWriter message = ring.reserve(10);
+    TEST_ASSERT_EQUAL(10, message.bytes_remaining());
+    message.write_u32(0xAABBCCDD);
+    message.write_u16(0x1234);
+    TEST_ASSERT_EQUAL(0, ring.bytes_available()); // not yet committed
+    ring.commit(message); // only the bytes written are committed
+    TEST_ASSERT_EQUAL(6, ring.bytes_available());
+    StreamBufWriter message2 = ring.reserve(4);
+    message2.write_u32(0x55667788);
+    ring.commit(message2);
+
+    StreamBufReader region = ring.read_contiguous();
+    TEST_ASSERT_EQUAL(10, region.bytes_remaining());
+    TEST_ASSERT_EQUAL_HEX32(0xAABBCCDD, region.read_u32());
+    TEST_ASSERT_EQUAL_HEX16(0x1234, region.read_u16());
+    ring.release(region);
+    TEST_ASSERT_EQUAL(4, ring.bytes_available());
+    TEST_ASSERT_EQUAL_HEX32(0x55667788, ring.read_u32());
+
+    // 8 bytes do not fit before the end of the buffer, so the message is placed at the start and bytes 10 to 15 are skipped
+    StreamBufWriter wrapped = ring.reserve(8);
+    TEST_ASSERT_EQUAL(8, wrapped.bytes_remaining());
+    TEST_ASSERT_EQUAL_PTR(&buf[0], wrapped.ptr());
+    wrapped.write_u64(0x0102030405060708ULL);
+    ring.commit(wrapped);
+    TEST_ASSERT_EQUAL(8, ring.bytes_available());
+
+    StreamBufReader wrapped_region = ring.read_contiguous();
+    TEST_ASSERT_EQUAL(8, wrapped_region.bytes_remaining());
+    TEST_ASSERT_EQUAL_HEX64(0x0102030405060708ULL, wrapped_region.read_u64());
+    ring.release(wrapped_region);
+    TEST_ASSERT_EQUAL(0, ring.bytes_available());
+
+    // too large to ever fit
+    const StreamBufWriter too_large = ring.reserve(16);
+    TEST_ASSERT_EQUAL(0, too_large.bytes_remaining());
+}
+
+void test_ring_two_threads()
+{
+    enum { MESSAGES = 100000 };
+    std::array<uint8_t, 64> buf {};
+    StreamBufRing ring(&buf[0], buf.size());
+
+    // messages are a length byte, a sequence number, and a payload derived from the sequence number
+    // even messages are written in place using reserve(), odd messages are written as a stream which may wrap
+    std::thread producer([&ring]() {
+        std::array<uint8_t, 32> payload {};
+        for (uint32_t seq = 0; seq < MESSAGES; ++seq) {
+            const auto len = static_cast<uint8_t>(seq % 24);
+            for (size_t ii = 0; ii < len; ++ii) {
+                payload[ii] = static_cast<uint8_t>(seq + ii);
+            }
+            if (seq % 2 == 0) {
+                for (;;) {
+                    StreamBufWriter message = ring.reserve(1 + 4 + len);
+                    if (message.bytes_remaining() != 0) {
+                        message.write_u8(len);
+                        message.write_u32(seq);
+                        message.write_data(&payload[0], len);
+                        ring.commit(message);
+                        break;
+                    }
+                    std::this_thread::yield();
+                }
+            } else {
+                std::array<uint8_t, 37> message {};
+                message[0] = len;
+                stream_buf::store<uint32_t, stream_buf::Endian::LITTLE>(&message[1], seq);
+                memcpy(&message[5], &payload[0], len);
+                while (!ring.write_data(&message[0], 1 + 4 + len)) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    });
+
+    uint32_t errors = 0;
+    std::array<uint8_t, 37> message {};
+    for (uint32_t seq = 0; seq < MESSAGES; ++seq) {
+        while (ring.bytes_available() == 0) {
+            std::this_thread::yield();
+        }
+        const uint8_t len = ring.read_u8();
+        while (!ring.read_data(&message[0], 4 + len)) {
+            std::this_thread::yield();
+        }
+        if (stream_buf::load<uint32_t, stream_buf::Endian::LITTLE>(&message[0]) != seq) {
+            ++errors;
+        }
+        for (size_t ii = 0; ii < len; ++ii) {
+            if (message[4 + ii] != static_cast<uint8_t>(seq + ii)) {
+                ++errors;
+            }
+        }
+    }
+    producer.join();
+    TEST_ASSERT_EQUAL(0, errors);
+    TEST_ASSERT_EQUAL(0, ring.bytes_available());
+}
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers,cppcoreguidelines-pro-bounds-pointer-arithmetic,readability-magic-numbers)
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char **argv)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_ring_stream);
+    RUN_TEST(test_ring_reserve);
+    RUN_TEST(test_ring_two_threads);
+
+    UNITY_END();
+}
@@ -0,0 +1,113 @@
+#include "stream_buf_schema.h"
+#include <array>
+#include <unity.h>
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers,cppcoreguidelines-pro-bounds-pointer-arithmetic,readability-magic-numbers)
+enum class Mode : uint32_t { ANGLE = 1, HORIZON = 2, ACRO = 3 };
+
+struct Attitude {
+    uint32_t time_ms;
+    float roll;
+    float pitch;
+    int32_t heading; // sent as int16_t
+    Mode mode; // sent as uint8_t
+};
+
+using AttitudeSchema = stream_buf::Schema<
+    stream_buf::Field<&Attitude::time_ms>,
+    stream_buf::Field<&Attitude::mode, uint8_t>,
+    stream_buf::Field<&Attitude::roll>,
+    stream_buf::FieldBigEndian<&Attitude::pitch>,
+    stream_buf::Field<&Attitude::heading, int16_t, stream_buf::Endian::BIG>>;
+
+static_assert(AttitudeSchema::WIRE_SIZE == 4 + 1 + 4 + 4 + 2);
+
+void test_schema_encode()
+{
+    const Attitude attitude { 0x01020304, 1.5F, -2.25F, -300, Mode::HORIZON };
+
+    std::array<uint8_t, AttitudeSchema::WIRE_SIZE> expected {};
+    StreamBufWriter hand(&expected[0], expected.size());
+    hand.write_u32(attitude.time_ms);
+    hand.write_u8(static_cast<uint8_t>(attitude.mode));
+    hand.write_f32(attitude.roll);
+    hand.write_f32_big_endian(attitude.pitch);
+    hand.write_s16_big_endian(static_cast<int16_t>(attitude.heading));
+    TEST_ASSERT_TRUE(hand.is_full());
+
+    std::array<uint8_t, AttitudeSchema::WIRE_SIZE> buf {};
+    StreamBufWriter sbw(&buf[0], buf.size());
+    TEST_ASSERT_TRUE(AttitudeSchema::encode(sbw, attitude));
+    TEST_ASSERT_EQUAL(AttitudeSchema::WIRE_SIZE, sbw.bytes_written());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&expected[0], &buf[0], buf.size());
+
+    // no room for a second struct, so nothing is written
+    TEST_ASSERT_FALSE(AttitudeSchema::encode(sbw, attitude));
+    TEST_ASSERT_EQUAL(AttitudeSchema::WIRE_SIZE, sbw.bytes_written());
+
+    std::array<uint8_t, AttitudeSchema::WIRE_SIZE> raw {};
+    TEST_ASSERT_EQUAL(AttitudeSchema::WIRE_SIZE, AttitudeSchema::encode_unchecked(&raw[0], attitude));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&expected[0], &raw[0], raw.size());
+}
+
+void test_schema_decode()
+{
+    const Attitude attitude { 123456, -0.5F, 0.75F, 1800, Mode::ACRO };
+    std::array<uint8_t, AttitudeSchema::WIRE_SIZE * 2> buf {};
+    StreamBufWriter sbw(&buf[0], buf.size());
+    AttitudeSchema::encode(sbw, attitude);
+    sbw.fill(0xEE, 4); // a truncated second struct
+
+    StreamBufReaderSticky sbr(&buf[0], sbw.bytes_written());
+    Attitude decoded {};
+    TEST_ASSERT_TRUE(AttitudeSchema::decode(sbr, decoded));
+    TEST_ASSERT_EQUAL(attitude.time_ms, decoded.time_ms);
+    TEST_ASSERT_EQUAL_FLOAT(attitude.roll, decoded.roll);
+    TEST_ASSERT_EQUAL_FLOAT(attitude.pitch, decoded.pitch);
+    TEST_ASSERT_EQUAL(attitude.heading, decoded.heading);
+    TEST_ASSERT_TRUE(attitude.mode == decoded.mode);
+
+    Attitude unchanged = decoded;
+    TEST_ASSERT_FALSE(AttitudeSchema::decode(sbr, unchanged));
+    TEST_ASSERT_EQUAL(decoded.time_ms, unchanged.time_ms);
+    TEST_ASSERT_TRUE(sbr.overflowed());
+
+    const Attitude raw = AttitudeSchema::decode_unchecked(&buf[0]);
+    TEST_ASSERT_EQUAL(attitude.heading, raw.heading);
+}
+
+void test_schema_checksum()
+{
+    // the encoded struct is folded into a checksum attached to the writer
+    const Attitude attitude { 42, 1.0F, 2.0F, 3, Mode::ANGLE };
+    std::array<uint8_t, 32> buf {};
+    stream_buf::Crc8DvbS2 crc;
+    StreamBufWriterT<stream_buf::Checked, stream_buf::Crc8DvbS2> sbw(&buf[0], buf.size(), crc);
+    sbw.write_u8(0x24);
+    AttitudeSchema::encode(sbw, attitude);
+    sbw.write_u8(crc.value());
+
+    stream_buf::Crc8DvbS2 check;
+    check.update(&buf[0], 1 + AttitudeSchema::WIRE_SIZE);
+    TEST_ASSERT_EQUAL_HEX8(check.value(), buf[1 + AttitudeSchema::WIRE_SIZE]);
+}
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers,cppcoreguidelines-pro-bounds-pointer-arithmetic,readability-magic-numbers)
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char **argv)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_schema_encode);
+    RUN_TEST(test_schema_decode);
+    RUN_TEST(test_schema_checksum);
+
+    UNITY_END();
+}
@@ -0,0 +1,134 @@
+#include "stream_buf_segmented_writer.h"
+#include <array>
+#include <cstdio>
+#include <unity.h>
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers,cppcoreguidelines-pro-bounds-pointer-arithmetic,readability-magic-numbers)
+void test_segmented_writer()
+{
+    std::array<uint8_t, 1000> payload {};
+    for (size_t ii = 0; ii < payload.size(); ++ii) {
+        payload[ii] = static_cast<uint8_t>(ii * 7);
+    }
+    std::array<uint8_t, 16> scratch {};
+    std::array<stream_buf::Segment, 4> segments {};
+    stream_buf::Crc32 crc;
+    StreamBufSegmentedWriterT<stream_buf::Checked, stream_buf::Crc32> sbw(&scratch[0], scratch.size(), &segments[0], segments.size(), crc);
+
+    sbw.write_u8(0x24);
+    sbw.write_u32(static_cast<uint32_t>(payload.size()));
+    sbw.write_borrowed(&payload[0], payload.size());
+    sbw.write_u32(crc.value());
+    TEST_ASSERT_EQUAL(9, sbw.bytes_written());
+    TEST_ASSERT_EQUAL(1009, sbw.total_size());
+
+    const std::span<const stream_buf::Segment> list = sbw.segments();
+    TEST_ASSERT_EQUAL(3, list.size());
+    TEST_ASSERT_EQUAL_PTR(&scratch[0], list[0].data);
+    TEST_ASSERT_EQUAL(5, list[0].len);
+    TEST_ASSERT_EQUAL_PTR(&payload[0], list[1].data); // not copied
+    TEST_ASSERT_EQUAL(1000, list[1].len);
+    TEST_ASSERT_EQUAL_PTR(&scratch[5], list[2].data);
+    TEST_ASSERT_EQUAL(4, list[2].len);
+
+    // the trailing checksum covers the header and the borrowed payload
+    stream_buf::Crc32 check;
+    check.update(&scratch[0], 5);
+    check.update(&payload[0], payload.size());
+    const uint32_t trailer = stream_buf::load<uint32_t, stream_buf::Endian::LITTLE>(&scratch[5]);
+    TEST_ASSERT_EQUAL_HEX32(check.value(), trailer);
+
+    sbw.reset();
+    TEST_ASSERT_EQUAL(0, sbw.total_size());
+    TEST_ASSERT_EQUAL(0, sbw.segments().size());
+}
+
+void test_segmented_writer_table_full()
+{
+    const std::array<uint8_t, 4> payload = { 1, 2, 3, 4 };
+    std::array<uint8_t, 16> scratch {};
+    std::array<stream_buf::Segment, 3> segments {};
+    StreamBufSegmentedWriter sbw(&scratch[0], scratch.size(), &segments[0], segments.size());
+
+    sbw.write_u8(0xAA);
+    sbw.write_borrowed(&payload[0], payload.size()); // uses 2 segments
+    sbw.write_u8(0xBB);
+    sbw.write_borrowed(&payload[0], payload.size()); // no room, so copied
+    sbw.write_u8(0xCC);
+
+    const std::span<const stream_buf::Segment> list = sbw.segments();
+    TEST_ASSERT_EQUAL(3, list.size());
+    TEST_ASSERT_EQUAL(6, list[2].len);
+    TEST_ASSERT_EQUAL(11, sbw.total_size());
+    const std::array<uint8_t, 6> expected = { 0xBB, 1, 2, 3, 4, 0xCC };
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&expected[0], list[2].data, expected.size());
+
+    // bytes written after the table has filled extend the last chunk, rather than being left out
+    sbw.write_u8(0xDD);
+    TEST_ASSERT_EQUAL(3, sbw.segments().size());
+    TEST_ASSERT_EQUAL(7, list[2].len);
+    TEST_ASSERT_EQUAL(12, sbw.total_size());
+    TEST_ASSERT_EQUAL_HEX8(0xDD, list[2].data[6]);
+
+    // a table that cannot hold any segment records an overflow
+    StreamBufSegmentedWriterT<stream_buf::Sticky> no_table(&scratch[0], scratch.size(), &segments[0], 0);
+    no_table.write_u8(0xEE);
+    TEST_ASSERT_EQUAL(0, no_table.segments().size());
+    TEST_ASSERT_TRUE(no_table.overflowed());
+}
+
+#if __has_include(<sys/uio.h>)
+void test_segmented_writer_writev()
+{
+    std::array<uint8_t, 64> payload {};
+    for (size_t ii = 0; ii < payload.size(); ++ii) {
+        payload[ii] = static_cast<uint8_t>(ii);
+    }
+    std::array<uint8_t, 64> scratch {};
+    std::array<stream_buf::Segment, 40> segments {};
+    StreamBufSegmentedWriter sbw(&scratch[0], scratch.size(), &segments[0], segments.size());
+    // more segments than are passed to each writev call
+    for (uint8_t ii = 0; ii < 19; ++ii) {
+        sbw.write_u8(ii);
+        sbw.write_borrowed(&payload[ii], 3);
+    }
+    sbw.write_u8(0xFF);
+    TEST_ASSERT_EQUAL(39, sbw.segments().size());
+
+    FILE* file = tmpfile();
+    TEST_ASSERT_NOT_NULL(file);
+    TEST_ASSERT_TRUE(sbw.writev(fileno(file)));
+    rewind(file);
+    std::array<uint8_t, 128> check {};
+    const size_t len = fread(&check[0], 1, check.size(), file);
+    fclose(file);
+    TEST_ASSERT_EQUAL(sbw.total_size(), len);
+    for (size_t ii = 0; ii < 19; ++ii) {
+        TEST_ASSERT_EQUAL(ii, check[ii * 4]);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(&payload[ii], &check[ii * 4 + 1], 3);
+    }
+    TEST_ASSERT_EQUAL(0xFF, check[76]);
+}
+#endif
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers,cppcoreguidelines-pro-bounds-pointer-arithmetic,readability-magic-numbers)
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char **argv)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_segmented_writer);
+    RUN_TEST(test_segmented_writer_table_full);
+#if __has_include(<sys/uio.h>)
+    RUN_TEST(test_segmented_writer_writev);
+#endif
+
+    UNITY_END();
+}
@@ -0,0 +1,122 @@
+#include "stream_buf_shared.h"
+#include <array>
+#include <thread>
+#include <vector>
+#include <unity.h>
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers,cppcoreguidelines-pro-bounds-pointer-arithmetic,readability-magic-numbers)
+void test_shared_publish_order()
+{
+    alignas(StreamBufShared::ALIGNMENT) std::array<uint8_t, 64> buf {};
+    StreamBufShared shared(&buf[0], buf.size());
+
+    StreamBufWriter first = shared.reserve(6);
+    StreamBufWriter second = shared.reserve(4);
+    TEST_ASSERT_EQUAL(6, first.bytes_remaining());
+    TEST_ASSERT_EQUAL(4, second.bytes_remaining());
+    TEST_ASSERT_EQUAL(8 + 8 + 8 + 4, shared.bytes_reserved()); // first slice is rounded up to 8 bytes
+
+    second.write_u32(0x22222222);
+    shared.commit(second);
+    // the first record is not yet committed, so the consumer sees nothing
+    size_t count = shared.for_each_published([](StreamBufReader&) {});
+    TEST_ASSERT_EQUAL(0, count);
+
+    first.write_u32(0x11111111);
+    first.write_u8(0x11); // only 5 of the 6 reserved bytes are written
+    shared.commit(first);
+    std::array<uint32_t, 2> values {};
+    count = shared.for_each_published([&values](StreamBufReader& record) {
+        const size_t index = record.bytes_remaining() == 5 ? 0 : 1;
+        values[index] = record.read_u32();
+    });
+    TEST_ASSERT_EQUAL(2, count);
+    TEST_ASSERT_EQUAL_HEX32(0x11111111, values[0]);
+    TEST_ASSERT_EQUAL_HEX32(0x22222222, values[1]);
+    TEST_ASSERT_EQUAL(0, shared.for_each_published([](StreamBufReader&) {}));
+
+    // fill the buffer, a reservation that does not fit fails and may be committed harmlessly
+    StreamBufWriter third = shared.reserve(28);
+    TEST_ASSERT_EQUAL(28, third.bytes_remaining());
+    shared.commit(third);
+    StreamBufWriter full = shared.reserve(1);
+    TEST_ASSERT_EQUAL(0, full.bytes_remaining());
+    shared.commit(full);
+    TEST_ASSERT_EQUAL(1, shared.for_each_published([](StreamBufReader& record) { TEST_ASSERT_EQUAL(0, record.bytes_remaining()); }));
+
+    shared.reset();
+    TEST_ASSERT_EQUAL(0, shared.bytes_reserved());
+    StreamBufWriter after_reset = shared.reserve(4);
+    after_reset.write_u32(0x33333333);
+    shared.commit(after_reset);
+    TEST_ASSERT_EQUAL(1, shared.for_each_published([](StreamBufReader& record) { TEST_ASSERT_EQUAL_HEX32(0x33333333, record.read_u32()); }));
+}
+
+void test_shared_threads()
+{
+    enum { THREADS = 4, RECORDS = 20000 };
+    // records are a thread id, a sequence number, and 0 to 15 bytes of payload
+    std::vector<uint8_t> buf(THREADS * RECORDS * (StreamBufShared::HEADER_SIZE + 24));
+    StreamBufShared shared(&buf[0], buf.size());
+
+    std::vector<std::thread> producers;
+    for (size_t id = 0; id < THREADS; ++id) {
+        producers.emplace_back([&shared, id]() {
+            for (uint32_t seq = 0; seq < RECORDS; ++seq) {
+                const size_t len = seq % 16;
+                StreamBufWriter record = shared.reserve(1 + 4 + len);
+                record.write_u8(static_cast<uint8_t>(id));
+                record.write_u32(seq);
+                record.fill(static_cast<uint8_t>(seq), len);
+                shared.commit(record);
+            }
+        });
+    }
+
+    // consume concurrently with the producers, checking that each thread's records are complete and in order
+    std::array<uint32_t, THREADS> next_seq {};
+    uint32_t errors = 0;
+    size_t total = 0;
+    const auto consume = [&]() {
+        total += shared.for_each_published([&](StreamBufReader& record) {
+            const uint8_t id = record.read_u8();
+            const uint32_t seq = record.read_u32();
+            if (id >= THREADS || seq != next_seq[id] || record.bytes_remaining() != seq % 16) {
+                ++errors;
+                return;
+            }
+            ++next_seq[id];
+            while (record.bytes_remaining() > 0) {
+                if (record.read_u8() != static_cast<uint8_t>(seq)) { ++errors; }
+            }
+        });
+    };
+    while (total < THREADS * RECORDS) {
+        consume();
+        std::this_thread::yield();
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    TEST_ASSERT_EQUAL(0, errors);
+    TEST_ASSERT_EQUAL(THREADS * RECORDS, total);
+}
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers,cppcoreguidelines-pro-bounds-pointer-arithmetic,readability-magic-numbers)
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char **argv)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_shared_publish_order);
+    RUN_TEST(test_shared_threads);
+
+    UNITY_END();
+}
@@ -0,0 +1,265 @@
+#include "stream_buf_byte_stuffing.h"
+#include "stream_buf_reader.h"
+#include "stream_buf_sink.h"
+#include <array>
+#include <cstdio>
+#include <unity.h>
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers,cppcoreguidelines-pro-bounds-pointer-arithmetic,readability-magic-numbers)
+void test_sink_values()
+{
+    std::array<uint8_t, 64> output {};
+    stream_buf::MemorySink sink(&output[0], output.size());
+    std::array<uint8_t, 6> buf {};
+    StreamBufWriterFlushing<stream_buf::MemorySink> sbw(&buf[0], buf.size(), {&sink});
+
+    for (uint32_t ii = 0; ii < 8; ++ii) {
+        sbw.write_u32(0x01020304U * ii);
+    }
+    sbw.write_u16_big_endian(0xABCD);
+    // each u32 that did not fit caused a flush, the last values are still in the buffer
+    TEST_ASSERT_EQUAL(28, sink.size());
+    TEST_ASSERT_TRUE(sbw.flush());
+    TEST_ASSERT_EQUAL(34, sink.size());
+    TEST_ASSERT_TRUE(sbw.is_empty());
+    TEST_ASSERT_TRUE(sbw.flush()); // nothing to flush
+
+    StreamBufReader sbr(&output[0], sink.size());
+    for (uint32_t ii = 0; ii < 8; ++ii) {
+        TEST_ASSERT_EQUAL_HEX32(0x01020304U * ii, sbr.read_u32());
+    }
+    TEST_ASSERT_EQUAL_HEX16(0xABCD, sbr.read_u16_big_endian());
+}
+
+void test_sink_bulk()
+{
+    std::array<uint8_t, 256> output {};
+    stream_buf::MemorySink sink(&output[0], output.size());
+    std::array<uint8_t, 7> buf {};
+    StreamBufWriterFlushing<stream_buf::MemorySink> sbw(&buf[0], buf.size(), {&sink});
+
+    std::array<uint8_t, 50> data {};
+    for (size_t ii = 0; ii < data.size(); ++ii) {
+        data[ii] = static_cast<uint8_t>(ii);
+    }
+    sbw.write_u8(0xEE);
+    sbw.write_data(&data[0], data.size()); // much larger than the buffer
+    sbw.fill(0x55, 20);
+    // u32 elements do not divide the buffer size, so each chunk is split at an element boundary
+    const std::array<uint32_t, 9> values = { 1, 2, 3, 0x11223344, 5, 6, 7, 8, 0xAABBCCDD };
+    sbw.write_array<uint32_t, stream_buf::Endian::BIG>(&values[0], values.size());
+    sbw.write_string("end");
+    sbw.flush();
+    TEST_ASSERT_EQUAL(1 + 50 + 20 + 36 + 3, sink.size());
+
+    StreamBufReader sbr(&output[0], sink.size());
+    TEST_ASSERT_EQUAL_HEX8(0xEE, sbr.read_u8());
+    std::array<uint8_t, 50> check {};
+    sbr.read_data(&check[0], check.size());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&data[0], &check[0], data.size());
+    for (size_t ii = 0; ii < 20; ++ii) {
+        TEST_ASSERT_EQUAL_HEX8(0x55, sbr.read_u8());
+    }
+    for (const uint32_t value : values) {
+        TEST_ASSERT_EQUAL_HEX32(value, sbr.read_u32_big_endian());
+    }
+    TEST_ASSERT_EQUAL('e', sbr.read_u8());
+    TEST_ASSERT_EQUAL('n', sbr.read_u8());
+    TEST_ASSERT_EQUAL('d', sbr.read_u8());
+}
+
+void test_sink_hex_base64()
+{
+    std::array<uint8_t, 256> output {};
+    stream_buf::MemorySink sink(&output[0], output.size());
+    std::array<uint8_t, 11> buf {};
+    StreamBufWriterFlushing<stream_buf::MemorySink> sbw(&buf[0], buf.size(), {&sink});
+
+    std::array<uint8_t, 40> data {};
+    for (size_t ii = 0; ii < data.size(); ++ii) {
+        data[ii] = static_cast<uint8_t>(ii * 7);
+    }
+    // the text is larger than the buffer, so it is split at digit pairs and at groups of 4 Base64 characters
+    sbw.write_u8('<');
+    sbw.write_hex_encoded(&data[0], data.size());
+    sbw.write_base64(&data[0], 37);
+    sbw.flush();
+    TEST_ASSERT_EQUAL(1 + 80 + 52, sink.size());
+
+    StreamBufReader sbr(&output[0], sink.size());
+    TEST_ASSERT_EQUAL('<', sbr.read_u8());
+    std::array<uint8_t, 40> check {};
+    TEST_ASSERT_TRUE(sbr.read_hex_decoded(&check[0], check.size()));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&data[0], &check[0], data.size());
+    check.fill(0);
+    TEST_ASSERT_TRUE(sbr.read_base64(&check[0], 37));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&data[0], &check[0], 37);
+    TEST_ASSERT_EQUAL(0, sbr.bytes_remaining());
+}
+
+void test_sink_failure()
+{
+    std::array<uint8_t, 8> output {};
+    stream_buf::MemorySink sink(&output[0], output.size());
+    std::array<uint8_t, 8> buf {};
+    StreamBufWriterFlushing<stream_buf::MemorySink> sbw(&buf[0], buf.size(), {&sink});
+
+    sbw.write_u64(0x0102030405060708ULL);
+    sbw.write_u32(0x0A0B0C0D); // flushes the u64
+    TEST_ASSERT_EQUAL(8, sink.size());
+    TEST_ASSERT_EQUAL(4, sbw.bytes_written());
+    sbw.write_u64(0x1112131415161718ULL); // sink is full, so the write is dropped
+    TEST_ASSERT_EQUAL(4, sbw.bytes_written());
+    TEST_ASSERT_FALSE(sbw.flush());
+    TEST_ASSERT_EQUAL(4, sbw.bytes_written());
+
+    sink.reset();
+    TEST_ASSERT_TRUE(sbw.flush());
+    TEST_ASSERT_EQUAL(4, sink.size());
+    TEST_ASSERT_EQUAL_HEX8(0x0D, output[0]);
+}
+
+void test_sink_placeholder()
+{
+    std::array<uint8_t, 32> output {};
+    stream_buf::MemorySink sink(&output[0], output.size());
+    std::array<uint8_t, 8> buf {};
+    StreamBufWriterFlushing<stream_buf::MemorySink> sbw(&buf[0], buf.size(), {&sink});
+
+    // a length prefix that spans a flush cannot be patched, so is left as zero, rather than overwriting later bytes
+    sbw.write_u8(0xAA);
+    {
+        auto guard = sbw.length_prefix<uint16_t>();
+        for (uint8_t ii = 0; ii < 12; ++ii) {
+            sbw.write_u8(0x10 + ii);
+        }
+        TEST_ASSERT_FALSE(guard.close());
+    }
+    TEST_ASSERT_EQUAL(8, sbw.bytes_flushed());
+    // a length prefix after a flush is patched at its offset within the buffer
+    TEST_ASSERT_TRUE(sbw.flush());
+    sbw.write_u8(0xCC);
+    {
+        auto guard = sbw.length_prefix<uint8_t>();
+        sbw.write_u8(0xBB);
+        TEST_ASSERT_TRUE(guard.close());
+    }
+    TEST_ASSERT_TRUE(sbw.flush());
+    TEST_ASSERT_EQUAL(18, sbw.bytes_flushed());
+    const std::array<uint8_t, 18> expected = { 0xAA, 0x00, 0x00, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0xCC, 0x01, 0xBB };
+    TEST_ASSERT_EQUAL(expected.size(), sink.size());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&expected[0], &output[0], expected.size());
+
+    const stream_buf::Placeholder<uint16_t> flushed = sbw.reserve_u16();
+    TEST_ASSERT_TRUE(sbw.patch(flushed, 0x1234));
+    sbw.fill(0, 8);
+    TEST_ASSERT_FALSE(sbw.patch(flushed, 0x5678));
+    TEST_ASSERT_EQUAL_HEX8(0x34, output[18]);
+
+    // a COBS frame that spans a flush is reported as corrupt
+    sink.reset();
+    StreamBufWriterFlushing<stream_buf::MemorySink> cobs(&buf[0], buf.size(), {&sink});
+    CobsEncoder short_frame(cobs);
+    short_frame.write_u8(1);
+    TEST_ASSERT_TRUE(short_frame.finish());
+    CobsEncoder long_frame(cobs);
+    const std::array<uint8_t, 12> data = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 };
+    long_frame.write(&data[0], data.size());
+    TEST_ASSERT_FALSE(long_frame.finish());
+}
+
+void test_sink_checksum()
+{
+    std::array<uint8_t, 128> output {};
+    stream_buf::MemorySink sink(&output[0], output.size());
+    std::array<uint8_t, 10> buf {};
+    stream_buf::Crc32 crc;
+    StreamBufWriterT<stream_buf::Flushing<stream_buf::MemorySink>, stream_buf::Crc32> sbw(&buf[0], buf.size(), crc, {&sink});
+
+    for (uint16_t ii = 0; ii < 20; ++ii) {
+        sbw.write_u16(static_cast<uint16_t>(ii * 997));
+    }
+    sbw.write_string("0123456789abcdefghij");
+    sbw.flush();
+    TEST_ASSERT_EQUAL(60, sink.size());
+
+    stream_buf::Crc32 check;
+    check.update(&output[0], sink.size());
+    TEST_ASSERT_EQUAL_HEX32(check.value(), crc.value());
+}
+
+struct CallbackCount {
+    size_t calls;
+    size_t bytes;
+};
+
+static bool count_callback(void* context, const uint8_t* data, size_t len)
+{
+    (void)data;
+    auto* count = static_cast<CallbackCount*>(context);
+    ++count->calls;
+    count->bytes += len;
+    return true;
+}
+
+void test_sink_callback()
+{
+    CallbackCount count {};
+    stream_buf::CallbackSink sink(count_callback, &count);
+    std::array<uint8_t, 16> buf {};
+    StreamBufWriterFlushing<stream_buf::CallbackSink> sbw(&buf[0], buf.size(), {&sink});
+
+    sbw.fill(0, 100);
+    sbw.flush();
+    TEST_ASSERT_EQUAL(7, count.calls);
+    TEST_ASSERT_EQUAL(100, count.bytes);
+}
+
+#if __has_include(<unistd.h>)
+void test_sink_fd()
+{
+    FILE* file = tmpfile();
+    TEST_ASSERT_NOT_NULL(file);
+    stream_buf::FdSink sink(fileno(file));
+    std::array<uint8_t, 4> buf {};
+    StreamBufWriterFlushing<stream_buf::FdSink> sbw(&buf[0], buf.size(), {&sink});
+
+    sbw.write_string("a log line longer than the buffer\n");
+    sbw.write_u32_big_endian(0x31323334);
+    TEST_ASSERT_TRUE(sbw.flush());
+
+    std::array<char, 64> check {};
+    rewind(file);
+    const size_t len = fread(&check[0], 1, check.size(), file);
+    fclose(file);
+    TEST_ASSERT_EQUAL(38, len);
+    TEST_ASSERT_EQUAL_STRING_LEN("a log line longer than the buffer\n1234", &check[0], len);
+}
+#endif
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers,cppcoreguidelines-pro-bounds-pointer-arithmetic,readability-magic-numbers)
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char **argv)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_sink_values);
+    RUN_TEST(test_sink_bulk);
+    RUN_TEST(test_sink_hex_base64);
+    RUN_TEST(test_sink_failure);
+    RUN_TEST(test_sink_placeholder);
+    RUN_TEST(test_sink_checksum);
+    RUN_TEST(test_sink_callback);
+#if __has_include(<unistd.h>)
+    RUN_TEST(test_sink_fd);
+#endif
+
+    UNITY_END();
+}
@@ -0,0 +1,208 @@
+#include "stream_buf_reader.h"
+#include "stream_buf_source.h"
+#include <array>
+#include <cstdio>
+#include <unity.h>
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers,cppcoreguidelines-pro-bounds-pointer-arithmetic,readability-magic-numbers)
+void test_source_values()
+{
+    std::array<uint8_t, 64> input {};
+    StreamBufWriter sbw(&input[0], input.size());
+    for (uint32_t ii = 0; ii < 8; ++ii) {
+        sbw.write_u8(static_cast<uint8_t>(ii));
+        sbw.write_u32(0x01020304U * ii); // odd alignment, so values straddle refills
+    }
+    sbw.write_u64_big_endian(0x1122334455667788ULL);
+
+    // the source returns at most 3 bytes per read, as a serial port might
+    stream_buf::MemorySource source(&input[0], sbw.bytes_written(), 3);
+    std::array<uint8_t, 9> window {};
+    StreamBufReaderRefilling<stream_buf::MemorySource> sbr(&window[0], window.size(), source);
+    TEST_ASSERT_EQUAL(0, sbr.bytes_remaining());
+
+    for (uint32_t ii = 0; ii < 8; ++ii) {
+        TEST_ASSERT_EQUAL(ii, sbr.read_u8());
+        TEST_ASSERT_EQUAL_HEX32(0x01020304U * ii, sbr.read_u32());
+    }
+    TEST_ASSERT_EQUAL_HEX64(0x1122334455667788ULL, sbr.read_u64_big_endian());
+    TEST_ASSERT_EQUAL(48, sbr.bytes_read());
+
+    // end of stream
+    TEST_ASSERT_EQUAL(0, sbr.read_u16());
+    TEST_ASSERT_FALSE(sbr.require(1));
+    TEST_ASSERT_EQUAL(48, sbr.bytes_read());
+}
+
+void test_source_bulk()
+{
+    std::array<uint8_t, 256> input {};
+    StreamBufWriter sbw(&input[0], input.size());
+    std::array<uint8_t, 50> data {};
+    for (size_t ii = 0; ii < data.size(); ++ii) {
+        data[ii] = static_cast<uint8_t>(ii);
+    }
+    const std::array<uint16_t, 13> values = { 1, 2, 3, 0x1122, 5, 6, 7, 8, 9, 10, 11, 12, 0xAABB };
+    sbw.write_u8(0xEE);
+    sbw.write_data(&data[0], data.size());
+    sbw.fill(0, 30);
+    sbw.write_array<uint16_t, stream_buf::Endian::BIG>(&values[0], values.size());
+    sbw.write_u8(0xFF);
+
+    stream_buf::MemorySource source(&input[0], sbw.bytes_written(), 5);
+    std::array<uint8_t, 8> window {};
+    StreamBufReaderRefilling<stream_buf::MemorySource> sbr(&window[0], window.size(), source);
+
+    TEST_ASSERT_EQUAL_HEX8(0xEE, sbr.read_u8());
+    std::array<uint8_t, 50> check {};
+    sbr.read_data(&check[0], check.size()); // much larger than the window
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&data[0], &check[0], data.size());
+    sbr.advance(30);
+    std::array<uint16_t, 13> check_values {};
+    sbr.read_array<uint16_t, stream_buf::Endian::BIG>(&check_values[0], check_values.size());
+    TEST_ASSERT_EQUAL_UINT16_ARRAY(&values[0], &check_values[0], values.size());
+    TEST_ASSERT_EQUAL_HEX8(0xFF, sbr.read_u8());
+    TEST_ASSERT_EQUAL(sbw.bytes_written(), sbr.bytes_read());
+}
+
+void test_source_varint_and_strings()
+{
+    std::array<uint8_t, 128> input {};
+    StreamBufWriter sbw(&input[0], input.size());
+    sbw.write_u8(0);
+    sbw.write_varint_u64(0xFFFFFFFFFFFFFFFFULL); // 10 bytes
+    sbw.write_varint_s32(-1000);
+    sbw.write_string_with_zero_terminator("hello");
+    sbw.write_string_with_zero_terminator("world");
+    sbw.write_varint_u32(300);
+
+    stream_buf::MemorySource source(&input[0], sbw.bytes_written(), 4);
+    std::array<uint8_t, 12> window {};
+    StreamBufReaderRefilling<stream_buf::MemorySource> sbr(&window[0], window.size(), source);
+
+    TEST_ASSERT_EQUAL(0, sbr.read_u8());
+    TEST_ASSERT_EQUAL_HEX64(0xFFFFFFFFFFFFFFFFULL, sbr.read_varint_u64());
+    TEST_ASSERT_EQUAL(-1000, sbr.read_varint_s32());
+    const std::string_view hello = sbr.read_cstring_view();
+    TEST_ASSERT_EQUAL(5, hello.size());
+    TEST_ASSERT_EQUAL_STRING_LEN("hello", hello.data(), hello.size());
+    const std::string_view world = sbr.read_cstring_view();
+    TEST_ASSERT_EQUAL(5, world.size());
+    TEST_ASSERT_EQUAL_STRING_LEN("world", world.data(), world.size());
+    TEST_ASSERT_EQUAL(300, sbr.read_varint_u32());
+    TEST_ASSERT_EQUAL(0, sbr.read_varint_u32());
+}
+
+void test_source_hex_base64()
+{
+    std::array<uint8_t, 256> input {};
+    StreamBufWriter sbw(&input[0], input.size());
+    std::array<uint8_t, 40> data {};
+    for (size_t ii = 0; ii < data.size(); ++ii) {
+        data[ii] = static_cast<uint8_t>(ii * 7);
+    }
+    sbw.write_u8('<');
+    sbw.write_hex_encoded(&data[0], data.size());
+    sbw.write_base64(&data[0], 37);
+    sbw.write_base64(&data[0], 8);
+    const size_t size = sbw.bytes_written();
+    input[size - 2] = '!'; // the last Base64 text is invalid
+
+    stream_buf::MemorySource source(&input[0], size, 5);
+    std::array<uint8_t, 11> window {};
+    StreamBufReaderRefilling<stream_buf::MemorySource> sbr(&window[0], window.size(), source);
+
+    // the text is much larger than the window, so it is decoded a window at a time
+    TEST_ASSERT_EQUAL('<', sbr.read_u8());
+    std::array<uint8_t, 40> check {};
+    TEST_ASSERT_TRUE(sbr.read_hex_decoded(&check[0], check.size()));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&data[0], &check[0], data.size());
+    check.fill(0);
+    TEST_ASSERT_TRUE(sbr.read_base64(&check[0], 37));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&data[0], &check[0], 37);
+    TEST_ASSERT_FALSE(sbr.read_base64(&check[0], 8));
+    TEST_ASSERT_EQUAL(size, sbr.bytes_read());
+    // end of stream
+    TEST_ASSERT_FALSE(sbr.read_hex_decoded(&check[0], 1));
+}
+
+void test_source_checksum()
+{
+    std::array<uint8_t, 100> input {};
+    for (size_t ii = 0; ii < input.size(); ++ii) {
+        input[ii] = static_cast<uint8_t>(ii * 37);
+    }
+    stream_buf::MemorySource source(&input[0], input.size());
+    std::array<uint8_t, 16> window {};
+    stream_buf::Crc32 crc;
+    StreamBufReaderT<stream_buf::Refilling<stream_buf::MemorySource>, stream_buf::Crc32> sbr(&window[0], window.size(), crc, source);
+
+    for (size_t ii = 0; ii < 10; ++ii) {
+        sbr.read_u32();
+    }
+    std::array<uint8_t, 60> data {};
+    sbr.read_data(&data[0], data.size());
+
+    stream_buf::Crc32 check;
+    check.update(&input[0], input.size());
+    TEST_ASSERT_EQUAL_HEX32(check.value(), crc.value());
+}
+
+void test_source_file()
+{
+    FILE* file = tmpfile();
+    TEST_ASSERT_NOT_NULL(file);
+    std::array<uint8_t, 1000> data {};
+    for (size_t ii = 0; ii < data.size(); ++ii) {
+        data[ii] = static_cast<uint8_t>(ii);
+    }
+    fwrite(&data[0], 1, data.size(), file);
+    rewind(file);
+
+    stream_buf::FileSource source(file);
+    std::array<uint8_t, 32> window {};
+    StreamBufReaderRefilling<stream_buf::FileSource> sbr(&window[0], window.size(), source);
+    uint32_t sum = 0;
+    for (size_t ii = 0; ii < data.size() / 2; ++ii) {
+        sum += sbr.read_u16_big_endian();
+    }
+    uint32_t expected = 0;
+    for (size_t ii = 0; ii < data.size(); ii += 2) {
+        expected += static_cast<uint32_t>((data[ii] << 8) | data[ii + 1]);
+    }
+    TEST_ASSERT_EQUAL(expected, sum);
+    TEST_ASSERT_EQUAL(1000, sbr.bytes_read());
+
+#if __has_include(<unistd.h>)
+    rewind(file);
+    stream_buf::FdSource fd_source(fileno(file));
+    StreamBufReaderRefilling<stream_buf::FdSource> fd_sbr(&window[0], window.size(), fd_source);
+    std::array<uint8_t, 1000> check {};
+    fd_sbr.read_data(&check[0], check.size());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&data[0], &check[0], data.size());
+#endif
+    fclose(file);
+}
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers,cppcoreguidelines-pro-bounds-pointer-arithmetic,readability-magic-numbers)
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char **argv)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_source_values);
+    RUN_TEST(test_source_bulk);
+    RUN_TEST(test_source_varint_and_strings);
+    RUN_TEST(test_source_hex_base64);
+    RUN_TEST(test_source_checksum);
+    RUN_TEST(test_source_file);
+
+    UNITY_END();
+}
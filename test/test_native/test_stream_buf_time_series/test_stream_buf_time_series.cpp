@@ -0,0 +1,148 @@
+#include "stream_buf_time_series.h"
+#include <array>
+#include <unity.h>
+#include <vector>
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers,cppcoreguidelines-pro-bounds-pointer-arithmetic,readability-magic-numbers)
+using stream_buf::Predictor;
+
+void test_time_series_encoding()
+{
+    const std::array<Predictor, 5> predictors = { Predictor::NONE, Predictor::PREVIOUS, Predictor::LINEAR, Predictor::PREVIOUS, Predictor::LINEAR };
+    TimeSeriesEncoder<5> encoder(predictors);
+    std::array<uint8_t, 64> buf {};
+    StreamBufWriter sbw(&buf[0], buf.size());
+
+    // the first frame is written absolute
+    TEST_ASSERT_TRUE(encoder.write_frame(sbw, std::array<int32_t, 5> { 0, 1, -1, 200, 70000 }));
+    const std::array<uint8_t, 11> first = {
+        0b11'01'01'00, 0x12, 0x90, 0x01, 0x00, 0x00, // residuals 0, 2, 1 and 400 zigzagged, as 0, 4, 4 and 32 bits
+        0b11, 0xE0, 0x22, 0x02, 0x00 // 140000 zigzagged
+    };
+    TEST_ASSERT_EQUAL(first.size(), sbw.bytes_written());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&first[0], &buf[0], first.size());
+
+    // unchanged values, other than the absolute field, have zero residuals
+    TEST_ASSERT_TRUE(encoder.write_frame(sbw, std::array<int32_t, 5> { 5, 1, -1, 200, 70000 }));
+    const std::array<uint8_t, 3> second = { 0b00'00'00'01, 0x0A, 0b00 };
+    TEST_ASSERT_EQUAL(first.size() + second.size(), sbw.bytes_written());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&second[0], &buf[first.size()], second.size());
+
+    // a constant slope is predicted exactly by LINEAR, but not by PREVIOUS
+    TEST_ASSERT_TRUE(encoder.write_frame(sbw, std::array<int32_t, 5> { 5, 2, -1, 203, 70000 }));
+    TEST_ASSERT_TRUE(encoder.write_frame(sbw, std::array<int32_t, 5> { 5, 3, -1, 206, 70000 }));
+    const std::array<uint8_t, 4> fourth = { 0b01'00'01'01, 0x2A, 0x06, 0b00 };
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&fourth[0], &buf[sbw.bytes_written() - fourth.size()], fourth.size());
+
+    // insufficient space for FRAME_SIZE_MAX, so nothing is written
+    StreamBufWriter small(&buf[0], TimeSeriesEncoder<5>::FRAME_SIZE_MAX - 1);
+    TEST_ASSERT_FALSE(encoder.write_frame(small, std::array<int32_t, 5> {}));
+    TEST_ASSERT_EQUAL(0, small.bytes_written());
+}
+
+struct Trace {
+    std::vector<std::array<int32_t, 7>> frames;
+};
+
+static Trace make_trace(size_t count)
+{
+    Trace trace;
+    uint32_t seed = 1;
+    const auto noise = [&seed]() { seed = seed * 1664525U + 1013904223U; return static_cast<int32_t>(seed >> 28U) - 8; };
+    uint32_t time_us = 0xFFFFF000U; // wraps
+    for (size_t ii = 0; ii < count; ++ii) {
+        time_us += 125 + static_cast<uint32_t>(noise() & 1);
+        const auto phase = static_cast<int32_t>(ii % 200);
+        trace.frames.push_back({ static_cast<int32_t>(time_us), phase * 10 + noise(), -phase * 7 + noise(), 1000 + noise(), 1500, 1500 + phase, INT32_MIN + phase });
+    }
+    return trace;
+}
+
+void test_time_series_round_trip()
+{
+    const std::array<Predictor, 7> predictors = { Predictor::LINEAR, Predictor::PREVIOUS, Predictor::LINEAR, Predictor::NONE, Predictor::PREVIOUS, Predictor::LINEAR, Predictor::PREVIOUS };
+    const Trace trace = make_trace(1000);
+    std::vector<uint8_t> buf(trace.frames.size() * TimeSeriesEncoder<7>::FRAME_SIZE_MAX);
+    StreamBufWriter sbw(&buf[0], buf.size());
+    TimeSeriesEncoder<7> encoder(predictors);
+    for (size_t ii = 0; ii < trace.frames.size(); ++ii) {
+        if (ii == 500) {
+            encoder.reset();
+        }
+        TEST_ASSERT_TRUE(encoder.write_frame(sbw, trace.frames[ii]));
+    }
+    TEST_ASSERT_TRUE(sbw.bytes_written() < trace.frames.size() * 7 * sizeof(int32_t) / 3);
+
+    // frame by frame
+    StreamBufReader sbr(&buf[0], sbw.bytes_written());
+    TimeSeriesDecoder<7> decoder(predictors);
+    for (size_t ii = 0; ii < trace.frames.size(); ++ii) {
+        if (ii == 500) {
+            decoder.reset();
+        }
+        std::array<int32_t, 7> values {};
+        TEST_ASSERT_TRUE(decoder.read_frame(sbr, values));
+        TEST_ASSERT_EQUAL_MEMORY(&trace.frames[ii][0], &values[0], sizeof(values));
+    }
+    TEST_ASSERT_EQUAL(0, sbr.bytes_remaining());
+    std::array<int32_t, 7> values {};
+    TEST_ASSERT_FALSE(decoder.read_frame(sbr, values));
+
+    // in batches into columns, the final batch is short
+    std::array<std::vector<int32_t>, 7> columns;
+    for (auto& column : columns) {
+        column.resize(trace.frames.size());
+    }
+    StreamBufReader sbr_batch(&buf[0], sbw.bytes_written());
+    TimeSeriesDecoder<7> batch_decoder(predictors);
+    TEST_ASSERT_EQUAL(500, batch_decoder.read_frames(sbr_batch, 500, std::array<int32_t*, 7> {
+        &columns[0][0], &columns[1][0], &columns[2][0], &columns[3][0], &columns[4][0], &columns[5][0], &columns[6][0] }));
+    batch_decoder.reset();
+    TEST_ASSERT_EQUAL(500, batch_decoder.read_frames(sbr_batch, 600, std::array<int32_t*, 7> {
+        &columns[0][500], &columns[1][500], &columns[2][500], &columns[3][500], &columns[4][500], &columns[5][500], &columns[6][500] }));
+    for (size_t ii = 0; ii < trace.frames.size(); ++ii) {
+        for (size_t field = 0; field < 7; ++field) {
+            TEST_ASSERT_EQUAL_INT32(trace.frames[ii][field], columns[field][ii]);
+        }
+    }
+}
+
+void test_time_series_truncated()
+{
+    const std::array<Predictor, 3> predictors = { Predictor::PREVIOUS, Predictor::PREVIOUS, Predictor::PREVIOUS };
+    std::array<uint8_t, 32> buf {};
+    StreamBufWriter sbw(&buf[0], buf.size());
+    TimeSeriesEncoder<3> encoder(predictors);
+    encoder.write_frame(sbw, std::array<uint16_t, 3> { 1000, 2000, 3000 });
+
+    TimeSeriesDecoder<3> decoder(predictors);
+    std::array<uint16_t, 3> values = { 1, 2, 3 };
+    StreamBufReaderSticky truncated(&buf[0], sbw.bytes_written() - 1);
+    TEST_ASSERT_FALSE(decoder.read_frame(truncated, values));
+    TEST_ASSERT_TRUE(truncated.overflowed());
+    TEST_ASSERT_EQUAL(1, values[0]);
+
+    StreamBufReader sbr(&buf[0], sbw.bytes_written());
+    TEST_ASSERT_TRUE(decoder.read_frame(sbr, values));
+    TEST_ASSERT_EQUAL(3000, values[2]);
+}
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers,cppcoreguidelines-pro-bounds-pointer-arithmetic,readability-magic-numbers)
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char **argv)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_time_series_encoding);
+    RUN_TEST(test_time_series_round_trip);
+    RUN_TEST(test_time_series_truncated);
+
+    UNITY_END();
+}
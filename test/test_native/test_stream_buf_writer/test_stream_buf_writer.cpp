@@ -1,6 +1,8 @@
 #include "stream_buf_writer.h"
 #include "stream_buf_reader.h"
 #include <array>
+#include <cstdio>
+#include <cstring>
 #include <unity.h>
 
 void setUp()
@@ -259,9 +261,91 @@ void test_stream_buf_strings()
     TEST_ASSERT_EQUAL('H', *(ptr-6));
 }
 
+void test_stream_buf_byte_order()
+{
+    enum { BUF_SIZE = 64 };
+    std::array<uint8_t, BUF_SIZE> buf;
+    buf.fill(0xFF);
+    StreamBufWriter sbuf(&buf[0], BUF_SIZE);
+
+    sbuf.write_u16(0x0102);
+    sbuf.write_u32(0x03040506);
+    sbuf.write_u64(0x0708090A0B0C0D0EULL);
+    TEST_ASSERT_EQUAL(14, sbuf.bytes_written());
+    const std::array<uint8_t, 14> little_endian = { 0x02, 0x01, 0x06, 0x05, 0x04, 0x03, 0x0E, 0x0D, 0x0C, 0x0B, 0x0A, 0x09, 0x08, 0x07 };
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&little_endian[0], &buf[0], little_endian.size());
+    TEST_ASSERT_EQUAL(0xFF, buf[14]);
+
+    sbuf.reset();
+    sbuf.write_u16_big_endian(0x0102);
+    sbuf.write_u32_big_endian(0x03040506);
+    sbuf.write_u64_big_endian(0x0708090A0B0C0D0EULL);
+    TEST_ASSERT_EQUAL(14, sbuf.bytes_written());
+    const std::array<uint8_t, 14> big_endian = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E };
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&big_endian[0], &buf[0], big_endian.size());
+    TEST_ASSERT_EQUAL(0xFF, buf[14]);
+
+    sbuf.switch_to_reader();
+    TEST_ASSERT_EQUAL(0x0102, sbuf.read_u16_big_endian());
+    TEST_ASSERT_EQUAL(0x03040506, sbuf.read_u32_big_endian());
+    TEST_ASSERT_EQUAL_UINT64(0x0708090A0B0C0D0EULL, sbuf.read_u64_big_endian());
+    TEST_ASSERT_EQUAL(0, sbuf.bytes_remaining());
+}
+
+void test_stream_buf_signed()
+{
+    enum { BUF_SIZE = 64 };
+    std::array<uint8_t, BUF_SIZE> buf;
+    StreamBufWriter sbuf(&buf[0], BUF_SIZE);
+
+    sbuf.write_s8(-2);
+    sbuf.write_s16(-300);
+    sbuf.write_s32(-70000);
+    sbuf.write_s64(-5000000000LL);
+    sbuf.write_s16_big_endian(-300);
+    sbuf.write_s32_big_endian(-70000);
+    sbuf.write_s64_big_endian(-5000000000LL);
+    TEST_ASSERT_EQUAL(1 + 2 + 4 + 8 + 2 + 4 + 8, sbuf.bytes_written());
+    TEST_ASSERT_EQUAL(0xFE, buf[0]);
+    TEST_ASSERT_EQUAL(0xD4, buf[1]); // -300 == 0xFED4
+    TEST_ASSERT_EQUAL(0xFE, buf[2]);
+    TEST_ASSERT_EQUAL(0xFE, buf[15]);
+    TEST_ASSERT_EQUAL(0xD4, buf[16]);
+
+    StreamBufReader sbufReader(sbuf.reader());
+    TEST_ASSERT_EQUAL(-2, sbufReader.read_s8());
+    TEST_ASSERT_EQUAL(-300, sbufReader.read_s16());
+    TEST_ASSERT_EQUAL(-70000, sbufReader.read_s32());
+    TEST_ASSERT_EQUAL_INT64(-5000000000LL, sbufReader.read_s64());
+    TEST_ASSERT_EQUAL(-300, sbufReader.read_s16_big_endian());
+    TEST_ASSERT_EQUAL(-70000, sbufReader.read_s32_big_endian());
+    TEST_ASSERT_EQUAL_INT64(-5000000000LL, sbufReader.read_s64_big_endian());
+    TEST_ASSERT_EQUAL(0, sbufReader.bytes_remaining());
+}
+
+void test_stream_buf_u64_checked()
+{
+    enum { BUF_SIZE = 8 };
+    std::array<uint8_t, BUF_SIZE + 1> buf;
+    buf.fill(0xFF);
+    StreamBufWriter sbuf(&buf[0], BUF_SIZE);
+
+    sbuf.write_u8_checked(1);
+    sbuf.write_u64_checked(0x0102030405060708ULL); // does not fit
+    TEST_ASSERT_EQUAL(1, sbuf.bytes_written());
+
+    sbuf.reset();
+    sbuf.write_u64_big_endian_checked(0x0102030405060708ULL);
+    TEST_ASSERT_EQUAL(8, sbuf.bytes_written());
+    TEST_ASSERT_EQUAL(true, sbuf.is_full());
+    TEST_ASSERT_EQUAL(0x01, buf[0]);
+    TEST_ASSERT_EQUAL(0x08, buf[7]);
+    TEST_ASSERT_EQUAL(0xFF, buf[8]); // cppcheck-suppress containerOutOfBounds
+}
+
 void test_stream_buf_float()
 {
-    /*enum { BUF_SIZE = 256 };
+    enum { BUF_SIZE = 256 };
     std::array<uint8_t, BUF_SIZE> buf;
     StreamBufWriter sbuf(&buf[0], BUF_SIZE);
 
@@ -322,7 +406,691 @@ void test_stream_buf_float()
 
     v4 = sbuf.read_f32();
     TEST_ASSERT_EQUAL_FLOAT(3.14159F, v4);
-    TEST_ASSERT_EQUAL(0, sbuf.bytes_remaining());*/
+    TEST_ASSERT_EQUAL(0, sbuf.bytes_remaining());
+}
+void test_stream_buf_template()
+{
+    enum { BUF_SIZE = 64 };
+    std::array<uint8_t, BUF_SIZE> buf;
+    StreamBufWriter sbuf(&buf[0], BUF_SIZE);
+
+    enum class mode_e : uint16_t { ANGLE = 0x0102, HORIZON = 0x0304 };
+    enum state_e : uint8_t { STATE_IDLE = 7 };
+
+    sbuf.write(mode_e::ANGLE);
+    sbuf.write<mode_e, stream_buf::Endian::BIG>(mode_e::HORIZON);
+    sbuf.write(STATE_IDLE);
+    sbuf.write<double, stream_buf::Endian::BIG>(-2.5);
+    sbuf.write<int64_t>(-1);
+    TEST_ASSERT_EQUAL(2 + 2 + 1 + 8 + 8, sbuf.bytes_written());
+    TEST_ASSERT_EQUAL(0x02, buf[0]);
+    TEST_ASSERT_EQUAL(0x01, buf[1]);
+    TEST_ASSERT_EQUAL(0x03, buf[2]);
+    TEST_ASSERT_EQUAL(0x04, buf[3]);
+    TEST_ASSERT_EQUAL(7, buf[4]);
+    TEST_ASSERT_EQUAL(0xC0, buf[5]); // -2.5 == 0xC004000000000000
+    TEST_ASSERT_EQUAL(0x04, buf[6]);
+
+    StreamBufReader sbufReader(sbuf.reader());
+    TEST_ASSERT_TRUE(mode_e::ANGLE == sbufReader.read<mode_e>());
+    const mode_e mode = sbufReader.read<mode_e, stream_buf::Endian::BIG>();
+    TEST_ASSERT_TRUE(mode_e::HORIZON == mode);
+    TEST_ASSERT_TRUE(STATE_IDLE == sbufReader.read<state_e>());
+    TEST_ASSERT_EQUAL_DOUBLE(-2.5, sbufReader.read_f64_big_endian());
+    TEST_ASSERT_EQUAL_INT64(-1, sbufReader.read<int64_t>());
+    TEST_ASSERT_EQUAL(0, sbufReader.bytes_remaining());
+}
+
+void test_stream_buf_big_endian_checked()
+{
+    enum { BUF_SIZE = 6 };
+    std::array<uint8_t, BUF_SIZE> buf;
+    StreamBufWriter sbuf(&buf[0], BUF_SIZE);
+
+    sbuf.write_u16_big_endian_checked(0x0102);
+    sbuf.write_u32_big_endian_checked(0x03040506);
+    sbuf.write_u16_big_endian_checked(0x0708); // does not fit
+    TEST_ASSERT_EQUAL(6, sbuf.bytes_written());
+    TEST_ASSERT_EQUAL(0x01, buf[0]);
+    TEST_ASSERT_EQUAL(0x02, buf[1]);
+    TEST_ASSERT_EQUAL(0x03, buf[2]);
+    TEST_ASSERT_EQUAL(0x06, buf[5]);
+
+    sbuf.switch_to_reader();
+    TEST_ASSERT_EQUAL(0x0102, sbuf.read_u16_big_endian_checked());
+    TEST_ASSERT_EQUAL(0x03040506, sbuf.read_u32_big_endian_checked());
+    TEST_ASSERT_EQUAL(0, sbuf.read_u16_big_endian_checked());
+    TEST_ASSERT_EQUAL_FLOAT(0.0F, sbuf.read_f32_checked());
+}
+void test_stream_buf_reserve()
+{
+    enum { BUF_SIZE = 10 };
+    std::array<uint8_t, BUF_SIZE + 1> buf;
+    buf.fill(0xFF);
+    StreamBufWriter sbuf(&buf[0], BUF_SIZE);
+
+    sbuf.write_u8(1);
+    StreamBufWriter message = sbuf.reserve(7);
+    TEST_ASSERT_EQUAL(7, message.bytes_remaining());
+    TEST_ASSERT_EQUAL(1, sbuf.bytes_written()); // not yet committed
+    message.write_u8(2);
+    message.write_u16(0x0403);
+    message.write_u32_big_endian(0x05060708);
+    TEST_ASSERT_EQUAL(true, message.is_full());
+    sbuf.commit(message);
+    TEST_ASSERT_EQUAL(8, sbuf.bytes_written());
+    for (uint8_t ii = 0; ii < 8; ++ii) {
+        TEST_ASSERT_EQUAL(ii + 1, buf[ii]);
+    }
+
+    // insufficient space for the reservation
+    const StreamBufWriter too_long = sbuf.reserve(3);
+    TEST_ASSERT_EQUAL(0, too_long.bytes_remaining());
+    sbuf.commit(too_long);
+    TEST_ASSERT_EQUAL(8, sbuf.bytes_written());
+    TEST_ASSERT_EQUAL(0xFF, buf[8]);
+
+    // partially filled reservation commits only the bytes written
+    StreamBufWriter partial = sbuf.reserve(2);
+    TEST_ASSERT_EQUAL(2, partial.bytes_remaining());
+    partial.write_u8(9);
+    sbuf.commit(partial);
+    TEST_ASSERT_EQUAL(9, sbuf.bytes_written());
+    TEST_ASSERT_EQUAL(1, sbuf.bytes_remaining());
+}
+template <typename W>
+static void write_frame(W& sbuf)
+{
+    sbuf.write_u8(1);
+    sbuf.write_u16(0x0302);
+    sbuf.write_u32(0x07060504);
+    sbuf.write_u8(8);
+}
+
+void test_stream_buf_bounds_policy()
+{
+    enum { BUF_SIZE = 6 };
+    std::array<uint8_t, BUF_SIZE + 1> buf;
+
+    static_assert(sizeof(StreamBufWriter) == 3 * sizeof(uint8_t*));
+    static_assert(sizeof(StreamBufWriterChecked) == 3 * sizeof(uint8_t*));
+
+    buf.fill(0xFF);
+    StreamBufWriterChecked checked(&buf[0], BUF_SIZE);
+    write_frame(checked);
+    // the u32 is dropped, but the u8 following it is written
+    TEST_ASSERT_EQUAL(4, checked.bytes_written());
+    TEST_ASSERT_EQUAL(false, checked.overflowed());
+    TEST_ASSERT_EQUAL(0x08, buf[3]);
+    TEST_ASSERT_EQUAL(0xFF, buf[4]);
+
+    buf.fill(0xFF);
+    StreamBufWriterSticky sticky(&buf[0], BUF_SIZE);
+    TEST_ASSERT_EQUAL(false, sticky.overflowed());
+    write_frame(sticky);
+    // the u32 overflows, so the u8 following it is not written
+    TEST_ASSERT_EQUAL(3, sticky.bytes_written());
+    TEST_ASSERT_EQUAL(0, sticky.bytes_remaining());
+    TEST_ASSERT_EQUAL(true, sticky.overflowed());
+    TEST_ASSERT_EQUAL(0xFF, buf[3]);
+    sticky.write_data("A", 1);
+    TEST_ASSERT_EQUAL(3, sticky.bytes_written());
+
+    sticky.reset();
+    TEST_ASSERT_EQUAL(false, sticky.overflowed());
+    TEST_ASSERT_EQUAL(BUF_SIZE, sticky.bytes_remaining());
+    sticky.write_u16(0x0201);
+    sticky.write_u32(0x06050403);
+    TEST_ASSERT_EQUAL(false, sticky.overflowed());
+    TEST_ASSERT_EQUAL(true, sticky.is_full());
+    TEST_ASSERT_EQUAL(0x06, buf[5]);
+
+    StreamBufReaderSticky sbufReader(sticky.reader());
+    TEST_ASSERT_EQUAL(0x0201, sbufReader.read_u16());
+    TEST_ASSERT_EQUAL(0x06050403, sbufReader.read_u32());
+    TEST_ASSERT_EQUAL(false, sbufReader.overflowed());
+    TEST_ASSERT_EQUAL(0, sbufReader.read_u8());
+    TEST_ASSERT_EQUAL(true, sbufReader.overflowed());
+
+    // plain writes are unchecked, the _checked, bulk and reserve() functions are counted
+    StreamBufWriterCounting counting(&buf[0], BUF_SIZE);
+    counting.write_u16(0x0201);
+    TEST_ASSERT_EQUAL(0, counting.bounds_checks());
+    counting.write_u8_checked(0x03);
+    counting.write_data("AB", 2);
+    TEST_ASSERT_EQUAL(2, counting.bounds_checks());
+    StreamBufWriter reserved = counting.reserve(1);
+    reserved.write_u8(0x04);
+    counting.commit(reserved);
+    counting.write_u32_checked(0x08070605); // does not fit, but is counted
+    TEST_ASSERT_EQUAL(4, counting.bounds_checks());
+    TEST_ASSERT_EQUAL(6, counting.bytes_written());
+    counting.reset();
+    TEST_ASSERT_EQUAL(4, counting.bounds_checks());
+    TEST_ASSERT_EQUAL(0, sticky.bounds_checks());
+}
+void test_stream_buf_varint()
+{
+    enum { BUF_SIZE = 64 };
+    std::array<uint8_t, BUF_SIZE> buf;
+    StreamBufWriter sbuf(&buf[0], BUF_SIZE);
+
+    sbuf.write_varint_u32(0);
+    TEST_ASSERT_EQUAL(1, sbuf.bytes_written());
+    TEST_ASSERT_EQUAL(0x00, buf[0]);
+    sbuf.write_varint_u32(127);
+    TEST_ASSERT_EQUAL(2, sbuf.bytes_written());
+    TEST_ASSERT_EQUAL(0x7F, buf[1]);
+    sbuf.write_varint_u32(300);
+    TEST_ASSERT_EQUAL(4, sbuf.bytes_written());
+    TEST_ASSERT_EQUAL(0xAC, buf[2]);
+    TEST_ASSERT_EQUAL(0x02, buf[3]);
+    sbuf.write_varint_u32(UINT32_MAX);
+    TEST_ASSERT_EQUAL(9, sbuf.bytes_written());
+    TEST_ASSERT_EQUAL(0xFF, buf[4]);
+    TEST_ASSERT_EQUAL(0x0F, buf[8]);
+    sbuf.write_varint_s32(-1);
+    TEST_ASSERT_EQUAL(10, sbuf.bytes_written());
+    TEST_ASSERT_EQUAL(0x01, buf[9]);
+    sbuf.write_varint_s32(1);
+    TEST_ASSERT_EQUAL(11, sbuf.bytes_written());
+    TEST_ASSERT_EQUAL(0x02, buf[10]);
+    sbuf.write_varint_s64(INT64_MIN);
+    TEST_ASSERT_EQUAL(21, sbuf.bytes_written());
+    TEST_ASSERT_EQUAL(0xFF, buf[11]);
+    TEST_ASSERT_EQUAL(0x01, buf[20]);
+
+    StreamBufReader sbufReader(sbuf.reader());
+    TEST_ASSERT_EQUAL(0, sbufReader.read_varint_u32());
+    TEST_ASSERT_EQUAL(127, sbufReader.read_varint_u32());
+    TEST_ASSERT_EQUAL(300, sbufReader.read_varint_u32());
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, sbufReader.read_varint_u32());
+    TEST_ASSERT_EQUAL(-1, sbufReader.read_varint_s32());
+    TEST_ASSERT_EQUAL(1, sbufReader.read_varint_s32());
+    TEST_ASSERT_EQUAL_INT64(INT64_MIN, sbufReader.read_varint_s64());
+    TEST_ASSERT_EQUAL(0, sbufReader.bytes_remaining());
+}
+
+void test_stream_buf_varint_round_trip()
+{
+    // BUF_SIZE = 10 uses the word-at-a-time paths for the shorter encodings and the byte loop for the longer ones
+    // BUF_SIZE = 64 uses the word-at-a-time paths for all encodings
+    for (size_t buf_size : { 10, 64 }) {
+        std::array<uint8_t, 64> buf;
+        StreamBufWriter sbuf(&buf[0], buf_size);
+        for (uint32_t shift = 0; shift < 64; ++shift) {
+            for (const uint64_t value : { (1ULL << shift) - 1, 1ULL << shift, (1ULL << shift) + 1 }) {
+                sbuf.reset();
+                sbuf.write_varint_u64(value);
+                TEST_ASSERT_EQUAL(stream_buf::varint_size(value), sbuf.bytes_written());
+                StreamBufReader sbufReader(sbuf.reader());
+                TEST_ASSERT_EQUAL_UINT64(value, sbufReader.read_varint_u64());
+                TEST_ASSERT_EQUAL(0, sbufReader.bytes_remaining());
+
+                sbuf.reset();
+                sbuf.write_varint_s64(static_cast<int64_t>(value));
+                StreamBufReader signedReader(sbuf.reader());
+                TEST_ASSERT_EQUAL_INT64(static_cast<int64_t>(value), signedReader.read_varint_s64());
+            }
+        }
+    }
+}
+
+void test_stream_buf_varint_checked()
+{
+    enum { BUF_SIZE = 3 };
+    std::array<uint8_t, BUF_SIZE + 1> buf;
+    buf.fill(0xFF);
+
+    StreamBufWriterSticky sticky(&buf[0], BUF_SIZE);
+    sticky.write_varint_u32(300);
+    TEST_ASSERT_EQUAL(2, sticky.bytes_written());
+    sticky.write_varint_u32(300); // does not fit
+    TEST_ASSERT_EQUAL(2, sticky.bytes_written());
+    TEST_ASSERT_EQUAL(true, sticky.overflowed());
+    TEST_ASSERT_EQUAL(0xFF, buf[2]);
+}
+void test_stream_buf_ascii()
+{
+    std::array<uint8_t, 128> buf {};
+    StreamBufWriter sbuf(&buf[0], buf.size());
+    sbuf.write_decimal_u32(0);
+    sbuf.write_u8(',');
+    sbuf.write_decimal_u32(UINT32_MAX);
+    sbuf.write_u8(',');
+    sbuf.write_decimal_s32(INT32_MIN);
+    sbuf.write_u8(',');
+    sbuf.write_decimal_u64(UINT64_MAX);
+    sbuf.write_u8(',');
+    sbuf.write_decimal_s64(-7);
+    sbuf.write_u8(',');
+    sbuf.write_hex_u8(0x0A);
+    sbuf.write_u8(',');
+    sbuf.write_hex_u16(0xBEEF);
+    sbuf.write_u8(',');
+    sbuf.write_hex_u64(0x0123456789ABCDEFULL);
+    sbuf.write_u8(',');
+    sbuf.write_fixed_s32(-12345, 2);
+    sbuf.write_u8(',');
+    sbuf.write_fixed_s32(-5, 3);
+    sbuf.write_u8(',');
+    sbuf.write_fixed_s64(42, 0);
+    sbuf.write_u8(',');
+    sbuf.write_fixed_s64(INT64_MIN, 19);
+    const char* expected = "0,4294967295,-2147483648,18446744073709551615,-7,0A,BEEF,0123456789ABCDEF,-123.45,-0.005,42,-0.9223372036854775808";
+    TEST_ASSERT_EQUAL(strlen(expected), sbuf.bytes_written());
+    TEST_ASSERT_EQUAL_MEMORY(expected, &buf[0], strlen(expected));
+}
+
+void test_stream_buf_ascii_round_trip()
+{
+    // BUF_SIZE = 20 uses the word-at-a-time paths for the shorter numbers and the byte loops for the longer ones
+    for (size_t buf_size : { 20, 64 }) {
+        std::array<uint8_t, 64> buf {};
+        std::array<char, 64> text {};
+        StreamBufWriter sbuf(&buf[0], buf_size);
+        for (uint32_t shift = 0; shift < 64; ++shift) {
+            for (const uint64_t value : std::array<uint64_t, 5> { (1ULL << shift) - 1, 1ULL << shift, (1ULL << shift) + 1, stream_buf::POWERS_OF_10[shift % 20] - 1, stream_buf::POWERS_OF_10[shift % 20] }) {
+                sbuf.reset();
+                sbuf.write_decimal_u64(value);
+                TEST_ASSERT_EQUAL(stream_buf::decimal_size(value), sbuf.bytes_written());
+                snprintf(&text[0], text.size(), "%llu", static_cast<unsigned long long>(value));
+                TEST_ASSERT_EQUAL(strlen(&text[0]), sbuf.bytes_written());
+                TEST_ASSERT_EQUAL_MEMORY(&text[0], &buf[0], sbuf.bytes_written());
+                StreamBufReader sbufReader(sbuf.reader());
+                TEST_ASSERT_EQUAL_UINT64(value, sbufReader.read_decimal_u64());
+                TEST_ASSERT_EQUAL(0, sbufReader.bytes_remaining());
+
+                sbuf.reset();
+                sbuf.write_decimal_s64(static_cast<int64_t>(value));
+                StreamBufReader signedReader(sbuf.reader());
+                TEST_ASSERT_EQUAL_INT64(static_cast<int64_t>(value), signedReader.read_decimal_s64());
+                TEST_ASSERT_EQUAL(0, signedReader.bytes_remaining());
+
+                sbuf.reset();
+                sbuf.write_hex_u64(value);
+                snprintf(&text[0], text.size(), "%016llX", static_cast<unsigned long long>(value));
+                TEST_ASSERT_EQUAL(16, sbuf.bytes_written());
+                TEST_ASSERT_EQUAL_MEMORY(&text[0], &buf[0], 16);
+                StreamBufReader hexReader(sbuf.reader());
+                TEST_ASSERT_EQUAL_UINT64(value, hexReader.read_hex_u64());
+
+                sbuf.reset();
+                sbuf.write_hex_u32(static_cast<uint32_t>(value));
+                snprintf(&text[0], text.size(), "%08X", static_cast<uint32_t>(value));
+                TEST_ASSERT_EQUAL_MEMORY(&text[0], &buf[0], 8);
+            }
+        }
+    }
+}
+
+void test_stream_buf_ascii_checked()
+{
+    enum { BUF_SIZE = 4 };
+    std::array<uint8_t, BUF_SIZE + 1> buf;
+    buf.fill(0xFF);
+
+    StreamBufWriterSticky sticky(&buf[0], BUF_SIZE);
+    sticky.write_decimal_s32(-12);
+    TEST_ASSERT_EQUAL(3, sticky.bytes_written());
+    sticky.write_hex_u8(0xFF); // does not fit
+    TEST_ASSERT_EQUAL(3, sticky.bytes_written());
+    TEST_ASSERT_EQUAL(true, sticky.overflowed());
+    TEST_ASSERT_EQUAL(0xFF, buf[3]);
+
+    StreamBufWriterChecked checked(&buf[0], BUF_SIZE);
+    checked.write_fixed_s32(1234, 1); // "123.4" does not fit
+    TEST_ASSERT_EQUAL(0, checked.bytes_written());
+    checked.write_fixed_s32(123, 1);
+    TEST_ASSERT_EQUAL(4, checked.bytes_written());
+    TEST_ASSERT_EQUAL_MEMORY("12.3", &buf[0], 4);
+}
+
+void test_stream_buf_hex_base64()
+{
+    std::array<uint8_t, 32> buf {};
+    StreamBufWriter sbuf(&buf[0], buf.size());
+    const std::array<uint8_t, 4> bytes = { 0x01, 0xAB, 0xFF, 0x00 };
+    sbuf.write_hex_encoded(&bytes[0], bytes.size());
+    TEST_ASSERT_EQUAL(8, sbuf.bytes_written());
+    TEST_ASSERT_EQUAL_MEMORY("01ABFF00", &buf[0], 8);
+
+    // the test vectors of RFC 4648
+    const std::array<const char*, 7> encoded = { "", "Zg==", "Zm8=", "Zm9v", "Zm9vYg==", "Zm9vYmE=", "Zm9vYmFy" };
+    const uint8_t* foobar = reinterpret_cast<const uint8_t*>("foobar"); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    for (size_t len = 0; len < encoded.size(); ++len) {
+        sbuf.reset();
+        sbuf.write_base64(foobar, len);
+        TEST_ASSERT_EQUAL(stream_buf::base64_encoded_size(len), sbuf.bytes_written());
+        TEST_ASSERT_EQUAL(strlen(encoded[len]), sbuf.bytes_written());
+        if (len != 0) {
+            TEST_ASSERT_EQUAL_MEMORY(encoded[len], &buf[0], sbuf.bytes_written());
+        }
+    }
+
+    StreamBufWriterSticky sticky(&buf[0], 10);
+    sticky.write_base64(foobar, 6);
+    sticky.write_hex_encoded(&bytes[0], 2); // does not fit
+    TEST_ASSERT_EQUAL(8, sticky.bytes_written());
+    TEST_ASSERT_EQUAL(true, sticky.overflowed());
+}
+
+void test_stream_buf_hex_base64_round_trip()
+{
+    // lengths covering the AVX2, SSSE3 and scalar loops and every tail length, compared with bytewise reference encoders
+    std::array<uint8_t, 300> data {};
+    uint32_t seed = 1;
+    for (auto& byte : data) {
+        seed = seed * 1664525U + 1013904223U;
+        byte = static_cast<uint8_t>(seed >> 24U);
+    }
+    std::array<uint8_t, 2 * data.size()> buf {};
+    std::array<uint8_t, 2 * data.size()> expected {};
+    std::array<uint8_t, data.size()> decoded {};
+    std::array<char, 3> text {};
+    for (size_t len = 0; len <= data.size(); ++len) {
+        StreamBufWriter sbuf(&buf[0], buf.size());
+        sbuf.write_hex_encoded(&data[0], len);
+        TEST_ASSERT_EQUAL(2 * len, sbuf.bytes_written());
+        for (size_t ii = 0; ii < len; ++ii) {
+            snprintf(&text[0], text.size(), "%02X", data[ii]);
+            TEST_ASSERT_EQUAL_MEMORY(&text[0], &buf[2 * ii], 2);
+        }
+        StreamBufReader hexReader(sbuf.reader());
+        TEST_ASSERT_TRUE(hexReader.read_hex_decoded(&decoded[0], len));
+        TEST_ASSERT_EQUAL(0, hexReader.bytes_remaining());
+        if (len != 0) {
+            TEST_ASSERT_EQUAL_MEMORY(&data[0], &decoded[0], len);
+        }
+
+        sbuf.reset();
+        sbuf.write_base64(&data[0], len);
+        TEST_ASSERT_EQUAL(stream_buf::base64_encoded_size(len), sbuf.bytes_written());
+        for (size_t ii = 0; ii < len; ii += 3) {
+            const uint32_t group = (uint32_t{data[ii]} << 16U) | (ii + 1 < len ? uint32_t{data[ii + 1]} << 8U : 0) | (ii + 2 < len ? data[ii + 2] : 0);
+            for (size_t jj = 0; jj < 4; ++jj) {
+                expected[ii / 3 * 4 + jj] = (ii + jj <= len) ? stream_buf::BASE64_ALPHABET[(group >> (18 - 6 * jj)) & 0x3F] : '=';
+            }
+        }
+        StreamBufReader base64Reader(sbuf.reader());
+        TEST_ASSERT_TRUE(base64Reader.read_base64(&decoded[0], len));
+        TEST_ASSERT_EQUAL(0, base64Reader.bytes_remaining());
+        if (len != 0) { // comparing zero bytes is rejected by Unity, the empty case writes nothing
+            TEST_ASSERT_EQUAL_MEMORY(&expected[0], &buf[0], sbuf.bytes_written());
+            TEST_ASSERT_EQUAL_MEMORY(&data[0], &decoded[0], len);
+        }
+    }
+}
+
+void test_stream_buf_array()
+{
+    enum { COUNT = 37 }; // not a multiple of the SIMD width, so the scalar tail is exercised
+    std::array<uint16_t, COUNT> u16s;
+    std::array<uint32_t, COUNT> u32s;
+    std::array<uint64_t, COUNT> u64s;
+    std::array<float, COUNT> floats;
+    for (size_t ii = 0; ii < COUNT; ++ii) {
+        u16s[ii] = static_cast<uint16_t>(0x0102 + ii * 0x1111);
+        u32s[ii] = static_cast<uint32_t>(0x01020304 + ii * 0x11111111);
+        u64s[ii] = 0x0102030405060708ULL + ii * 0x1111111111111111ULL;
+        floats[ii] = static_cast<float>(ii) * 1.5F - 20.0F;
+    }
+    enum { BUF_SIZE = COUNT * (2 + 4 + 8 + 4) * 2 };
+    std::array<uint8_t, BUF_SIZE> buf;
+    std::array<uint8_t, BUF_SIZE> expected;
+    StreamBufWriter sbuf(&buf[0], BUF_SIZE);
+    StreamBufWriter sbufExpected(&expected[0], BUF_SIZE);
+
+    sbuf.write_array(&u16s[0], COUNT);
+    sbuf.write_array<uint16_t, stream_buf::Endian::BIG>(&u16s[0], COUNT);
+    sbuf.write_array<uint32_t, stream_buf::Endian::BIG>(&u32s[0], COUNT);
+    sbuf.write_array<uint64_t, stream_buf::Endian::BIG>(&u64s[0], COUNT);
+    sbuf.write_array<float, stream_buf::Endian::BIG>(&floats[0], COUNT);
+    sbuf.write_array(&u64s[0], COUNT);
+    for (auto value : u16s) { sbufExpected.write_u16(value); }
+    for (auto value : u16s) { sbufExpected.write_u16_big_endian(value); }
+    for (auto value : u32s) { sbufExpected.write_u32_big_endian(value); }
+    for (auto value : u64s) { sbufExpected.write_u64_big_endian(value); }
+    for (auto value : floats) { sbufExpected.write_f32_big_endian(value); }
+    for (auto value : u64s) { sbufExpected.write_u64(value); }
+    TEST_ASSERT_EQUAL(sbufExpected.bytes_written(), sbuf.bytes_written());
+    TEST_ASSERT_EQUAL_MEMORY(&expected[0], &buf[0], sbuf.bytes_written());
+
+    std::array<uint16_t, COUNT> u16s_read {};
+    std::array<uint32_t, COUNT> u32s_read {};
+    std::array<uint64_t, COUNT> u64s_read {};
+    std::array<float, COUNT> floats_read {};
+    StreamBufReader sbufReader(sbuf.reader());
+    sbufReader.read_array(&u16s_read[0], COUNT);
+    TEST_ASSERT_EQUAL_MEMORY(&u16s[0], &u16s_read[0], sizeof(u16s));
+    u16s_read.fill(0);
+    sbufReader.read_array<uint16_t, stream_buf::Endian::BIG>(&u16s_read[0], COUNT);
+    TEST_ASSERT_EQUAL_MEMORY(&u16s[0], &u16s_read[0], sizeof(u16s));
+    sbufReader.read_array<uint32_t, stream_buf::Endian::BIG>(&u32s_read[0], COUNT);
+    TEST_ASSERT_EQUAL_MEMORY(&u32s[0], &u32s_read[0], sizeof(u32s));
+    sbufReader.read_array<uint64_t, stream_buf::Endian::BIG>(&u64s_read[0], COUNT);
+    TEST_ASSERT_EQUAL_MEMORY(&u64s[0], &u64s_read[0], sizeof(u64s));
+    sbufReader.read_array<float, stream_buf::Endian::BIG>(&floats_read[0], COUNT);
+    TEST_ASSERT_EQUAL_MEMORY(&floats[0], &floats_read[0], sizeof(floats));
+    u64s_read.fill(0);
+    sbufReader.read_array(&u64s_read[0], COUNT);
+    TEST_ASSERT_EQUAL_MEMORY(&u64s[0], &u64s_read[0], sizeof(u64s));
+    TEST_ASSERT_EQUAL(0, sbufReader.bytes_remaining());
+
+    // the array does not fit, so nothing is written
+    sbuf.reset();
+    sbuf.advance(BUF_SIZE - 8);
+    sbuf.write_array<uint32_t, stream_buf::Endian::BIG>(&u32s[0], 3);
+    TEST_ASSERT_EQUAL(BUF_SIZE - 8, sbuf.bytes_written());
+    sbuf.write_array<uint32_t, stream_buf::Endian::BIG>(&u32s[0], 2);
+    TEST_ASSERT_EQUAL(BUF_SIZE, sbuf.bytes_written());
+}
+void test_stream_buf_placeholder()
+{
+    enum { BUF_SIZE = 32 };
+    std::array<uint8_t, BUF_SIZE> buf;
+    buf.fill(0xFF);
+    StreamBufWriter sbuf(&buf[0], BUF_SIZE);
+
+    sbuf.write_u8(0x24);
+    const auto length = sbuf.reserve_u16();
+    const auto offset = sbuf.reserve_u32_big_endian();
+    TEST_ASSERT_EQUAL(7, sbuf.bytes_written());
+    TEST_ASSERT_EQUAL(0, buf[1]);
+    TEST_ASSERT_EQUAL(0, buf[6]);
+    sbuf.write_u32(0x01020304);
+    sbuf.patch(length, 0x0A0B);
+    sbuf.patch(offset, 0x0C0D0E0F);
+    TEST_ASSERT_EQUAL(11, sbuf.bytes_written());
+    TEST_ASSERT_EQUAL(0x0B, buf[1]);
+    TEST_ASSERT_EQUAL(0x0A, buf[2]);
+    TEST_ASSERT_EQUAL(0x0C, buf[3]);
+    TEST_ASSERT_EQUAL(0x0F, buf[6]);
+    TEST_ASSERT_EQUAL(0x04, buf[7]);
+
+    // a placeholder that was not written, because there was insufficient space, is not patched
+    enum { SMALL_BUF_SIZE = 3 };
+    std::array<uint8_t, SMALL_BUF_SIZE + 1> small_buf;
+    small_buf.fill(0xFF);
+    StreamBufWriterChecked checked(&small_buf[0], SMALL_BUF_SIZE);
+    checked.write_u16(0x0102);
+    const auto missing = checked.reserve_u16();
+    checked.patch(missing, 0xABCD);
+    TEST_ASSERT_EQUAL(2, checked.bytes_written());
+    TEST_ASSERT_EQUAL(0xFF, small_buf[2]);
+    TEST_ASSERT_EQUAL(0xFF, small_buf[3]);
+}
+
+void test_stream_buf_length_prefix()
+{
+    enum { BUF_SIZE = 32 };
+    std::array<uint8_t, BUF_SIZE> buf;
+    StreamBufWriter sbuf(&buf[0], BUF_SIZE);
+
+    sbuf.write_u8(0x24);
+    {
+        const auto outer = sbuf.length_prefix<uint16_t, stream_buf::Endian::BIG>();
+        sbuf.write_u32(1);
+        {
+            const auto inner = sbuf.length_prefix<uint8_t>();
+            sbuf.write_string("Hello");
+        }
+        sbuf.write_u8(2);
+    }
+    sbuf.write_u8(0x0A);
+
+    StreamBufReader sbufReader(sbuf.reader());
+    TEST_ASSERT_EQUAL(0x24, sbufReader.read_u8());
+    TEST_ASSERT_EQUAL(4 + 1 + 5 + 1, sbufReader.read_u16_big_endian());
+    TEST_ASSERT_EQUAL(1, sbufReader.read_u32());
+    TEST_ASSERT_EQUAL(5, sbufReader.read_u8());
+    sbufReader.advance(5);
+    TEST_ASSERT_EQUAL(2, sbufReader.read_u8());
+    TEST_ASSERT_EQUAL(0x0A, sbufReader.read_u8());
+    TEST_ASSERT_EQUAL(0, sbufReader.bytes_remaining());
+
+    // close() reports whether the length was filled in, closing again returns the same result
+    sbuf.reset();
+    {
+        auto length = sbuf.length_prefix<uint8_t>();
+        sbuf.write_u16(0x0201);
+        TEST_ASSERT_TRUE(length.close());
+        sbuf.write_u8(3); // after close(), so not counted
+        TEST_ASSERT_TRUE(length.close());
+    }
+    TEST_ASSERT_EQUAL(2, buf[0]);
+
+    // a length that does not fit in the field is not filled in, and is recorded as an overflow for the Sticky policy
+    std::array<uint8_t, 300> big_buf {};
+    StreamBufWriterSticky sticky(&big_buf[0], big_buf.size());
+    {
+        auto length = sticky.length_prefix<uint8_t>();
+        sticky.fill(0xAA, 256);
+        TEST_ASSERT_FALSE(length.close());
+        TEST_ASSERT_FALSE(length.close());
+    }
+    TEST_ASSERT_EQUAL(0, big_buf[0]);
+    TEST_ASSERT_EQUAL(true, sticky.overflowed());
+
+    // a guard closed by going out of scope records the failure for the Sticky policy
+    sticky.reset();
+    {
+        const auto length = sticky.length_prefix<uint8_t>();
+        sticky.fill(0xAA, 256);
+    }
+    TEST_ASSERT_EQUAL(true, sticky.overflowed());
+    sticky.reset();
+    {
+        const auto length = sticky.length_prefix<uint8_t>();
+        sticky.fill(0xAA, 255);
+    }
+    TEST_ASSERT_EQUAL(false, sticky.overflowed());
+    TEST_ASSERT_EQUAL(255, big_buf[0]);
+}
+// MSP v2 request with no payload, built at compile time
+constexpr auto MSP_V2_REQUEST = stream_buf::make_frame<9>([](StreamBufWriter& sbuf) {
+    sbuf.write_string("$X<");
+    sbuf.write_u8(0); // flags
+    sbuf.write_u16(0x1234); // function
+    sbuf.write_u16(0); // payload size
+    stream_buf::Crc8DvbS2 crc;
+    crc.update(sbuf.ptr() - 5, 5);
+    sbuf.write_u8(crc.value());
+});
+static_assert(MSP_V2_REQUEST[0] == '$' && MSP_V2_REQUEST[2] == '<');
+static_assert(stream_buf::read_frame(MSP_V2_REQUEST, [](StreamBufReader& sbuf) { sbuf.advance(4); return sbuf.read_u16(); }) == 0x1234);
+
+// text command built at compile time
+constexpr auto TEXT_COMMAND = stream_buf::make_frame<15>([](StreamBufWriter& sbuf) {
+    sbuf.write_string("set ");
+    sbuf.write_decimal_s32(-42);
+    sbuf.write_u8(' ');
+    sbuf.write_fixed_s32(1250, 3);
+    sbuf.write_hex_u8(0xA5);
+});
+static_assert(TEXT_COMMAND[4] == '-' && TEXT_COMMAND[9] == '.' && TEXT_COMMAND[14] == '5');
+static_assert(stream_buf::read_frame(TEXT_COMMAND, [](StreamBufReader& sbuf) { sbuf.advance(4); return sbuf.read_decimal_s32(); }) == -42);
+
+// frame using the remaining writer functions, with a CRC32 trailer computed once the length prefix has been filled in
+static constexpr std::array<uint8_t, 24> make_constexpr_frame()
+{
+    std::array<uint8_t, 25> buf {};
+    StreamBufWriterChecked sbuf(&buf[0], 24);
+    {
+        const auto length = sbuf.length_prefix<uint8_t>();
+        sbuf.write_f32_big_endian(1.5F);
+        sbuf.write_s16(-2);
+        sbuf.write_varint_u32(300);
+        const std::array<uint16_t, 2> values = { 0x0102, 0x0304 };
+        sbuf.write_array<uint16_t, stream_buf::Endian::BIG>(&values[0], values.size());
+        const std::array<uint8_t, 2> data = { 0xAA, 0xBB };
+        sbuf.write_data(&data[0], data.size());
+        sbuf.fill(0xCC, 2);
+        sbuf.write_string_with_zero_terminator("ok");
+    }
+    stream_buf::Crc32 crc;
+    crc.update(&buf[0], sbuf.bytes_written());
+    sbuf.write_u32(crc.value());
+    sbuf.write_u8_checked(0xEE); // does not fit, so is dropped
+    std::array<uint8_t, 24> frame {};
+    std::copy_n(buf.begin(), frame.size(), frame.begin());
+    return frame;
+}
+constexpr std::array<uint8_t, 24> CONSTEXPR_FRAME = make_constexpr_frame();
+static_assert(CONSTEXPR_FRAME[0] == 4 + 2 + 2 + 4 + 2 + 2 + 3);
+static_assert(stream_buf::read_frame(CONSTEXPR_FRAME, [](StreamBufReader& sbuf) {
+    stream_buf::Crc32 crc;
+    crc.update(sbuf.ptr(), 20);
+    sbuf.advance(20);
+    return sbuf.read_u32() == crc.value();
+}));
+static_assert(stream_buf::read_frame(CONSTEXPR_FRAME, [](StreamBufReader& sbuf) {
+    sbuf.advance(1);
+    const float value = sbuf.read_f32_big_endian();
+    const int16_t negative = sbuf.read_s16();
+    const uint32_t varint = sbuf.read_varint_u32();
+    std::array<uint16_t, 2> values {};
+    sbuf.read_array<uint16_t, stream_buf::Endian::BIG>(&values[0], values.size());
+    return value == 1.5F && negative == -2 && varint == 300 && values[1] == 0x0304;
+}));
+
+void test_stream_buf_constexpr()
+{
+    // frames built at compile time are the same as frames built at run time
+    std::array<uint8_t, 9> request {};
+    StreamBufWriter sbuf(&request[0], request.size());
+    sbuf.write_string("$X<");
+    sbuf.write_u8(0);
+    sbuf.write_u16(0x1234);
+    sbuf.write_u16(0);
+    stream_buf::Crc8DvbS2 crc8;
+    crc8.update(&request[3], 5);
+    sbuf.write_u8(crc8.value());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&request[0], &MSP_V2_REQUEST[0], request.size());
+
+    std::array<uint8_t, 24> frame {};
+    StreamBufWriterChecked checked(&frame[0], frame.size());
+    {
+        const auto length = checked.length_prefix<uint8_t>();
+        checked.write_f32_big_endian(1.5F);
+        checked.write_s16(-2);
+        checked.write_varint_u32(300);
+        const std::array<uint16_t, 2> values = { 0x0102, 0x0304 };
+        checked.write_array<uint16_t, stream_buf::Endian::BIG>(&values[0], values.size());
+        const std::array<uint8_t, 2> data = { 0xAA, 0xBB };
+        checked.write_data(&data[0], data.size());
+        checked.fill(0xCC, 2);
+        checked.write_string_with_zero_terminator("ok");
+    }
+    TEST_ASSERT_EQUAL(20, checked.bytes_written());
+    stream_buf::Crc32 crc32;
+    crc32.update(&frame[0], checked.bytes_written());
+    checked.write_u32(crc32.value());
+    TEST_ASSERT_EQUAL(24, checked.bytes_written());
+    // the trailer is the CRC32 of the finished bytes, including the patched length
+    TEST_ASSERT_EQUAL_HEX32(0xE3269BA7, crc32.value());
+    TEST_ASSERT_EQUAL_HEX32(crc32.value(), stream_buf::load_little_endian<uint32_t>(&CONSTEXPR_FRAME[20]));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&frame[0], &CONSTEXPR_FRAME[0], frame.size());
 }
 // NOLINTEND(cppcoreguidelines-avoid-magic-numbers,cppcoreguidelines-pro-bounds-pointer-arithmetic,readability-magic-numbers)
 
@@ -335,7 +1103,26 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char **argv)
     RUN_TEST(test_stream_buf_big_endian);
     RUN_TEST(test_stream_buf_size);
     RUN_TEST(test_stream_buf_strings);
-    //RUN_TEST(test_stream_buf_float);
+    RUN_TEST(test_stream_buf_byte_order);
+    RUN_TEST(test_stream_buf_signed);
+    RUN_TEST(test_stream_buf_u64_checked);
+    RUN_TEST(test_stream_buf_float);
+    RUN_TEST(test_stream_buf_template);
+    RUN_TEST(test_stream_buf_big_endian_checked);
+    RUN_TEST(test_stream_buf_reserve);
+    RUN_TEST(test_stream_buf_bounds_policy);
+    RUN_TEST(test_stream_buf_varint);
+    RUN_TEST(test_stream_buf_varint_round_trip);
+    RUN_TEST(test_stream_buf_varint_checked);
+    RUN_TEST(test_stream_buf_ascii);
+    RUN_TEST(test_stream_buf_ascii_round_trip);
+    RUN_TEST(test_stream_buf_ascii_checked);
+    RUN_TEST(test_stream_buf_hex_base64);
+    RUN_TEST(test_stream_buf_hex_base64_round_trip);
+    RUN_TEST(test_stream_buf_array);
+    RUN_TEST(test_stream_buf_placeholder);
+    RUN_TEST(test_stream_buf_length_prefix);
+    RUN_TEST(test_stream_buf_constexpr);
 
     UNITY_END();
 }